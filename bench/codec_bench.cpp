@@ -0,0 +1,150 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <climits>
+#include <x86intrin.h>
+
+#include "src/simplehttp.hpp"
+
+using namespace std;
+
+using namespace SimpleHTTP;
+using namespace SimpleHTTP::internal;
+
+// Number of operations per measurement.
+const int iterations = 100000;
+
+// Prevents the compiler from optimizing away the results.
+volatile size_t sink;
+
+// Builds a request head with the given number of additional header fields.
+string buildHead(int headerCount) {
+  string head = "POST /api/v1/users/42/orders?filter=active&page=2 HTTP/1.1\r\n";
+  head += "Host: example.com\r\n";
+  head += "User-Agent: Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 (KHTML, like Gecko)\r\n";
+  head += "Accept: text/html,application/xhtml+xml,application/xml;q=0.9,*/*;q=0.8\r\n";
+  for (int i = 0; i < headerCount; i++) {
+    head += "X-Custom-Header-" + to_string(i) + ": some-reasonably-long-header-value-" + to_string(i) + "\r\n";
+  }
+  head += "\r\n";
+  return head;
+}
+
+// Encodes the body with transfer encoding "chunked" using chunks of the given size.
+string buildChunkedBody(size_t bodySize, size_t chunkSize) {
+  string encoded;
+  for (size_t offset = 0; offset < bodySize; offset += chunkSize) {
+    size_t size = min(chunkSize, bodySize-offset);
+    char sizeLine[32];
+    snprintf(sizeLine, sizeof(sizeLine), "%zx\r\n", size);
+    encoded += sizeLine;
+    encoded.append(size, 'x');
+    encoded += "\r\n";
+  }
+  encoded += "0\r\n\r\n";
+  return encoded;
+}
+
+// Parses the head into a request allocated on a per-request arena (like the event loop does).
+size_t parseHead(const string& head, helper::Arena& arena) {
+  helper::Buffer buffer;
+  buffer = head;
+  size_t pathSize;
+  {
+    RequestImpl request(&arena);
+    if (!deserializeRequest(buffer, request, 8192)) return 0;
+    pathSize = request.getPathView().size();
+  }
+  arena.Reset();
+  return pathSize;
+}
+
+// Decodes the fully buffered chunked body.
+size_t decodeChunked(const string& encoded) {
+  helper::Socket socket;
+  helper::Buffer initBuffer;
+  initBuffer = encoded;
+  ChunkedBodyImpl body(&socket, 8192, std::move(initBuffer), SIZE_MAX);
+  vector<unsigned char> out;
+  body.setReadRequest(INT_MAX, &out);
+  if (!body.processRequest()) return 0;
+  return out.size();
+}
+
+// Serializes a response with some headers and the body into a send queue and drains it.
+size_t serialize(const string& responseBody) {
+  ResponseImpl response;
+  response.setStatusCode(200).setBody(responseBody);
+  response.setHeader("Content-Type", "application/json");
+  response.setHeader("Cache-Control", "no-cache");
+  helper::SendQueue queue;
+  serializeResponse(response, queue);
+  size_t size = queue.size();
+  queue.consume(size);
+  return size;
+}
+
+// Appends socket reads of the given segment size to the buffer and consumes them line by line.
+size_t bufferLines(const string& data, size_t segmentSize) {
+  helper::Buffer buffer;
+  size_t lines = 0;
+  for (size_t offset = 0; offset < data.size(); offset += segmentSize) {
+    size_t size = min(segmentSize, data.size()-offset);
+    buffer.insert(data.data()+offset, data.data()+offset+size);
+    string_view view;
+    size_t lineEnd;
+    while ((lineEnd = (view = buffer.view()).find('\n')) != string_view::npos) {
+      buffer.set(lineEnd);
+      buffer.eraseBeforeCursor();
+      lines++;
+    }
+  }
+  return lines;
+}
+
+// Measures the operation and prints cycles per operation and the throughput in bytes per cycle.
+template <typename F>
+void measure(const string& name, size_t bytes, F&& operation) {
+  // Warm up caches and branch predictors
+  for (int i = 0; i < iterations / 10; i++) sink = operation();
+
+  unsigned long long start = __rdtsc();
+  for (int i = 0; i < iterations; i++) sink = operation();
+  unsigned long long cycles = __rdtsc() - start;
+
+  double cyclesPerOp = double(cycles) / iterations;
+  cout << "  " << name << ": " << cyclesPerOp << " cycles/op, "
+       << double(bytes) / cyclesPerOp << " bytes/cycle" << endl;
+}
+
+int main(void) {
+  helper::Arena arena;
+
+  cout << "deserializeRequest" << endl;
+  for (int headerCount : {4, 32}) {
+    string head = buildHead(headerCount);
+    measure(to_string(headerCount + 3) + " header fields (" + to_string(head.size()) + " bytes)",
+      head.size(), [&]() { return parseHead(head, arena); });
+  }
+
+  cout << "ChunkedBodyImpl decoding" << endl;
+  for (auto [bodySize, chunkSize] : {pair<size_t, size_t>{1024, 128}, {65536, 256}, {65536, 2048}, {65536, 16384}}) {
+    string encoded = buildChunkedBody(bodySize, chunkSize);
+    measure(to_string(bodySize) + " byte body in " + to_string(chunkSize) + " byte chunks",
+      encoded.size(), [&]() { return decodeChunked(encoded); });
+  }
+
+  cout << "serializeResponse" << endl;
+  for (size_t bodySize : {16, 4096, 65536}) {
+    string responseBody(bodySize, 'x');
+    measure(to_string(bodySize) + " byte body", bodySize, [&]() { return serialize(responseBody); });
+  }
+
+  cout << "helper::Buffer" << endl;
+  string lines = buildHead(64);
+  for (size_t segmentSize : {64, 1460}) {
+    measure(to_string(lines.size()) + " bytes in " + to_string(segmentSize) + " byte reads",
+      lines.size(), [&]() { return bufferLines(lines, segmentSize); });
+  }
+  return 0;
+}
@@ -0,0 +1,111 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <functional>
+#include <x86intrin.h>
+
+#include "src/simplehttp.hpp"
+
+using namespace std;
+
+using namespace SimpleHTTP;
+using namespace SimpleHTTP::internal;
+
+// Number of operations per measurement.
+const int iterations = 1000000;
+
+// Number of distinct handlers called round robin (like requests spread over many routes).
+const int handlerCount = 256;
+
+// Prevents the compiler from optimizing away the results.
+volatile size_t sink;
+
+// Handler signature stored by the server before the inplace storage.
+using StdRouteFunction = function<Task<bool>(Request&, Body&, Response&)>;
+
+// Objects passed to the handlers (the handlers do not touch them).
+struct DispatchContext {
+  helper::Arena arena;
+  helper::Socket socket;
+  RequestImpl request{&arena};
+  ResponseImpl response;
+  FixedBodyImpl body{&socket, 8192, 0, helper::Buffer()};
+};
+
+// Creates a handler which only captures a pointer.
+auto smallHandler(size_t *counter) {
+  return [counter](Request &, Body &, Response &) -> Task<bool> {
+    (*counter)++;
+    co_return true;
+  };
+}
+
+// Creates a handler which captures a string and some configuration (56 bytes).
+auto largeHandler(size_t *counter, int index) {
+  return [counter, name = "handler-" + to_string(index), limit = size_t(index), flag = true]
+    (Request &, Body &, Response &) -> Task<bool> {
+    *counter += name.size() > limit && flag;
+    co_return true;
+  };
+}
+
+// Creates a handler which is no coroutine, so that only the dispatch itself is measured.
+auto plainHandler(size_t *counter) {
+  return [counter](Request &, Body &, Response &) {
+    (*counter)++;
+    return Task<bool>();
+  };
+}
+
+// Dispatches a request to the handler like the event loop does:
+// the coroutine frame is allocated on the arena and the function runs until it completes.
+template <typename Func>
+size_t dispatch(Func &func, DispatchContext &ctx) {
+  {
+    helper::Arena::Scope arenaScope(&ctx.arena);
+    Task<bool> task = func(ctx.request, ctx.body, ctx.response);
+    if (!task.done()) task.resume();
+  }
+  ctx.arena.Reset();
+  return 0;
+}
+
+// Measures the operation and prints cycles per operation.
+template <typename F>
+void measure(const string& name, F&& operation) {
+  // Warm up caches and branch predictors
+  for (int i = 0; i < iterations / 10; i++) sink = operation(i);
+
+  unsigned long long start = __rdtsc();
+  for (int i = 0; i < iterations; i++) sink = operation(i);
+  unsigned long long cycles = __rdtsc() - start;
+
+  cout << "  " << name << ": " << double(cycles) / iterations << " cycles/op" << endl;
+}
+
+// Measures dispatching to handlers stored as std::function and as RouteFunction.
+template <typename MakeHandler>
+void compare(const string& name, DispatchContext &ctx, MakeHandler&& makeHandler) {
+  vector<StdRouteFunction> stdFunctions;
+  vector<RouteFunction> routeFunctions(handlerCount);
+  for (int i = 0; i < handlerCount; i++) {
+    stdFunctions.emplace_back(makeHandler(i));
+    routeFunctions[i] = makeHandler(i);
+  }
+
+  cout << name << endl;
+  measure("std::function", [&](int i) { return dispatch(stdFunctions[i % handlerCount], ctx); });
+  measure("RouteFunction", [&](int i) { return dispatch(routeFunctions[i % handlerCount], ctx); });
+}
+
+int main(void) {
+  DispatchContext ctx;
+  size_t counter = 0;
+
+  compare("plain handler (no coroutine)", ctx, [&](int) { return plainHandler(&counter); });
+  compare("coroutine handler capturing a pointer", ctx, [&](int) { return smallHandler(&counter); });
+  compare("coroutine handler capturing 56 bytes", ctx, [&](int i) { return largeHandler(&counter, i); });
+
+  sink = counter;
+  return 0;
+}
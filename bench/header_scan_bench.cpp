@@ -0,0 +1,115 @@
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <cstring>
+#include <x86intrin.h>
+
+#include "src/simplehttp.hpp"
+
+using namespace std;
+
+using namespace SimpleHTTP::internal;
+
+// Number of times every head is scanned per measurement.
+const int iterations = 200000;
+
+// Prevents the compiler from optimizing away the scan results.
+volatile size_t sink;
+
+// Builds a request head with the given number of header fields.
+string buildHead(int headerCount) {
+  string head = "GET /api/v1/resource?filter=active&page=2 HTTP/1.1\r\n";
+  head += "Host: example.com\r\n";
+  head += "User-Agent: Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 (KHTML, like Gecko)\r\n";
+  head += "Accept: text/html,application/xhtml+xml,application/xml;q=0.9,*/*;q=0.8\r\n";
+  for (int i = 0; i < headerCount; i++) {
+    head += "X-Custom-Header-" + to_string(i) + ": some-reasonably-long-header-value-" + to_string(i) + "\r\n";
+  }
+  head += "\r\n";
+  return head;
+}
+
+// Scans the head byte by byte with a branch per delimiter (the previous Buffer::next() based parser).
+size_t scanLegacy(helper::Buffer &buffer) {
+  size_t delimiters = 0;
+  optional<char> c;
+  buffer.reset();
+  while ((c = buffer.next()).has_value()) {
+    if (c.value()==' ' || c.value()==':' || c.value()=='\r' || c.value()=='\n') delimiters++;
+  }
+  return delimiters;
+}
+
+// Returns the index of the first occurrence of c in data starting at pos with memchr (libc baseline).
+size_t findMemchr(string_view data, size_t pos, char c) {
+  if (pos >= data.size()) return string_view::npos;
+  const void* found = memchr(data.data() + pos, c, data.size() - pos);
+  return found ? static_cast<const char*>(found) - data.data() : string_view::npos;
+}
+
+// Returns the index of the first occurrence of c in data starting at pos with string_view::find.
+size_t findStd(string_view data, size_t pos, char c) {
+  return data.find(c, pos);
+}
+
+// Scans the head for the head end, all line ends and the colon of every header field.
+// find(data, pos, c) returns the index of the next c (like helper::FindByte()),
+// the head end is searched like helper::FindHeadEnd().
+template <typename Find>
+size_t scanDelimiters(string_view head, Find&& find) {
+  size_t delimiters = 0;
+  size_t headEnd = string_view::npos;
+  for (size_t pos = find(head, 0, '\n'); pos != string_view::npos; pos = find(head, pos+1, '\n')) {
+    if (pos+1 < head.size() && head[pos+1]=='\n') { headEnd = pos+1; break; }
+    if (pos+2 < head.size() && head[pos+1]=='\r' && head[pos+2]=='\n') { headEnd = pos+2; break; }
+  }
+  for (size_t lineStart = 0; lineStart < headEnd; ) {
+    size_t lineEnd = find(head, lineStart, '\n');
+    string_view line = head.substr(lineStart, lineEnd-lineStart);
+    delimiters += find(line, 0, ':');
+    lineStart = lineEnd+1;
+  }
+  return delimiters;
+}
+
+// Scans the head with helper::FindByte() on the given instruction set.
+size_t scanDelimiters(string_view head, helper::ScanLevel level) {
+  return scanDelimiters(head, [level](string_view data, size_t pos, char c) {
+    return helper::FindByte(data, pos, c, level);
+  });
+}
+
+// Measures the scan and prints the throughput in bytes per cycle.
+template <typename F>
+void measure(const string& name, size_t bytes, F&& scan) {
+  // Warm up caches and branch predictors
+  for (int i = 0; i < iterations / 10; i++) sink = scan();
+
+  unsigned long long start = __rdtsc();
+  for (int i = 0; i < iterations; i++) sink = scan();
+  unsigned long long cycles = __rdtsc() - start;
+
+  double bytesPerCycle = double(bytes) * iterations / double(cycles);
+  cout << "  " << name << ": " << bytesPerCycle << " bytes/cycle" << endl;
+}
+
+int main(void) {
+  for (int headerCount : {4, 32}) {
+    string head = buildHead(headerCount);
+    helper::Buffer buffer;
+    buffer = head;
+
+    cout << "Head with " << headerCount + 3 << " header fields (" << head.size() << " bytes)" << endl;
+    measure("legacy Buffer::next()", head.size(), [&]() { return scanLegacy(buffer); });
+    measure("memchr", head.size(), [&]() { return scanDelimiters(head, findMemchr); });
+    measure("string_view::find", head.size(), [&]() { return scanDelimiters(head, findStd); });
+    measure("scalar", head.size(), [&]() { return scanDelimiters(head, helper::ScanLevel::SCALAR); });
+    measure("sse2", head.size(), [&]() { return scanDelimiters(head, helper::ScanLevel::SSE2); });
+    if (helper::DetectScanLevel()==helper::ScanLevel::AVX2) {
+      measure("avx2", head.size(), [&]() { return scanDelimiters(head, helper::ScanLevel::AVX2); });
+    } else {
+      cout << "  avx2: not supported by this cpu" << endl;
+    }
+  }
+  return 0;
+}
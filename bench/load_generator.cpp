@@ -0,0 +1,323 @@
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <future>
+#include <chrono>
+#include <algorithm>
+#include <cstring>
+
+#include <sys/socket.h>
+#include <sys/epoll.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "src/simplehttp.hpp"
+
+using namespace std;
+
+using namespace SimpleHTTP;
+
+// Options of the load generator (set via --name=value arguments).
+struct Options {
+  // Number of client connections
+  int connections = 64;
+  // Number of requests in flight per connection
+  int pipeline = 1;
+  // Size of the request body (0 sends GET requests without body)
+  size_t requestBody = 0;
+  // Size of the response body
+  size_t responseBody = 64;
+  // Duration of the measurement in seconds
+  int duration = 10;
+  // Path of the unix socket (empty uses tcp over loopback)
+  string unixPath = "";
+  // Tcp port used on loopback
+  int port = 8080;
+  // Number of server event loops
+  int workerThreads = 1;
+  // Event backend of the server
+  EventBackend backend = EventBackend::EPOLL;
+  // Register connections edge triggered (epoll backend only)
+  bool edgeTriggered = false;
+};
+
+// State of one client connection.
+struct Connection {
+  int fd = -1;
+  // Request data which is not sent yet
+  string pending;
+  size_t pendingOffset = 0;
+  // Received data of incomplete responses
+  string received;
+  // Send timestamps of the requests in flight (oldest first)
+  deque<chrono::steady_clock::time_point> inFlight;
+  // Whether EPOLLOUT is currently registered
+  bool writeInterest = false;
+};
+
+// Parses the arguments into the options. Returns false on unknown or invalid arguments.
+bool parseOptions(int argc, char** argv, Options& options) {
+  for (int i = 1; i < argc; i++) {
+    string_view arg = argv[i];
+    auto eq = arg.find('=');
+    if (arg.substr(0, 2)!="--" || eq==string_view::npos) return false;
+    string_view name = arg.substr(2, eq-2);
+    string value(arg.substr(eq+1));
+    try {
+      if (name=="connections") options.connections = stoi(value);
+      else if (name=="pipeline") options.pipeline = stoi(value);
+      else if (name=="request-body") options.requestBody = stoul(value);
+      else if (name=="response-body") options.responseBody = stoul(value);
+      else if (name=="duration") options.duration = stoi(value);
+      else if (name=="unix") options.unixPath = value;
+      else if (name=="port") options.port = stoi(value);
+      else if (name=="threads") options.workerThreads = stoi(value);
+      else if (name=="backend" && value=="epoll") options.backend = EventBackend::EPOLL;
+      else if (name=="backend" && value=="io_uring") options.backend = EventBackend::IO_URING;
+      else if (name=="edge-triggered") options.edgeTriggered = stoi(value)!=0;
+      else return false;
+    } catch (const exception&) {
+      return false;
+    }
+  }
+  return options.connections > 0 && options.pipeline > 0 && options.duration > 0;
+}
+
+// Opens a non-blocking client connection to the server. Returns -1 on failure.
+int connectServer(const Options& options) {
+  int fd;
+  int res;
+  if (options.unixPath.empty()) {
+    fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    struct sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(options.port);
+    inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+    res = connect(fd, (struct sockaddr*)&addr, sizeof(addr));
+    int flag = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
+  } else {
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    struct sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, options.unixPath.c_str(), sizeof(addr.sun_path)-1);
+    res = connect(fd, (struct sockaddr*)&addr, sizeof(addr));
+  }
+  if (res < 0) {
+    close(fd);
+    return -1;
+  }
+  fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+  return fd;
+}
+
+// Waits until the server accepts connections (up to 10 seconds).
+bool waitForServer(const Options& options) {
+  for (int i = 0; i < 100; i++) {
+    int fd = connectServer(options);
+    if (fd >= 0) {
+      close(fd);
+      return true;
+    }
+    this_thread::sleep_for(chrono::milliseconds(100));
+  }
+  return false;
+}
+
+// Parses one complete response from the front of the data.
+// Returns the size of the response, 0 if it is incomplete or -1 if it is invalid.
+ssize_t parseResponse(string_view data) {
+  size_t headEnd = data.find("\r\n\r\n");
+  if (headEnd==string_view::npos) return 0;
+  string_view head = data.substr(0, headEnd);
+  if (head.substr(0, 12)!="HTTP/1.1 200") return -1;
+  size_t lengthPos = head.find("Content-Length: ");
+  if (lengthPos==string_view::npos) return -1;
+  size_t contentLength = strtoul(head.data()+lengthPos+16, nullptr, 10);
+  size_t size = headEnd+4+contentLength;
+  return data.size() < size ? 0 : size;
+}
+
+// Updates the epoll interest of the connection (EPOLLOUT only while request data is pending).
+void updateInterest(int epollfd, Connection& connection) {
+  bool writeInterest = connection.pendingOffset < connection.pending.size();
+  if (writeInterest==connection.writeInterest) return;
+  struct epoll_event event = {};
+  event.events = EPOLLIN | (writeInterest ? EPOLLOUT : 0);
+  event.data.ptr = &connection;
+  epoll_ctl(epollfd, EPOLL_CTL_MOD, connection.fd, &event);
+  connection.writeInterest = writeInterest;
+}
+
+// Sends pending request data. Returns false if the connection failed.
+bool flushRequests(Connection& connection) {
+  while (connection.pendingOffset < connection.pending.size()) {
+    ssize_t n = send(connection.fd, connection.pending.data()+connection.pendingOffset,
+      connection.pending.size()-connection.pendingOffset, MSG_NOSIGNAL);
+    if (n < 0) return errno==EAGAIN || errno==EWOULDBLOCK;
+    connection.pendingOffset += n;
+  }
+  connection.pending.clear();
+  connection.pendingOffset = 0;
+  return true;
+}
+
+// Returns the latency percentile (0-1) in microseconds of the sorted latencies.
+double percentile(const vector<uint64_t>& sorted, double p) {
+  if (sorted.empty()) return 0;
+  size_t index = min(sorted.size()-1, size_t(p * sorted.size()));
+  return sorted[index] / 1000.0;
+}
+
+int main(int argc, char** argv) {
+  Options options;
+  if (!parseOptions(argc, argv, options)) {
+    cerr << "Usage: " << argv[0] << " [--connections=N] [--pipeline=N] [--request-body=BYTES]"
+         << " [--response-body=BYTES] [--duration=SECONDS] [--unix=PATH] [--port=PORT]"
+         << " [--threads=N] [--backend=epoll|io_uring] [--edge-triggered=0|1]" << endl;
+    return 1;
+  }
+
+  ServerConfiguration config = {
+    .sockQueueSize = max(16, options.connections),
+    .workerThreads = options.workerThreads,
+    .eventBackend = options.backend,
+    .edgeTriggered = options.edgeTriggered,
+  };
+  unique_ptr<Server> server = options.unixPath.empty()
+    ? make_unique<Server>("127.0.0.1", options.port, config)
+    : make_unique<Server>(options.unixPath, config);
+
+  // Route reads the full request body and responds with the configured response body
+  string responseBody(options.responseBody, 'x');
+  auto handler = [&responseBody](Request &req, Body &body, Response &res) -> Task<bool> {
+    co_await body.readAll();
+    res.setStatusCode(200).setBody(responseBody);
+    co_return true;
+  };
+  server->Route("GET", "/load", handler);
+  server->Route("POST", "/load", handler);
+
+  future<void> serverFut = async(launch::async, [&server]() {
+    server->Serve();
+  });
+  if (!waitForServer(options)) {
+    cerr << "Failed connecting to the server" << endl;
+    server->Kill();
+    return 1;
+  }
+
+  // Build the request sent by all connections
+  string request;
+  if (options.requestBody==0) {
+    request = "GET /load HTTP/1.1\r\nHost: localhost\r\n\r\n";
+  } else {
+    request = "POST /load HTTP/1.1\r\nHost: localhost\r\nContent-Length: " +
+      to_string(options.requestBody) + "\r\n\r\n" + string(options.requestBody, 'x');
+  }
+
+  int epollfd = epoll_create1(0);
+  vector<Connection> connections(options.connections);
+  for (auto& connection : connections) {
+    connection.fd = connectServer(options);
+    if (connection.fd < 0) {
+      cerr << "Failed opening connection: " << strerror(errno) << endl;
+      server->Kill();
+      return 1;
+    }
+    struct epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.ptr = &connection;
+    epoll_ctl(epollfd, EPOLL_CTL_ADD, connection.fd, &event);
+  }
+
+  // Fill the pipeline of every connection
+  auto start = chrono::steady_clock::now();
+  for (auto& connection : connections) {
+    for (int i = 0; i < options.pipeline; i++) {
+      connection.pending += request;
+      connection.inFlight.push_back(start);
+    }
+    flushRequests(connection);
+    updateInterest(epollfd, connection);
+  }
+
+  // Latencies in nanoseconds of all completed requests
+  vector<uint64_t> latencies;
+  latencies.reserve(1 << 20);
+  size_t errors = 0;
+  auto end = start + chrono::seconds(options.duration);
+  vector<struct epoll_event> events(options.connections);
+  char buffer[65536];
+
+  while (chrono::steady_clock::now() < end) {
+    int n = epoll_wait(epollfd, events.data(), events.size(), 100);
+    for (int i = 0; i < n; i++) {
+      Connection& connection = *(Connection*)events[i].data.ptr;
+      if (connection.fd < 0) continue;
+      bool healthy = true;
+
+      if (events[i].events & EPOLLOUT) healthy = flushRequests(connection);
+
+      if (healthy && events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+        ssize_t r;
+        while ((r = recv(connection.fd, buffer, sizeof(buffer), 0)) > 0) {
+          connection.received.append(buffer, r);
+        }
+        if (r==0 || (r < 0 && errno!=EAGAIN && errno!=EWOULDBLOCK)) healthy = false;
+
+        // Complete responses and replace every one with a new request
+        auto now = chrono::steady_clock::now();
+        size_t offset = 0;
+        ssize_t size;
+        while ((size = parseResponse(string_view(connection.received).substr(offset))) > 0) {
+          offset += size;
+          latencies.push_back(chrono::duration_cast<chrono::nanoseconds>(now - connection.inFlight.front()).count());
+          connection.inFlight.pop_front();
+          connection.pending += request;
+          connection.inFlight.push_back(now);
+        }
+        connection.received.erase(0, offset);
+        if (size < 0) healthy = false;
+        if (healthy) healthy = flushRequests(connection);
+      }
+
+      if (!healthy) {
+        // Failed connections are counted and not replaced
+        errors++;
+        epoll_ctl(epollfd, EPOLL_CTL_DEL, connection.fd, nullptr);
+        close(connection.fd);
+        connection.fd = -1;
+        continue;
+      }
+      updateInterest(epollfd, connection);
+    }
+  }
+  double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+  for (auto& connection : connections) {
+    if (connection.fd >= 0) close(connection.fd);
+  }
+  close(epollfd);
+  server->Kill();
+  serverFut.get();
+
+  sort(latencies.begin(), latencies.end());
+  cout << options.connections << " connections, pipeline depth " << options.pipeline
+       << ", request body " << options.requestBody << " bytes, response body " << options.responseBody
+       << " bytes over " << (options.unixPath.empty() ? "tcp" : "unix socket") << endl;
+  cout << "  requests: " << latencies.size() << " (" << size_t(latencies.size() / elapsed) << " req/s)" << endl;
+  cout << "  latency p50: " << percentile(latencies, 0.5) << "us, p99: " << percentile(latencies, 0.99)
+       << "us, p99.9: " << percentile(latencies, 0.999) << "us, max: " << percentile(latencies, 1) << "us" << endl;
+  cout << "  failed connections: " << errors << endl;
+  return errors==0 ? 0 : 1;
+}
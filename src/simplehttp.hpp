@@ -21,10 +21,13 @@
 #define SIMPLEHTTP_H
 
 // Libs available on >libstdc++20 / >libc++20
+#include <algorithm>
 #include <atomic>
 #include <cctype>
+#include <charconv>
 #include <cerrno>
 #include <chrono>
+#include <condition_variable>
 #include <exception>
 #include <functional>
 #include <iostream>
@@ -33,13 +36,20 @@
 #include <optional>
 #include <stdexcept>
 #include <string>
+#include <string_view>
+#include <span>
 #include <sstream>
+#include <thread>
+#include <type_traits>
 #include <utility>
+#include <variant>
 #include <vector>
 
+#include <deque>
 #include <unordered_map>
 #include <unordered_set>
 
+#include <climits>
 #include <cstring>
 #include <ctime>
 #include <filesystem>
@@ -50,14 +60,27 @@
 // Libs available on POSIX systems
 #include <sys/socket.h>
 #include <sys/un.h>
+#include <sys/uio.h>
 #include <unistd.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <fcntl.h>
+#include <sys/stat.h>
 
 // Libs only available on Linux systems
 #include <sys/epoll.h>
 #include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/sendfile.h>
+#include <sys/syscall.h>
+#include <poll.h>
+#include <linux/io_uring.h>
+#include <linux/time_types.h>
+
+// SIMD intrinsics (only available on x86_64, other platforms use the scalar fallback)
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
 
 using namespace std;
 
@@ -149,8 +172,126 @@ namespace SimpleHTTP::internal::helper {
   };
 
 
+  /**
+   * Pipe used to move data between file descriptors with splice() without copying it to user space
+   *
+   * The pipe is created lazily on the first call to Open() and closed on destruction.
+   * Pipes are reused through the PipePool.
+   */
+  class Pipe {
+  public:
+    /**
+     * Creates the nonblocking pipe if it is not open yet
+     *
+     * Returns false with errno set if the pipe could not be created
+     */
+    bool Open() {
+      if (readEnd.getfd() >= 0) return true;
+      int fds[2];
+      if (pipe2(fds, O_NONBLOCK | O_CLOEXEC) < 0) return false;
+      readEnd = FileDescriptor(fds[0]);
+      writeEnd = FileDescriptor(fds[1]);
+      return true;
+    }
+
+    /**
+     * Returns the filedescriptor of the read end
+     */
+    int ReadFd() const noexcept {
+      return readEnd.getfd();
+    }
+
+    /**
+     * Returns the filedescriptor of the write end
+     */
+    int WriteFd() const noexcept {
+      return writeEnd.getfd();
+    }
+
+  private:
+    FileDescriptor readEnd;
+    FileDescriptor writeEnd;
+  };
+
+
+  /**
+   * Returns a per-thread scratch buffer of at least size bytes
+   *
+   * Used for transient socket reads instead of stack buffers sized by the configuration.
+   * The buffer is only valid until the next call on the same thread.
+   */
+  inline unsigned char* ScratchBuffer(size_t size) {
+    thread_local vector<unsigned char> scratch;
+    if (scratch.size() < size) scratch.resize(size);
+    return scratch.data();
+  }
+
+
+  /**
+   * Per-thread pool of pipes used to splice body data (see BodyImpl::spliceSocket())
+   *
+   * Every event loop runs on its own thread, so the bodies of a loop share its pipes instead of creating
+   * one per body. A body only holds a pipe while data is pending in it (its target blocked), otherwise
+   * the pipe is returned right away. Pipes returned with pending data (e.g. writing failed) are drained.
+   */
+  class PipePool {
+  public:
+    /**
+     * Takes an empty pipe from the pool, a new pipe is created if the pool is empty
+     *
+     * Returns false with errno set if the pipe could not be created
+     */
+    static bool Take(Pipe& pipe) {
+      auto &pipes = Pipes();
+      if (pipes.empty()) return pipe.Open();
+      pipe = std::move(pipes.back());
+      pipes.pop_back();
+      return true;
+    }
+
+    /**
+     * Returns the pipe to the pool (if it is open)
+     *
+     * If pendingSize bytes were not moved out of the pipe, they are discarded.
+     * Pipes that cannot be drained are closed instead.
+     */
+    static void Return(Pipe& pipe, size_t pendingSize) {
+      if (pipe.ReadFd() < 0) return;
+      if (pendingSize > 0) {
+        // The pipe is nonblocking, it is read until it is empty
+        unsigned char* buffer = ScratchBuffer(drainBufferSize);
+        while (read(pipe.ReadFd(), buffer, drainBufferSize) > 0);
+        if (errno != EAGAIN && errno != EWOULDBLOCK) {
+          pipe = Pipe();
+          return;
+        }
+      }
+      Pipes().push_back(std::move(pipe));
+    }
+
+  private:
+    // Size of the buffer used to drain pipes
+    static constexpr size_t drainBufferSize = 65536;
+
+    /**
+     * Returns the pipes of the current thread
+     */
+    static vector<Pipe>& Pipes() {
+      thread_local vector<Pipe> pipes;
+      return pipes;
+    }
+  };
+
+
   /**
    * String wrapper providing head and rollback cursor for efficient parsing
+   *
+   * Data is consumed from the front by advancing a front offset instead of erasing it,
+   * this makes eraseBeforeCursor() O(1). Consumed data is released lazily, once it makes up
+   * the larger part of the underlying string (amortized O(1) per byte), while the stored data
+   * always remains contiguous.
+   *
+   * Index 0 refers to the first unconsumed element.
    */
   class Buffer {
   public:
@@ -160,12 +301,15 @@ namespace SimpleHTTP::internal::helper {
      * Initialize buffer, move other buffer data and reset cursor
      */
     Buffer(Buffer&& other) noexcept : buffer(std::move(other.buffer)),
+                                      front(other.front),
                                       headCursor(-1),
-                                      rollbackCursor(-1) {}
+                                      rollbackCursor(-1) {
+      other.front = 0;
+    }
     /**
      * Initialize buffer, copy other buffer data and reset cursor
      */
-    Buffer(const Buffer& other) noexcept : buffer(other.buffer),
+    Buffer(const Buffer& other) noexcept : buffer(other.view()),
                                            headCursor(-1),
                                            rollbackCursor(-1) {}
 
@@ -175,6 +319,8 @@ namespace SimpleHTTP::internal::helper {
     Buffer& operator=(Buffer&& other) noexcept {
       if (this!=&other) {
         buffer = std::move(other.buffer);
+        front = other.front;
+        other.front = 0;
         headCursor = -1;
         rollbackCursor = -1;
       }
@@ -186,7 +332,8 @@ namespace SimpleHTTP::internal::helper {
      */
     Buffer& operator=(const Buffer& other) noexcept {
       if (this!=&other) {
-        buffer = other.buffer;
+        buffer = other.view();
+        front = 0;
         headCursor = -1;
         rollbackCursor = -1;
       }
@@ -198,6 +345,7 @@ namespace SimpleHTTP::internal::helper {
      */
     Buffer& operator=(const string& other) {
       buffer = other;
+      front = 0;
       headCursor = -1;
       rollbackCursor = -1;
       return *this;
@@ -208,6 +356,7 @@ namespace SimpleHTTP::internal::helper {
      */
     Buffer& operator=(const char* other) {
       buffer = other;
+      front = 0;
       headCursor = -1;
       rollbackCursor = -1;
       return *this;
@@ -241,7 +390,7 @@ namespace SimpleHTTP::internal::helper {
      */
     optional<char> current() {
       if (headCursor>-1)
-        return buffer[headCursor];
+        return buffer[front+headCursor];
       else
         return nullopt;
     }
@@ -254,8 +403,8 @@ namespace SimpleHTTP::internal::helper {
      */
     optional<char> next() {
       int nextCursor = headCursor+1;
-      if (nextCursor<int(buffer.size()))
-        return buffer[headCursor=nextCursor];
+      if (nextCursor<size())
+        return buffer[front+(headCursor=nextCursor)];
       else
         return nullopt;
     }
@@ -291,7 +440,7 @@ namespace SimpleHTTP::internal::helper {
      * and the cursor is not changed
      */
     bool set(int newpos) {
-      if (newpos<int(buffer.size()) && newpos>=-1) {
+      if (newpos<size() && newpos>=-1) {
         headCursor = newpos;
         return true;
       } else
@@ -304,18 +453,29 @@ namespace SimpleHTTP::internal::helper {
      */
     bool increment(int update) {
       int nextCursor = headCursor+update;
-      if (nextCursor<int(buffer.size()) && nextCursor>=-1) {
+      if (nextCursor<size() && nextCursor>=-1) {
         headCursor = nextCursor;
         return true;
       } else
         return false;
     }
       
+    /**
+     * Clears the buffer and resets cursors, the allocated storage is kept
+     */
+    Buffer& clear() {
+      buffer.clear();
+      front = 0;
+      headCursor = -1;
+      rollbackCursor = -1;
+      return *this;
+    }
+
     /**
      * Returns wheter the buffer from index 0 is empty
      */
     bool empty() {
-      return buffer.empty();
+      return size()==0;
     }
 
     /**
@@ -341,28 +501,37 @@ namespace SimpleHTTP::internal::helper {
      * is not strictly string data (if it can contain \0)
      */
     const char* cstr() {
-      return buffer.c_str();
+      return buffer.c_str()+front;
     }
 
     /**
      * Get copy of the underlying string from index 0
      */
     string str() {
-      return buffer;
+      return string(view());
+    }
+
+    /**
+     * Get view on the underlying string from index 0
+     *
+     * The view is invalidated by any modification of the buffer
+     */
+    string_view view() const {
+      return string_view(buffer).substr(front);
     }
 
     /**
      * Get copy of the underlying data from index 0
      */
     vector<unsigned char> vec() {
-      return vector<unsigned char>(buffer.begin(), buffer.end());
+      return vector<unsigned char>(buffer.begin()+front, buffer.end());
     }
 
     /**
      * Returns the size of the buffer from index 0
      */
     int size() {
-      return buffer.size();
+      return buffer.size()-front;
     }
 
     /**
@@ -375,9 +544,9 @@ namespace SimpleHTTP::internal::helper {
      */
     const char* cstrAfterCursor() {
       if (headCursor>-1)
-        return &buffer[headCursor];
+        return &buffer[front+headCursor];
       else
-        return &buffer[0];
+        return &buffer[front];
     }
 
     /**
@@ -387,9 +556,9 @@ namespace SimpleHTTP::internal::helper {
      */
     string strAfterCursor() {
       if (headCursor>-1)
-        return string(buffer.begin()+headCursor, buffer.end());
+        return string(buffer.begin()+front+headCursor, buffer.end());
       else
-        return string(buffer.begin(), buffer.end());
+        return string(buffer.begin()+front, buffer.end());
     }
 
     /**
@@ -399,7 +568,7 @@ namespace SimpleHTTP::internal::helper {
      */
     string strBeforeCursor() {
       if (headCursor>-1)
-        return string(buffer.begin(), buffer.begin()+headCursor+1);
+        return string(buffer.begin()+front, buffer.begin()+front+headCursor+1);
       else
         return "";
     }
@@ -411,9 +580,9 @@ namespace SimpleHTTP::internal::helper {
      */
     vector<unsigned char> vecAfterCursor() {
       if (headCursor>-1)
-        return vector<unsigned char>(buffer.begin()+headCursor, buffer.end());
+        return vector<unsigned char>(buffer.begin()+front+headCursor, buffer.end());
       else
-        return vector<unsigned char>(buffer.begin(), buffer.end());
+        return vector<unsigned char>(buffer.begin()+front, buffer.end());
     }
 
     /**
@@ -423,7 +592,7 @@ namespace SimpleHTTP::internal::helper {
      */
     vector<unsigned char> vecBeforeCursor() {
       if (headCursor>-1)
-        return vector<unsigned char>(buffer.begin(), buffer.begin()+headCursor+1);
+        return vector<unsigned char>(buffer.begin()+front, buffer.begin()+front+headCursor+1);
       else
         return {};
     }
@@ -437,16 +606,20 @@ namespace SimpleHTTP::internal::helper {
      * Incrementing the offset will make it erase more data of the right side of the cursor
      *
      * If cursor is on -1 (after offset is applied) data is erased from 0 to 0 (no data is erased)
+     *
+     * The data is not moved, only the front offset is advanced (see Buffer)
      */
     Buffer& eraseBeforeCursor(uint offset=0) {
       // Create the index, up to which the data will be erased
       int index = headCursor+offset;
       // Check if in upper bounds
-      if (index>int(buffer.size()))
-        // If size exceeded, cap index to buffer size
-        index = buffer.size();
-      // Erase data
-      buffer.erase(buffer.begin(), buffer.begin()+index+1);
+      if (index>=size())
+        // If size exceeded, cap index to the last element
+        index = size()-1;
+      // Advance front offset
+      front += index+1;
+      // Release consumed data if required
+      compact();
       // Set and commit cursor to 0
       set(-1);
       commit();
@@ -467,12 +640,12 @@ namespace SimpleHTTP::internal::helper {
       // Create the index, after which the data will be erased
       int index = headCursor-offset;
       // Check if in bounds
-      if (index>0)
-        // If size exceeded, cap index to 0
+      if (index<0)
+        // If index is below 0, cap index to 0
         index = 0;
-      buffer.erase(buffer.begin()+index, buffer.end());
+      buffer.erase(buffer.begin()+front+index, buffer.end());
       // Set cursor to last element
-      set(buffer.size()-1);
+      set(size()-1);
       commit();
       return *this;
     }
@@ -484,9 +657,9 @@ namespace SimpleHTTP::internal::helper {
      */
     int sizeAfterCursor() {
       if (headCursor>-1)
-        return buffer.size() - headCursor;
+        return size() - headCursor;
       else
-        return buffer.size();
+        return size();
     }
 
     /**
@@ -499,1355 +672,5441 @@ namespace SimpleHTTP::internal::helper {
     }
 
   private:
+    // Minimum amount of consumed data released at once
+    static constexpr size_t compactThreshold = 4096;
+    
     string buffer;
+    // Offset of index 0 in the underlying string (data before it is consumed)
+    size_t front = 0;
     int headCursor = -1;
     int rollbackCursor = -1;
+
+    /**
+     * Releases consumed data at the front of the underlying string
+     *
+     * If everything is consumed, the string is cleared (capacity is kept).
+     * Otherwise consumed data is only released if it exceeds the compactThreshold and
+     * the unconsumed data, which bounds the moved data by the consumed data.
+     */
+    void compact() {
+      if (front==buffer.size()) {
+        buffer.clear();
+        front = 0;
+      } else if (front>=compactThreshold && front>=buffer.size()-front) {
+        buffer.erase(0, front);
+        front = 0;
+      }
+    }
   };
-} // namespace SimpleHTTP::internal::helper
 
 
-namespace SimpleHTTP {
-  
   /**
-   * Generic handle wrapper for coroutine
-   *
-   * Used as return type from coroutines
+   * Regular file opened for reading (see FileCache)
+   */
+  struct File {
+    // Filedescriptor of the opened file
+    FileDescriptor fd;
+    // Size of the file in bytes
+    size_t size;
+    // Last modification time of the file
+    time_t modified;
+    // Identity of the file, used to detect if the path was replaced
+    dev_t device;
+    ino_t inode;
+    timespec modifiedExact;
+  };
+
+  /**
+   * Range of an opened file, sent without copying it to user space (see Socket::SendFile())
+   */
+  struct FileRange {
+    shared_ptr<const File> file;
+    off_t offset;
+    size_t length;
+  };
+
+  /**
+   * Per-thread cache of opened files
    *
-   * Ensures the underlying coroutine_handle is only attached to one Task
-   */ 
-  template <typename T>
-  class Task {
+   * Files served repeatedly are opened only once. An entry is reused without any syscall for the
+   * revalidateInterval, afterwards the path is checked with stat() and reopened if the file changed.
+   * Files remain opened while they are referenced (e.g. by queued responses), even if they were evicted.
+   */
+  class FileCache {
   public:
-    // Define promise type (predefined coroutine struct)
-    struct promise_type {
-      // Generic return value
-      T value;
-      // Exception ptr
-      exception_ptr exception = nullptr;
-      // Predefined coroutine function called when creating the coroutine
-      Task get_return_object() {
-        return Task{coroutine_handle<promise_type>::from_promise(*this)};
+    /**
+     * Get the opened file of the path
+     *
+     * Returns nullptr with errno set if the path cannot be opened or is no regular file
+     */
+    static shared_ptr<const File> Open(const string &path) {
+      auto now = chrono::steady_clock::now();
+      auto it = entries.find(path);
+      if (it != entries.end()) {
+        it->second.lastUsed = now;
+        if (now - it->second.validated < revalidateInterval) return it->second.file;
+        // Revalidate the entry, it is kept if the path still refers to the unchanged file
+        struct stat pathStat;
+        if (stat(path.c_str(), &pathStat) < 0) {
+          entries.erase(it);
+          return nullptr;
+        }
+        auto &file = *it->second.file;
+        if (pathStat.st_dev==file.device && pathStat.st_ino==file.inode && size_t(pathStat.st_size)==file.size &&
+            pathStat.st_mtim.tv_sec==file.modifiedExact.tv_sec && pathStat.st_mtim.tv_nsec==file.modifiedExact.tv_nsec) {
+          it->second.validated = now;
+          return it->second.file;
+        }
+        entries.erase(it);
       }
-      // Predefined function called when coroutine is initialized
-      // Coroutine is immediately suspended when created
-      suspend_always initial_suspend() { return {}; }
-      // Predefined function called before coroutine is destroyed (value is returned)
-      // Suspend finished coroutine, to obtain things like return value / exception from the frame
-      // Without suspending the operation after completion, the resources may be cleaned up before reading
-      suspend_always final_suspend() noexcept { return {}; } 
-      // Predefined function called when returning the value (co_return)
-      void return_value(T v) { value = v; } // Store return value in promise frame before handle is destroyed
-      // Predefined function called when exception is thrown
-      void unhandled_exception() { exception = current_exception(); } // Store exception to handle it later
+
+      FileDescriptor fd(open(path.c_str(), O_RDONLY | O_CLOEXEC));
+      if (fd.getfd() < 0) return nullptr;
+      struct stat fileStat;
+      if (fstat(fd.getfd(), &fileStat) < 0) return nullptr;
+      if (!S_ISREG(fileStat.st_mode)) {
+        errno = S_ISDIR(fileStat.st_mode) ? EISDIR : EINVAL;
+        return nullptr;
+      }
+      auto file = make_shared<File>(File{
+        .fd = std::move(fd),
+        .size = size_t(fileStat.st_size),
+        .modified = fileStat.st_mtim.tv_sec,
+        .device = fileStat.st_dev,
+        .inode = fileStat.st_ino,
+        .modifiedExact = fileStat.st_mtim,
+      });
+
+      // Evict the least recently used entry if the cache is full
+      if (entries.size() >= maxEntries) {
+        auto oldest = min_element(entries.begin(), entries.end(), [](auto &a, auto &b) {
+          return a.second.lastUsed < b.second.lastUsed;
+        });
+        entries.erase(oldest);
+      }
+      entries[path] = Entry{file, now, now};
+      return file;
+    }
+
+  private:
+    struct Entry {
+      // Opened file
+      shared_ptr<const File> file;
+      // Time the file was opened or last validated
+      chrono::steady_clock::time_point validated;
+      // Time the entry was last used
+      chrono::steady_clock::time_point lastUsed;
     };
 
-    // Default constructor sets coroutine to nullptr
-    Task() : coro(nullptr) {}
-    // Constructor to initialize handle
-    Task(coroutine_handle<promise_type> h) : coro(h) {}
-    // Destructor to cleanup handle
-    ~Task() { if (coro) coro.destroy(); }
+    // Interval in which cached files are used without validating the path
+    static constexpr chrono::seconds revalidateInterval = chrono::seconds(1);
+    // Maximum number of opened files per thread
+    static constexpr size_t maxEntries = 256;
+    // Cached files by path
+    static inline thread_local unordered_map<string, Entry> entries;
+  };
 
-    // Delete copy constructor
-    Task(const Task&) = delete;
 
-    // Move constructor explicitly sets the other coroutine to nullptr
-    // To prevent double destruction
-    Task(Task&& other) noexcept : coro(other.coro) {
-      other.coro = nullptr;
-    }
-      
-    // Delete copy assignment
-    Task& operator=(const Task&) = delete;
+  /**
+   * Derives the Content-Type from the extension of the path
+   *
+   * Unknown extensions are served as application/octet-stream
+   */
+  inline string_view ContentTypeOf(string_view path) {
+    static const unordered_map<string_view, string_view> types = {
+      {"html", "text/html; charset=utf-8"},
+      {"htm", "text/html; charset=utf-8"},
+      {"css", "text/css; charset=utf-8"},
+      {"js", "text/javascript; charset=utf-8"},
+      {"mjs", "text/javascript; charset=utf-8"},
+      {"json", "application/json"},
+      {"map", "application/json"},
+      {"txt", "text/plain; charset=utf-8"},
+      {"log", "text/plain; charset=utf-8"},
+      {"md", "text/markdown; charset=utf-8"},
+      {"csv", "text/csv; charset=utf-8"},
+      {"xml", "application/xml"},
+      {"svg", "image/svg+xml"},
+      {"png", "image/png"},
+      {"jpg", "image/jpeg"},
+      {"jpeg", "image/jpeg"},
+      {"gif", "image/gif"},
+      {"webp", "image/webp"},
+      {"ico", "image/x-icon"},
+      {"pdf", "application/pdf"},
+      {"wasm", "application/wasm"},
+      {"zip", "application/zip"},
+      {"gz", "application/gzip"},
+      {"tar", "application/x-tar"},
+    };
+    auto slash = path.rfind('/');
+    auto dot = path.rfind('.');
+    if (dot==string_view::npos || (slash!=string_view::npos && dot < slash)) return "application/octet-stream";
+    auto it = types.find(path.substr(dot+1));
+    return it==types.end() ? "application/octet-stream" : it->second;
+  }
 
-    // Move assignment explicitly sets the other coroutine to nullptr
-    // and destroys the local coroutine to prevent double destruction
-    Task& operator=(Task&& other) noexcept {
-      if (&other!=this) {
-        if (coro) coro.destroy();
-        coro = other.coro;
-        other.coro = nullptr;
+
+  /**
+   * Queue of data segments which are sent with a single scatter-gather call (see Socket::SendMsg())
+   *
+   * Segments are moved into the queue, so that large segments (e.g. response bodies)
+   * are never copied into an intermediate buffer.
+   * File segments are sent from the page cache (see Socket::SendFile()), data segments in front of
+   * a file segment are sent first.
+   * Sent data is consumed from the front, partially sent segments are tracked by an offset.
+   */
+  class SendQueue {
+  public:
+    /**
+     * Appends a segment to the queue (empty segments are skipped)
+     */
+    SendQueue& push(string&& segment) {
+      if (!segment.empty()) {
+        totalSize += segment.size();
+        segments.push_back(Segment{.data = std::move(segment)});
       }
       return *this;
     }
 
     /**
-     * Checks if coroutine is done/destroyed
+     * Appends a file segment to the queue (empty ranges are skipped)
      */
-    bool done() {
-      return !coro || coro.done();
+    SendQueue& push(FileRange&& range) {
+      if (range.length > 0) {
+        totalSize += range.length;
+        segments.push_back(Segment{.file = std::move(range)});
+      }
+      return *this;
     }
 
     /**
-     * Resumes execution of the coroutine
-     *
-     * If the coroutine is suspended, it will return nullopt
-     * otherwise the return value is returned
-     *
-     * Throws a logic_error if coroutine is accessed after its completed
-     * Rethrows exception if the coroutine completed with an uncaught exception
+     * Removes all segments, the allocated storage of the queue is kept
      */
-    optional<T> resume() {
-      if (!coro || coro.done()) {
-        // Resuming coroutine which is done() is undefined
-        throw logic_error("Attempt to resume a completed coroutine");
-      }
-      // Resume coroutine
-      coro.resume();
-      if (coro.done()) {
-        // If coroutine returned, handle return / exception
-
-        // Rethrow exception on exception
-        if (coro.promise().exception) {
-          rethrow_exception(coro.promise().exception);
-        }
-        // Return value
-        return coro.promise().value;
-      } else {
-        // Else return nullopt
-        return nullopt;
-      }
+    void clear() {
+      segments.clear();
+      front = 0;
+      totalSize = 0;
+      iovecs.clear();
     }
-  private:
-    // Main coroutine handle
-    coroutine_handle<promise_type> coro;
-  };
-} // namespace SimpleHTTP
-  
 
-namespace SimpleHTTP::internal {
-
-  /**
-   * Abstract internal request interface defining members used to manipulate the Request object
-   *
-   * Not visible to the end user
-   */
-  class RequestInternal {
-  public:
-    virtual ~RequestInternal() {}
-
-    // Some getters are defined here and in the external Request object
-    // 'cause the eventloop needs them to deserialize dynamically based on the values already set
-    
     /**
-     * Get HTTP method (e.g. GET, POST)
+     * Returns whether the queue contains unsent data
      */
-    virtual string getMethod() const noexcept = 0;
+    bool empty() const noexcept {
+      return totalSize==0;
+    }
 
     /**
-     * Get HTTP path/route (e.g. /api/some)
+     * Returns the size of the unsent data
      */
-    virtual string getPath() const noexcept = 0;
+    size_t size() const noexcept {
+      return totalSize;
+    }
 
     /**
-     * Get HTTP version (e.g. HTTP/1.1)
-     */
-    virtual string getVersion() const noexcept = 0;
-    
+     * Builds the iovec array describing the unsent data up to the next file segment
+     * (capped to IOV_MAX segments)
+     *
+     * The array is empty if the front segment is a file segment.
+     * The array remains valid until the queue is modified or iov() is called again
+     */
+    pair<const struct iovec*, int> iov() {
+      iovecs.clear();
+      for (size_t i = 0; i < segments.size() && i < size_t(IOV_MAX); i++) {
+        if (segments[i].file.has_value()) break;
+        size_t offset = i==0 ? front : 0;
+        iovecs.push_back({segments[i].data.data()+offset, segments[i].data.size()-offset});
+      }
+      return {iovecs.data(), int(iovecs.size())};
+    }
+
     /**
-     * Set HTTP method (e.g. GET, POST) to the request
+     * Returns the unsent range of the front segment, if it is a file segment
      */
-    virtual RequestInternal& setMethod(string newmethod) = 0;
+    optional<FileRange> file() const {
+      if (segments.empty() || !segments.front().file.has_value()) return nullopt;
+      auto &range = segments.front().file.value();
+      return FileRange{range.file, range.offset+off_t(front), range.length-front};
+    }
 
     /**
-     * Set HTTP path to the request
+     * Returns whether the data described by iov() is followed by a file segment
      */
-    virtual RequestInternal& setPath(string newpath) = 0;
+    bool fileFollows() const noexcept {
+      return iovecs.size() < segments.size() && segments[iovecs.size()].file.has_value();
+    }
 
     /**
-     * Set HTTP version to the request
+     * Reads up to maxSize bytes of the front file segment into a data segment in front of it
+     *
+     * Used if the file cannot be sent from the page cache (e.g. by completion backends).
+     *
+     * Returns false with errno set if the file cannot be read
+     */
+    bool loadFile(size_t maxSize) {
+      auto range = file();
+      if (!range) return true;
+      string data(min(maxSize, range->length), '\0');
+      ssize_t n = pread(range->file->fd.getfd(), data.data(), data.size(), range->offset);
+      if (n < 1) {
+        // A truncated file cannot fill the announced length anymore
+        if (n == 0) errno = EIO;
+        return false;
+      }
+      data.resize(n);
+      // Split the loaded data from the front segment
+      auto &segment = segments.front().file.value();
+      segment.offset = range->offset + n;
+      segment.length = range->length - n;
+      front = 0;
+      if (segment.length == 0) segments.pop_front();
+      segments.push_front(Segment{.data = std::move(data)});
+      return true;
+    }
+
+    /**
+     * Consumes n bytes of sent data from the front of the queue
      */
-    virtual RequestInternal& setVersion(string newversion) = 0;
+    void consume(size_t n) {
+      totalSize -= n;
+      while (n > 0) {
+        size_t remaining = segments.front().size()-front;
+        if (n < remaining) {
+          front += n;
+          return;
+        }
+        n -= remaining;
+        segments.pop_front();
+        front = 0;
+      }
+    }
 
+  private:
     /**
-     * Set a header to the request
-     *
-     * Key is converted to lowercase
+     * Queued segment holding either data or a file range
      */
-    virtual RequestInternal& setHeader(string key, string value) = 0;
+    struct Segment {
+      string data{};
+      optional<FileRange> file{};
+
+      size_t size() const noexcept {
+        return file.has_value() ? file->length : data.size();
+      }
+    };
+
+    // Queued segments
+    deque<Segment> segments;
+    // Offset of the unsent data in the first segment
+    size_t front = 0;
+    // Size of the unsent data
+    size_t totalSize = 0;
+    // iovec array handed to the socket
+    vector<struct iovec> iovecs;
   };
-} // namespace SimpleHTTP::internal
 
 
-namespace SimpleHTTP {
+  /**
+   * Encodes data as chunk of a chunked body (Transfer-Encoding: chunked)
+   *
+   * Returns the chunk (hex size line, data and terminating CRLF)
+   */
+  inline string EncodeChunk(string_view data) {
+    char sizeLine[sizeof(size_t)*2];
+    auto [sizeEnd, ec] = to_chars(sizeLine, sizeLine+sizeof(sizeLine), data.size(), 16);
+    string chunk;
+    chunk.reserve((sizeEnd-sizeLine) + data.size() + 4);
+    chunk.append(sizeLine, sizeEnd).append("\r\n").append(data).append("\r\n");
+    return chunk;
+  }
+
 
   /**
-   * Abstract external request interface defining members used to inspect the Request object
+   * Deleter for objects created on an arena
+   *
+   * Only the destructor is invoked, the memory is released when the arena is reset
    */
-  class Request {
+  template <typename T>
+  struct ArenaDeleter {
+    ArenaDeleter() noexcept {}
+    // Allow conversion from deleters of derived objects
+    template <typename U>
+    ArenaDeleter(const ArenaDeleter<U>&) noexcept {}
+
+    void operator()(T* ptr) const noexcept {
+      ptr->~T();
+    }
+  };
+
+  /**
+   * Owning pointer to an object created on an arena
+   */
+  template <typename T>
+  using ArenaPtr = unique_ptr<T, ArenaDeleter<T>>;
+
+  /**
+   * Monotonic arena allocator
+   *
+   * Memory is allocated by advancing an offset in the current block. Deallocation is a no-op,
+   * all memory is released at once by Reset(), which rewinds the arena in O(1) and keeps the
+   * blocks for reuse. Objects allocated on the arena must be destroyed before it is reset.
+   */
+  class Arena {
   public:
-    virtual ~Request() {};
+    Arena(size_t blockSize=4096) : blockSize(blockSize) {}
+
+    // Allocated memory is referenced by pointers, therefore the arena must not be copied or moved
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
     /**
-     * Get HTTP method (e.g. GET, POST)
+     * Arena used by allocations that have no direct access to an arena (e.g. coroutine frames)
+     *
+     * Set with a Scope, nullptr if allocations are not bound to an arena
      */
-    virtual string getMethod() const noexcept = 0;
+    static inline thread_local Arena* current = nullptr;
 
     /**
-     * Get HTTP path/route (e.g. /api/some)
+     * Sets the current arena for the lifetime of the scope
      */
-    virtual string getPath() const noexcept = 0;
+    class Scope {
+    public:
+      Scope(Arena* arena) : previous(current) { current = arena; }
+      ~Scope() { current = previous; }
+      Scope(const Scope&) = delete;
+      Scope& operator=(const Scope&) = delete;
+    private:
+      // Arena restored when the scope ends
+      Arena* previous;
+    };
 
     /**
-     * Get HTTP version (e.g. HTTP/1.1)
+     * Allocates memory with the specified size and alignment
      */
-    virtual string getVersion() const noexcept = 0;
+    void* Allocate(size_t size, size_t alignment=alignof(max_align_t)) {
+      while (1) {
+        if (blockIndex < blocks.size()) {
+          auto &block = blocks[blockIndex];
+          uintptr_t base = uintptr_t(block.data.get());
+          uintptr_t aligned = (base + offset + alignment-1) & ~uintptr_t(alignment-1);
+          if (aligned + size <= base + block.size) {
+            offset = aligned + size - base;
+            return (void*)aligned;
+          }
+          // Block is exhausted, continue with the next block
+          // (unused blocks which are too small remain for later allocations)
+          if (offset > 0) {
+            blockIndex++;
+            offset = 0;
+            continue;
+          }
+        }
+        // Insert a new block which is large enough for the allocation
+        size_t newSize = max(blockSize, size + alignment);
+        blocks.insert(blocks.begin()+blockIndex, Block{make_unique<char[]>(newSize), newSize});
+        offset = 0;
+      }
+    }
 
     /**
-     * Get Content-Length header as integer
-     *
-     * If no valid content-length is set, nullopt is returned
+     * Creates an object on the arena
      */
-    virtual optional<int> getContentLength() = 0;
+    template <typename T, typename... Args>
+    ArenaPtr<T> New(Args&&... args) {
+      return ArenaPtr<T>(new (Allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...));
+    }
 
     /**
-     * Get Transfer-Encoding header as list of encodings (e.g. [ gzip, chunked ])
-     *
-     * If no valid transfer-encoding header is set, nullopt is returned
+     * Releases all allocated memory, the blocks are kept for reuse
      */
-    virtual optional<unordered_set<string>> getTransferEncoding() = 0;
+    void Reset() noexcept {
+      blockIndex = 0;
+      offset = 0;
+    }
 
-    /**
-     * Get a query parameter from the request
-     */
-    virtual optional<string> getQueryParam(string key) = 0;
+  private:
+    struct Block {
+      // Memory of the block
+      unique_ptr<char[]> data;
+      // Size of the block
+      size_t size;
+    };
 
-    /**
-     * Get a header from the request
-     *
-     * Key is strictly lowercase
-     */
-    virtual optional<string> getHeader(string key) = 0;
+    // Default size of a block
+    size_t blockSize;
+    // Allocated blocks
+    vector<Block> blocks;
+    // Index of the block allocations are taken from
+    size_t blockIndex = 0;
+    // Offset of the free memory in the current block
+    size_t offset = 0;
   };
-} // namespace SimpleHTTP
 
+  /**
+   * STL compatible allocator drawing from an arena
+   *
+   * If no arena is set, the regular heap is used
+   */
+  template <typename T>
+  class ArenaAllocator {
+  public:
+    using value_type = T;
+
+    ArenaAllocator(Arena* arena=nullptr) noexcept : arena(arena) {}
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) noexcept : arena(other.arena) {}
 
+    T* allocate(size_t n) {
+      if (arena) return static_cast<T*>(arena->Allocate(n*sizeof(T), alignof(T)));
+      return allocator<T>().allocate(n);
+    }
 
-namespace SimpleHTTP::internal {
+    void deallocate(T* ptr, size_t n) noexcept {
+      // Memory of the arena is released when it is reset
+      if (!arena) allocator<T>().deallocate(ptr, n);
+    }
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U>& other) const noexcept {
+      return arena==other.arena;
+    }
+
+    // Arena the memory is taken from (nullptr for the heap)
+    Arena* arena;
+  };
 
   /**
-   * Request objects internal derivate, implementing members of the internal and external interfaces
+   * Vector drawing from an arena
    */
-  class RequestImpl : public SimpleHTTP::Request, public SimpleHTTP::internal::RequestInternal {
+  template <typename T>
+  using ArenaVector = vector<T, ArenaAllocator<T>>;
+
+  /**
+   * Unordered map drawing from an arena
+   */
+  template <typename K, typename V>
+  using ArenaMap = unordered_map<K, V, hash<K>, equal_to<K>, ArenaAllocator<pair<const K, V>>>;
+
+
+  template <typename Signature, size_t Capacity>
+  class InplaceFunction;
+
+  /**
+   * Move-only callable stored in an inline buffer (type erasure without heap allocation)
+   *
+   * In contrast to std::function, the callable is always stored inside of the object and called with
+   * a single indirect call. Callables larger than Capacity are rejected at compile time (see Fits).
+   */
+  template <typename R, typename... Args, size_t Capacity>
+  class InplaceFunction<R(Args...), Capacity> {
   public:
-    
     /**
-     * Get HTTP method (e.g. GET, POST)
-     */
-    string getMethod() const noexcept override {
-      return method;
+     * Checks if the callable can be stored inline
+     */
+    template <typename F>
+    static constexpr bool Fits = sizeof(F) <= Capacity && alignof(F) <= alignof(max_align_t)
+      && is_nothrow_move_constructible_v<F>;
+
+    InplaceFunction() noexcept {}
+
+    template <typename F, typename D = decay_t<F>>
+      requires (!is_same_v<D, InplaceFunction> && is_invocable_r_v<R, D&, Args...>)
+    InplaceFunction(F&& func) {
+      static_assert(Fits<D>, "Callable exceeds the inline capacity of the InplaceFunction");
+      new (storage) D(std::forward<F>(func));
+      invoker = [](void* target, Args... args) -> R {
+        return std::invoke(*static_cast<D*>(target), std::forward<Args>(args)...);
+      };
+      manager = [](void* target, void* source) noexcept {
+        // Moves the source into the target if set, otherwise destroys the target
+        if (source) {
+          new (target) D(std::move(*static_cast<D*>(source)));
+          static_cast<D*>(source)->~D();
+        } else {
+          static_cast<D*>(target)->~D();
+        }
+      };
     }
 
-    /**
-     * Get HTTP path/route (e.g. /api/some)
-     */
-    string getPath() const noexcept override {
-      return path;
+    ~InplaceFunction() { Reset(); }
+
+    InplaceFunction(const InplaceFunction&) = delete;
+    InplaceFunction& operator=(const InplaceFunction&) = delete;
+
+    InplaceFunction(InplaceFunction&& other) noexcept {
+      *this = std::move(other);
     }
 
-    /**
-     * Get HTTP version (e.g. HTTP/1.1)
-     */
-    string getVersion() const noexcept override {
-      return version;
+    // Moves the callable of other into this object, other is empty afterwards
+    InplaceFunction& operator=(InplaceFunction&& other) noexcept {
+      if (&other!=this) {
+        Reset();
+        if (other.invoker) {
+          other.manager(storage, other.storage);
+          invoker = other.invoker;
+          manager = other.manager;
+          other.invoker = nullptr;
+          other.manager = nullptr;
+        }
+      }
+      return *this;
     }
 
     /**
-     * Get Content-Length header as integer
-     *
-     * If no valid content-length is set, nullopt is returned
+     * Calls the stored callable (must not be empty)
      */
-    optional<int> getContentLength() override {
-      auto it = headers.find("content-length");
-      if (it == headers.end()) return nullopt;
-
-      // Convert value to integer with istringstream
-      istringstream iss(it->second);
-      int length;
-      if (iss >> length)
-        return length;
-      else return nullopt;
+    R operator()(Args... args) const {
+      return invoker(storage, std::forward<Args>(args)...);
     }
 
+    explicit operator bool() const noexcept { return invoker!=nullptr; }
+
+  private:
     /**
-     * Get Transfer-Encoding header as list of encodings (e.g. [ gzip, chunked ])
-     *
-     * If no valid transfer-encoding header is set, nullopt is returned
+     * Destroys the stored callable
      */
-    optional<unordered_set<string>> getTransferEncoding() override {
-      auto it = headers.find("transfer-encoding");
-      if (it == headers.end()) return nullopt;
+    void Reset() noexcept {
+      if (manager) manager(storage, nullptr);
+      invoker = nullptr;
+      manager = nullptr;
+    }
 
-      // Convert transfer-encoding to a string set
-      auto tokens = parseTransferEncoding(it->second);
-      // If no tokens are found return nullopt
-      if (tokens.empty()) return nullopt;
-      return tokens;
+    // Calls the callable stored in the buffer
+    R (*invoker)(void*, Args...) = nullptr;
+    // Moves or destroys the callable stored in the buffer
+    void (*manager)(void*, void*) noexcept = nullptr;
+    // Buffer holding the callable (mutable, as callables are invoked like std::function)
+    alignas(max_align_t) mutable unsigned char storage[Capacity];
+  };
+
+
+  /**
+   * Instruction set used to scan for delimiters
+   */
+  enum class ScanLevel {
+    SCALAR, // Byte by byte
+    SSE2, // 16 bytes at a time
+    AVX2, // 32 bytes at a time
+  };
+
+  /**
+   * Detects the best instruction set supported by the cpu (evaluated once)
+   */
+  inline ScanLevel DetectScanLevel() {
+#if defined(__x86_64__)
+    static const ScanLevel level = __builtin_cpu_supports("avx2") ? ScanLevel::AVX2 : ScanLevel::SSE2;
+    return level;
+#else
+    return ScanLevel::SCALAR;
+#endif
+  }
+
+  /**
+   * Returns the index of the first occurrence of c in data starting at pos (scalar fallback)
+   *
+   * Returns string_view::npos if c is not found
+   */
+  inline size_t FindByteScalar(string_view data, size_t pos, char c) {
+    for (; pos < data.size(); pos++) {
+      if (data[pos]==c) return pos;
     }
+    return string_view::npos;
+  }
 
-    /**
-     * Get a query parameter from the request
-     */
-    optional<string> getQueryParam(string key) override {
-      auto it = queries.find(key);
-      if (it != queries.end()) {
-        return it->second;
-      } else
-        return nullopt;
+#if defined(__x86_64__)
+  /**
+   * Returns the index of the first occurrence of c in data starting at pos (16 bytes at a time)
+   *
+   * Returns string_view::npos if c is not found
+   */
+  inline size_t FindByteSSE2(string_view data, size_t pos, char c) {
+    const __m128i needle = _mm_set1_epi8(c);
+    for (; pos + 16 <= data.size(); pos += 16) {
+      __m128i block = _mm_loadu_si128((const __m128i *)(data.data() + pos));
+      unsigned mask = _mm_movemask_epi8(_mm_cmpeq_epi8(block, needle));
+      if (mask) return pos + __builtin_ctz(mask);
     }
+    // Scan remaining bytes
+    return FindByteScalar(data, pos, c);
+  }
 
-    /**
-     * Get a header from the request
-     *
-     * Key is strictly lowercase
-     */
-    optional<string> getHeader(string key) override {
-      auto it = headers.find(key);
-      if (it != headers.end()) {
-        return it->second;
-      } else
-        return nullopt;
+  /**
+   * Returns the index of the first occurrence of c in data starting at pos (32 bytes at a time)
+   *
+   * Must only be called if the cpu supports AVX2 (see DetectScanLevel())
+   *
+   * Returns string_view::npos if c is not found
+   */
+  __attribute__((target("avx2")))
+  inline size_t FindByteAVX2(string_view data, size_t pos, char c) {
+    const __m256i needle = _mm256_set1_epi8(c);
+    for (; pos + 32 <= data.size(); pos += 32) {
+      __m256i block = _mm256_loadu_si256((const __m256i *)(data.data() + pos));
+      unsigned mask = _mm256_movemask_epi8(_mm256_cmpeq_epi8(block, needle));
+      if (mask) return pos + __builtin_ctz(mask);
     }
+    // Remaining bytes are scanned with the 16 byte variant
+    return FindByteSSE2(data, pos, c);
+  }
+#endif
 
-    /**
-     * Set HTTP method (e.g. GET, POST) to the request
-     */
-    RequestImpl& setMethod(string newmethod) override {
-      method = newmethod;
-      return *this;
+  /**
+   * Returns the index of the first occurrence of c in data starting at pos
+   *
+   * The SIMD variants are inlined, which matters for the short lines of a head: on a 454 byte head
+   * they scan ~1.6 bytes/cycle versus ~1.35 with memchr (on par at ~1.55 on a 2KiB head),
+   * see bench/header_scan_bench.cpp.
+   *
+   * Returns string_view::npos if c is not found
+   */
+  inline size_t FindByte(string_view data, size_t pos, char c, ScanLevel level = DetectScanLevel()) {
+    if (pos >= data.size()) return string_view::npos;
+    switch (level) {
+#if defined(__x86_64__)
+    case ScanLevel::AVX2:
+      return FindByteAVX2(data, pos, c);
+    case ScanLevel::SSE2:
+      return FindByteSSE2(data, pos, c);
+#endif
+    default:
+      return FindByteScalar(data, pos, c);
+    }
+  }
+
+  /**
+   * Returns the index of the last character ('\n') of the HTTP head in data
+   *
+   * The head is terminated by an empty line, carriage returns are optional ("\n\n" or "\n\r\n").
+   *
+   * Returns string_view::npos if the head is incomplete
+   */
+  inline size_t FindHeadEnd(string_view data, ScanLevel level = DetectScanLevel()) {
+    for (size_t pos = FindByte(data, 0, '\n', level); pos != string_view::npos;
+         pos = FindByte(data, pos+1, '\n', level)) {
+      if (pos+1 < data.size() && data[pos+1]=='\n') return pos+1;
+      if (pos+2 < data.size() && data[pos+1]=='\r' && data[pos+2]=='\n') return pos+2;
     }
+    return string_view::npos;
+  }
+
 
+  /**
+   * Hashed timer wheel tracking expiration times of connections
+   *
+   * Timers are stored in the slot of their expiration tick (tick modulo slot count).
+   * Advancing the wheel only visits the slots of the passed ticks, instead of scanning all timers.
+   * Timers further away than one wheel rotation remain in their slot until their round is reached.
+   * Non-empty slots are tracked in an occupancy bitmap, so that the next due slot is found
+   * by scanning one bit per slot (see NextTimeout()).
+   *
+   * Timers are identified by the connection filedescriptor and a connection id.
+   * The wheel itself does not support removal, the owner is expected to ignore timers
+   * of connections that no longer exist (id mismatch) when they expire.
+   */
+  class TimerWheel {
+  public:
     /**
-     * Set HTTP path to the request
+     * Timer stored in the wheel
      */
-    RequestImpl& setPath(string newpath) override {
-      path = parseQueryParameters(newpath);
-      return *this;
-    }
+    struct Timer {
+      // Filedescriptor of the connection
+      int fd;
+      // Unique id of the connection (used to detect timers of reused filedescriptors)
+      uint64_t id;
+      // Tick the timer expires on
+      int64_t tick;
+    };
 
     /**
-     * Set HTTP version to the request
+     * Initialize wheel with the tick resolution and the number of slots
      */
-    RequestImpl& setVersion(string newversion) override {
-      version = newversion;
-      return *this;
-    }
+    TimerWheel(chrono::milliseconds resolution=chrono::milliseconds(10), int slotCount=1024)
+      : resolution(resolution), slots(slotCount), occupied((slotCount + 63) / 64),
+        currentTick(TickOf(chrono::steady_clock::now())) {}
 
     /**
-     * Set a header to the request
+     * Insert timer for the connection
      *
-     * Key is converted to lowercase
-     */
-    RequestImpl& setHeader(string key, string value) override {
-      // Key & value are converted tolower
-      // in order to properly handle those in the internal structure
-      
-      // Convert key tolower
-      transform(key.begin(), key.end(), key.begin(),
-        [](unsigned char c){ return tolower(c); }
-      );
-      // Set kv pair
-      headers[key] = value;
-      return *this;
+     * The tick is rounded up, so that timers never expire before their expiration time.
+     * Timers in the past are inserted into the next tick, so that they expire on the next Advance()
+     */
+    void Insert(int fd, uint64_t id, chrono::steady_clock::time_point expiration) {
+      auto sinceEpoch = chrono::ceil<chrono::milliseconds>(expiration.time_since_epoch());
+      int64_t tick = max(int64_t((sinceEpoch + resolution - chrono::milliseconds(1)) / resolution), currentTick+1);
+      size_t index = tick % slots.size();
+      slots[index].push_back(Timer{fd, id, tick});
+      occupied[index / 64] |= uint64_t(1) << (index % 64);
+      timerCount++;
     }
 
-  private:
-    // HTTP Method (e.g. Get, Post, etc.)
-    string method;
-    // HTTP Path (e.g. /api/some)
-    string path;
-    // HTTP Version (e.g. HTTP/1.1)
-    string version;
-
-    // HTTP queries
-    unordered_map<string, string> queries;
-    // HTTP headers
-    unordered_map<string, string> headers;
-    
     /**
-     * Parse transfer encoding header into a string set
+     * Advance wheel to the specified time
      *
-     * Returns tokens parsed as string set
-     */
-    unordered_set<string> parseTransferEncoding(string rawValue) {
-      unordered_set<string> tokens;
-      // Create input stream
-      istringstream iss(rawValue);
-      string currentItem;
-      // Parse Transfer Encodings
-      while (getline(iss, currentItem, ',')) {
-        // Trim off spaces
-        auto start = currentItem.find_first_not_of(" ");
-        auto end = currentItem.find_last_not_of(" ");
-        // Skip if no regular char was found in the item
-        if (start==string::npos || end==string::npos) continue;
-        // Insert slice without spaces 
-        tokens.insert(currentItem.substr(start, end - start + 1));
+     * expire() is called for every timer that expired until the specified time.
+     * Timers can safely be inserted again from inside expire()
+     */
+    template <typename F>
+    void Advance(chrono::steady_clock::time_point now, F&& expire) {
+      int64_t nowTick = TickOf(now);
+      // If more ticks passed than the wheel has slots, every slot is visited once
+      int64_t startTick = max(currentTick+1, nowTick-int64_t(slots.size())+1);
+      // Update current tick before expiring, so that timers inserted by expire() land in a future slot
+      currentTick = max(currentTick, nowTick);
+      for (int64_t tick = startTick; tick <= nowTick; tick++) {
+        size_t index = tick % slots.size();
+        auto &slot = slots[index];
+        if (slot.empty()) continue;
+        // Timers of the slot are swapped out, this allows expire() to insert timers into the same slot
+        vector<Timer> slotTimers;
+        slotTimers.swap(slot);
+        for (auto &timer : slotTimers) {
+          if (timer.tick > nowTick) {
+            // Timer belongs to a later round
+            slot.push_back(timer);
+          } else {
+            timerCount--;
+            expire(timer);
+          }
+        }
+        if (slot.empty()) occupied[index / 64] &= ~(uint64_t(1) << (index % 64));
       }
-      return tokens;
     }
 
-    
     /**
-     * Parse query parameters from url and insert them to the queries map
-     *
-     * Query params are automatically inserted into the queries map
+     * Returns the time in milliseconds until the next slot holding a timer is due
      *
-     * Returns path without query parameters
-     */
-    string parseQueryParameters(string path) {
-      // Search query indicator
-      auto queryPos = path.find('?');
-      // If no query indicator is found, the path is not modified
-      if (queryPos==string::npos) return path;
-      // Obtain the new path (query params removed)
-      string newPath = path.substr(0, queryPos);
-
-      // Obtain the query param string as input stream
-      istringstream queryStream(path.substr(queryPos+1));
-
-      // Define token buffer
-      string token;
-      // Iterate over every query param (key=value) fragment
-      while (getline(queryStream, token, '&')) {
-        // Search split character ("=")
-        auto splitPos = token.find('=');
-        // If split char not found, the fragment is invalid and skipped
-        if (splitPos==string::npos) continue;
+     * Returns -1 if the wheel holds no timers (can be directly used as epoll_wait timeout)
+     */
+    int NextTimeout(chrono::steady_clock::time_point now) {
+      if (timerCount==0) return -1;
+      size_t start = (currentTick+1) % slots.size();
+      optional<size_t> index = NextOccupied(start);
+      if (!index.has_value()) return -1;
+      // Slots before start belong to the next rotation
+      int64_t tick = currentTick+1 + int64_t((index.value() + slots.size() - start) % slots.size());
+      // Calculate time until the tick is reached
+      auto due = chrono::steady_clock::time_point(resolution * tick);
+      auto timeout = chrono::ceil<chrono::milliseconds>(due - now).count();
+      return timeout > 0 ? int(timeout) : 0;
+    }
 
-        // Obtain query param key (first substr)
-        string key = token.substr(0, splitPos);
-        // Obtain query param value (second substr)
-        string value = token.substr(splitPos+1);
+  private:
+    // Duration of one tick
+    chrono::milliseconds resolution;
+    // Slots holding the timers
+    vector<vector<Timer>> slots;
+    // Occupancy bitmap of the slots (bit is set if the slot holds timers)
+    vector<uint64_t> occupied;
+    // Last tick processed by Advance()
+    int64_t currentTick;
+    // Number of timers stored in the wheel
+    size_t timerCount = 0;
+
+    /**
+     * Converts time_point to tick
+     */
+    int64_t TickOf(chrono::steady_clock::time_point time) {
+      return chrono::duration_cast<chrono::milliseconds>(time.time_since_epoch()) / resolution;
+    }
 
-        // Move values to the queries map
-        queries[std::move(key)] = std::move(value);
+    /**
+     * Returns the index of the first occupied slot from start on (wrapping around once)
+     *
+     * Returns nullopt if all slots are empty
+     */
+    optional<size_t> NextOccupied(size_t start) const {
+      size_t word = start / 64;
+      // Slots before start are masked out, they are checked last once the scan wrapped around
+      uint64_t bits = occupied[word] & (~uint64_t(0) << (start % 64));
+      for (size_t i = 0; i <= occupied.size(); i++) {
+        if (bits) return word * 64 + __builtin_ctzll(bits);
+        word = (word + 1) % occupied.size();
+        bits = occupied[word];
       }
-      return newPath;
+      return nullopt;
     }
   };
-} // namespace SimpleHTTP::internal
-
 
-namespace SimpleHTTP::internal {
 
   /**
-   * Abstract internal body interface defining members used for the body
+   * Queue of connections woken up by other threads (e.g. once offloaded work is completed)
    *
-   * Not visible to the end user
+   * Post() is thread-safe and signals the eventfd of the queue, which is attached to the event instance
+   * of the owning loop. The eventfd is only signaled if the queue was empty, as the loop takes all
+   * entries at once. Like timers, entries are identified by the connection filedescriptor and an id
+   * (the id of the wait), the owner is expected to ignore entries of waits that no longer exist.
    */
-  class BodyInternal {
+  class WakeQueue {
   public:
-    virtual ~BodyInternal() {}
+    /**
+     * Entry posted to the queue
+     */
+    struct Entry {
+      // Filedescriptor of the connection
+      int fd;
+      // Unique id of the wait completed by the entry
+      uint64_t id;
+    };
 
     /**
-     * Set read request to the body
+     * Creates the eventfd of the queue (check getfd() for failures)
      */
-    virtual void setReadRequest(int size, std::vector<unsigned char>* outBuffer) = 0;
-    
+    WakeQueue() : event(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)) {}
+
     /**
-     * Clear read request from the body
+     * Posts the connection to the queue and wakes up the owning loop
      */
-    virtual void clearReadRequest() = 0;
+    void Post(int fd, uint64_t id) {
+      bool notify;
+      {
+        lock_guard<mutex> lock(entriesMut);
+        notify = entries.empty();
+        entries.push_back(Entry{fd, id});
+      }
+      if (notify) {
+        uint64_t increment = 1;
+        write(event.getfd(), &increment, sizeof(uint64_t));
+      }
+    }
 
     /**
-     * Process the read request in the event loop
+     * Takes all posted entries
      */
-    virtual bool processRequest() = 0;
+    vector<Entry> Take() {
+      // The eventfd is reset before the entries are taken,
+      // therefore entries posted afterwards always signal it again
+      uint64_t value;
+      read(event.getfd(), &value, sizeof(uint64_t));
+      vector<Entry> taken;
+      lock_guard<mutex> lock(entriesMut);
+      taken.swap(entries);
+      return taken;
+    }
 
     /**
-     * Function to drain the body in the event loop
+     * Returns the eventfd signaled on new entries
      */
-    virtual optional<internal::helper::Buffer> drainBody() = 0;
+    int getfd() const noexcept {
+      return event.getfd();
+    }
+
+  private:
+    // Eventfd signaled if entries are posted to the empty queue
+    FileDescriptor event;
+    // Mutex lock protecting the entries
+    mutex entriesMut;
+    // Posted entries
+    vector<Entry> entries;
   };
-} // namespace SimpleHTTP::internal
 
 
-namespace SimpleHTTP {
+  /**
+   * Formats the time in the IMF-fixdate format of HTTP dates (e.g. "Sun, 06 Nov 1994 08:49:37 GMT")
+   */
+  inline string FormatHttpDate(time_t time) {
+    // Convert to GMT (gmtime_r, as dates are formatted by multiple threads)
+    tm timeTm;
+    gmtime_r(&time, &timeTm);
+    char buffer[32];
+    size_t size = strftime(buffer, sizeof(buffer), "%a, %d %b %Y %H:%M:%S GMT", &timeTm);
+    return string(buffer, size);
+  }
 
   /**
-   * Awaitable structure to schedule read requests
+   * Parses a date in the IMF-fixdate format of HTTP dates
+   *
+   * Returns nullopt if the date is invalid
    */
-  struct BodyReader {
-    internal::BodyInternal& body;
-    int size;
-    vector<unsigned char> outBuffer;
+  inline optional<time_t> ParseHttpDate(const string &date) {
+    tm dateTm = {};
+    const char *end = strptime(date.c_str(), "%a, %d %b %Y %H:%M:%S GMT", &dateTm);
+    if (!end || *end!='\0') return nullopt;
+    return timegm(&dateTm);
+  }
 
-    // Always suspend
-    bool await_ready() const noexcept { return false; }
 
-    // Before suspending a new readRequest is created
-    void await_suspend(coroutine_handle<> h) {
-      body.setReadRequest(size, &outBuffer);
+  /**
+   * Per-thread cache of the current date in the IMF-fixdate format (used for the Date header)
+   *
+   * The date has a resolution of one second, therefore it is only formatted again
+   * if the second changed. Event loops refresh the cache once per iteration.
+   */
+  class DateCache {
+  public:
+    /**
+     * Refresh the cached date, if the second of the specified time differs from the cached one
+     */
+    static void Refresh(chrono::system_clock::time_point now) {
+      time_t nowSecond = chrono::system_clock::to_time_t(now);
+      if (nowSecond == second) return;
+      date = FormatHttpDate(nowSecond);
+      second = nowSecond;
     }
 
-    // When resuming, reset the request and return the outBuffer
-    vector<unsigned char> await_resume() const {
-      body.clearReadRequest();
-      return outBuffer;
+    /**
+     * Get the cached date
+     *
+     * If the cache of this thread was never refreshed, it is refreshed with the current time
+     */
+    static const string& Get() {
+      if (second < 0) Refresh(chrono::system_clock::now());
+      return date;
     }
+
+  private:
+    // Second the cached date was formatted from (-1 if not formatted yet)
+    static inline thread_local time_t second = -1;
+    // Formatted date
+    static inline thread_local string date;
   };
 
+
   /**
-   * Datastructure defining a request to read a certain amount of data from the body
+   * Counter written by one thread and read by any thread (e.g. metrics of an event loop)
+   *
+   * The writer updates the value with a relaxed load / store instead of a locked read-modify-write,
+   * readers may observe a slightly outdated value.
    */
-  struct BodyReadRequest {
-    int size;
-    vector<unsigned char>* outBuffer;
+  class LocalCounter {
+  public:
+    void Add(uint64_t n) noexcept {
+      value.store(value.load(memory_order_relaxed)+n, memory_order_relaxed);
+    }
+
+    void Set(uint64_t n) noexcept {
+      value.store(n, memory_order_relaxed);
+    }
+
+    uint64_t Get() const noexcept {
+      return value.load(memory_order_relaxed);
+    }
+
+  private:
+    atomic<uint64_t> value = 0;
   };
 
-  
   /**
-   * Abstract external body interface defining members used to create a readrequest
-   *
-   * Provides functions to create a awaitable read request (read() / readAll())
+   * Latency histogram with fixed buckets, written by one thread (see LocalCounter)
    */
-  class Body {
+  class LatencyHistogram {
   public:
-    virtual ~Body() {};
+    // Upper bounds of the buckets in nanoseconds (followed by the +Inf bucket)
+    static constexpr uint64_t bounds[] = {
+      10'000, 25'000, 50'000, 100'000, 250'000, 500'000,
+      1'000'000, 2'500'000, 5'000'000, 10'000'000, 25'000'000, 50'000'000,
+      100'000'000, 250'000'000, 500'000'000, 1'000'000'000, 2'500'000'000, 5'000'000'000, 10'000'000'000
+    };
+    // Number of buckets (including +Inf)
+    static constexpr size_t bucketCount = size(bounds)+1;
 
     /**
-     * Read a specified amount data from the body
-     *
-     * Blocks until every the requested data is read
-     *
-     * This function will return an awaitable and schedules reading to the simplehttp event loop.
-     *
-     * Use this function inside a coroutine like this: "auto body = co_await readAll();"
-     *
-     * Returns a vector containing data. If the full body was read an empty vector is returned
+     * Record a duration
      */
-    virtual BodyReader read(int size) = 0;
+    void Record(chrono::nanoseconds duration) noexcept {
+      uint64_t ns = max<int64_t>(duration.count(), 0);
+      size_t bucket = lower_bound(begin(bounds), end(bounds), ns) - begin(bounds);
+      buckets[bucket].Add(1);
+      sum.Add(ns);
+    }
 
     /**
-     * Read all data from the body
-     *
-     * Blocks until every the full body is read
-     *
-     * This function will return an awaitable and schedules reading to the simplehttp event loop.
-     *
-     * Use this function inside a coroutine like this: "auto body = co_await readAll();"
-     *
-     * Returns a vector containing data. If the full body was read an empty vector is returned
+     * Get number of durations recorded in the bucket (not cumulative)
      */
-    virtual BodyReader readAll() = 0;
-  };
-} // namespace SimpleHTTP
+    uint64_t Count(size_t bucket) const noexcept {
+      return buckets[bucket].Get();
+    }
+
+    /**
+     * Get sum of all recorded durations in nanoseconds
+     */
+    uint64_t Sum() const noexcept {
+      return sum.Get();
+    }
 
+  private:
+    // Recorded durations per bucket
+    LocalCounter buckets[bucketCount];
+    // Sum of recorded durations
+    LocalCounter sum;
+  };
 
 
-namespace SimpleHTTP::internal {
-  
   /**
-   * Body objects internal derivate, implementing members to process the ReadRequest from internal eventloop
+   * Compressed radix tree mapping route patterns to values
+   *
+   * Patterns consist of static segments, parameter segments (":name") which match exactly one
+   * non-empty path segment and an optional trailing wildcard segment ("*name" or "*") which matches
+   * the rest of the path. Parameters and wildcards are only recognized at the start of a segment.
+   *
+   * Static segments are stored in compressed nodes (shared prefixes are split into own nodes).
+   * On lookup static matches take precedence over parameters, parameters over wildcards.
    */
-  class BodyImpl : public SimpleHTTP::Body, public SimpleHTTP::internal::BodyInternal {
+  template <typename T>
+  class RadixTree {
   public:
-    
     /**
-     * Read a specified amount data from the body
-     *
-     * Blocks until every the requested data is read
+     * Captured path parameter (name, value)
      *
-     * This function will return an awaitable and schedules reading to the simplehttp event loop.
+     * The name points into the tree, the value into the looked up path
+     */
+    using Param = pair<string_view, string_view>;
+
+    /**
+     * Inserts the pattern into the tree and returns the value associated with it
      *
-     * Use this function inside a coroutine like this: "auto body = co_await readAll();"
+     * If the pattern is already present, the existing value is returned
      *
-     * Returns a vector containing data. If the full body was read an empty vector is returned
-     */
-    BodyReader read(int size) override {
-      return BodyReader{*this, size};
+     * Throws a logic_error if the pattern conflicts with an inserted pattern
+     * (differently named parameter / wildcard at the same position) or if a wildcard is not trailing
+     */
+    T& Insert(string_view pattern) {
+      Node *node = &root;
+      size_t pos = 0;
+      while (pos < pattern.size()) {
+        bool segmentStart = pos==0 || pattern[pos-1]=='/';
+        if (segmentStart && pattern[pos]==':') {
+          // Parameter segment, the name reaches until the end of the segment
+          size_t nameEnd = min(pattern.find('/', pos), pattern.size());
+          node = InsertParam(node, pattern.substr(pos+1, nameEnd-pos-1));
+          pos = nameEnd;
+        } else if (segmentStart && pattern[pos]=='*') {
+          // Wildcard segment, the name reaches until the end of the pattern
+          string_view name = pattern.substr(pos+1);
+          if (name.find('/')!=string_view::npos) {
+            throw logic_error("Wildcard must be the last segment of route "+string(pattern));
+          }
+          if (!node->wildcard) {
+            node->wildcard = make_unique<Node>();
+            node->wildcardName = name.empty() ? "*" : string(name);
+          } else if (node->wildcardName!=(name.empty() ? "*" : name)) {
+            throw logic_error("Conflicting wildcard name in route "+string(pattern));
+          }
+          node = node->wildcard.get();
+          pos = pattern.size();
+        } else {
+          // Static part, it reaches until the next parameter / wildcard segment
+          size_t staticEnd = pos;
+          while (staticEnd < pattern.size()) {
+            staticEnd = pattern.find('/', staticEnd);
+            if (staticEnd==string_view::npos) {
+              staticEnd = pattern.size();
+              break;
+            }
+            staticEnd++;
+            if (staticEnd < pattern.size() && (pattern[staticEnd]==':' || pattern[staticEnd]=='*')) break;
+          }
+          node = InsertStatic(node, pattern.substr(pos, staticEnd-pos));
+          pos = staticEnd;
+        }
+      }
+      if (!node->value.has_value()) node->value.emplace();
+      return node->value.value();
     }
 
     /**
-     * Read all data from the body
-     *
-     * Blocks until every the full body is read
+     * Looks up the value matching the path
      *
-     * This function will return an awaitable and schedules reading to the simplehttp event loop.
+     * Captured parameters are appended to params. The lookup itself does not allocate.
      *
-     * Use this function inside a coroutine like this: "auto body = co_await readAll();"
+     * Returns nullptr if no pattern matches
+     */
+    T* Find(string_view path, ArenaVector<Param> &params) {
+      return Match(root, path, params);
+    }
+
+  private:
+    struct Node {
+      // Static part of the node (empty for the root, parameter and wildcard nodes)
+      string prefix;
+      // Static child nodes, their prefixes start with distinct characters
+      vector<unique_ptr<Node>> children;
+      // Parameter child node
+      unique_ptr<Node> param;
+      // Name of the parameter child
+      string paramName;
+      // Wildcard child node
+      unique_ptr<Node> wildcard;
+      // Name of the wildcard child
+      string wildcardName;
+      // Value if a pattern ends at this node
+      optional<T> value;
+    };
+
+    // Root node
+    Node root;
+
+    /**
+     * Inserts a static part below the node, splitting nodes on partially shared prefixes
      *
-     * Returns a vector containing data. If the full body was read an empty vector is returned
+     * Returns the node representing the end of the static part
      */
-    BodyReader readAll() override {
-      return BodyReader{*this, bodySize};
+    Node* InsertStatic(Node *node, string_view part) {
+      while (!part.empty()) {
+        // Search child sharing the first character
+        auto childIter = find_if(node->children.begin(), node->children.end(),
+          [&](auto &child) { return child->prefix[0]==part[0]; }
+        );
+        if (childIter==node->children.end()) {
+          // No shared prefix, create new leaf
+          auto child = make_unique<Node>();
+          child->prefix = string(part);
+          node->children.push_back(std::move(child));
+          return node->children.back().get();
+        }
+
+        // Determine length of the shared prefix
+        Node *child = childIter->get();
+        size_t common = 0;
+        while (common < part.size() && common < child->prefix.size() && part[common]==child->prefix[common]) {
+          common++;
+        }
+        if (common < child->prefix.size()) {
+          // Split child, the shared prefix becomes an own node
+          auto split = make_unique<Node>();
+          split->prefix = child->prefix.substr(0, common);
+          child->prefix.erase(0, common);
+          split->children.push_back(std::move(*childIter));
+          *childIter = std::move(split);
+          child = childIter->get();
+        }
+        node = child;
+        part.remove_prefix(common);
+      }
+      return node;
     }
 
-    
     /**
-     * Set read request to the body
+     * Inserts a parameter below the node
+     *
+     * Returns the parameter node
      */
-    void setReadRequest(int size, std::vector<unsigned char>* outBuffer) override {
-      request = BodyReadRequest{size, outBuffer};
+    Node* InsertParam(Node *node, string_view name) {
+      if (name.empty()) {
+        throw logic_error("Path parameter requires a name");
+      }
+      if (!node->param) {
+        node->param = make_unique<Node>();
+        node->paramName = string(name);
+      } else if (node->paramName!=name) {
+        throw logic_error("Conflicting path parameter names :"+node->paramName+" and :"+string(name));
+      }
+      return node->param.get();
     }
-    
+
     /**
-     * Clear read request from the body
+     * Matches the rest of the path below the node (backtracking to parameters / wildcards)
      */
-    void clearReadRequest() override {
-      request = nullopt;
+    T* Match(Node &node, string_view rest, ArenaVector<Param> &params) {
+      if (rest.empty() && node.value.has_value()) {
+        return &node.value.value();
+      }
+      // Static children
+      for (auto &child : node.children) {
+        if (rest.starts_with(child->prefix)) {
+          if (T* value = Match(*child, rest.substr(child->prefix.size()), params)) return value;
+          // Prefixes of children start with distinct characters, no other child can match
+          break;
+        }
+      }
+      // Parameter child (matches one non-empty segment)
+      if (node.param) {
+        string_view segment = rest.substr(0, rest.find('/'));
+        if (!segment.empty()) {
+          params.emplace_back(node.paramName, segment);
+          if (T* value = Match(*node.param, rest.substr(segment.size()), params)) return value;
+          params.pop_back();
+        }
+      }
+      // Wildcard child (matches the rest)
+      if (node.wildcard && node.wildcard->value.has_value()) {
+        params.emplace_back(node.wildcardName, rest);
+        return &node.wildcard->value.value();
+      }
+      return nullptr;
     }
-    
-  protected:
-    BodyImpl(
-      helper::FileDescriptor* socket,
-      int socketBufferSize,
-      int bodySize,
-      helper::Buffer initBuffer
-    ) : socket(socket), socketBufferSize(socketBufferSize), bodySize(bodySize), readBuffer(initBuffer) {}
-    
-    // Socket filedescriptor
-    helper::FileDescriptor* socket;
-    // Socket buffer size
-    int socketBufferSize;
-    // Remaining body size (this value is decremented when reading the body)
-    int bodySize;
-    // Temporary buffer holding the received data
-    // Data which is read from the user is erased from this
-    helper::Buffer readBuffer;
-    // Current pending read request
-    optional<BodyReadRequest> request;
   };
 
-  
+
   /**
-   * Inherited object to read an HTTP body with a fixed size
+   * Connection socket used by the connection state machine to receive and send data
    *
-   * Overrides functions to handle fixed HTTP bodys (Content-Length: xy)
+   * Recv() and SendMsg() behave like the recv() / sendmsg() syscalls on a nonblocking socket.
+   *
+   * In readiness mode (epoll backend) they directly perform the syscalls. The directions in which
+   * they blocked are recorded, so that edge triggered readiness can be tracked (see TakeBlockedEvents()).
+   *
+   * In completion mode (io_uring backend) no syscall is performed. Recv() returns data previously
+   * delivered by the backend and SendMsg() returns the result of the previously completed send operation.
+   * If no data / result is available, they fail with EAGAIN and register the operation,
+   * which is then submitted by the backend (see RequestedOperation()).
+   * Delivered data is referenced in the provided buffer of the backend, it can be parsed in place
+   * (see Delivered() / Consume()) until the buffer is released (see ReleaseBuffer()).
    */
-  class FixedBodyImpl : public SimpleHTTP::internal::BodyImpl {
+  class Socket {
   public:
-    FixedBodyImpl(
-      helper::FileDescriptor* socket,
-      int socketBufferSize,
-      int bodySize,
-      helper::Buffer initBuffer
-    ) : BodyImpl(socket, socketBufferSize, bodySize, initBuffer) {}
-    
     /**
-     * Reads the body with a fixed size (HTTP Content-Length header is set)
+     * Operation registered by Recv() / SendMsg() which must be submitted by the completion backend
+     */
+    enum Operation {
+      NONE, // No operation registered
+      RECV, // Data must be received
+      SEND, // Data must be sent
+    };
+
+    // Default constructor puts descriptor into invalid state (-1)
+    Socket() {}
+
+    Socket(FileDescriptor&& fd, bool completionMode=false)
+      : fd(std::move(fd)), completionMode(completionMode) {}
+
+    /**
+     * Returns filedescriptor
+     */
+    int getfd() const noexcept {
+      return fd.getfd();
+    }
+
+    /**
+     * Receive data from the socket (akin to recv())
      *
-     * Reads the data requested by the ReadRequest into the outBuffer
-     * and updates the bodySize of the Body accordingly
+     * Returns the number of bytes received, 0 if the peer closed the connection
+     * or -1 with errno set on failure (EAGAIN if no data is available)
+     */
+    ssize_t Recv(void *buf, size_t len, int flags=0) {
+      if (!completionMode) {
+        ssize_t n = recv(fd.getfd(), buf, len, flags);
+        // Peeked data remains on the socket and is counted once it is received
+        if (n > 0 && !(flags & MSG_PEEK)) receivedBytes += n;
+        else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) blockedEvents |= EPOLLIN;
+        return n;
+      }
+
+      string_view data = Delivered();
+      if (!data.empty()) {
+        size_t n = min(len, data.size());
+        // Without buffer the delivered data is skipped (see Discard())
+        if (buf) memcpy(buf, data.data(), n);
+        Consume(n);
+        return n;
+      }
+      if (deliveredError.has_value()) {
+        if (deliveredError.value()==0) return 0;
+        errno = deliveredError.value();
+        return -1;
+      }
+      requestedOperation = RECV;
+      errno = EAGAIN;
+      return -1;
+    }
+
+    /**
+     * Discard up to len bytes of received data without copying it (akin to recv() with MSG_TRUNC)
      *
-     * Data is read buffered, which means it reads the defined socketBufferSize
-     * into the readBuffer and then returns the requested amount of data.
+     * Sockets that do not support MSG_TRUNC (e.g. unix sockets) receive into a per-thread scratch buffer.
      *
-     * Returns true if the requested amount or the full body was read.
+     * Returns the number of bytes discarded, 0 if the connection was closed by the peer
+     * or -1 with errno set on failure (EAGAIN if the socket blocks)
+     */
+    ssize_t Discard(size_t len) {
+      if (completionMode) return Recv(nullptr, len);
+      if (truncSupported) {
+        ssize_t n = Recv(nullptr, len, MSG_TRUNC);
+        if (n >= 0 || errno != EFAULT) return n;
+        truncSupported = false;
+      }
+      len = min(len, discardBufferSize);
+      return Recv(ScratchBuffer(len), len);
+    }
+
+    /**
+     * Send scatter-gather data to the socket (akin to sendmsg())
      *
-     * Returns false if the requested amount was not read but the socket blocks
+     * In completion mode the iovec array and the referenced data must remain valid and unchanged
+     * until SendMsg() is called again with the same data, after the operation completed.
+     * Additional flags (e.g. MSG_MORE) are only applied in readiness mode.
      *
-     * Throws a runtime_error if the connection failed
-     */
-    bool processRequest() override {
-      // If no value is in queue return true to continue      
-      if (!request.has_value()) return true;
-      BodyReadRequest req = request.value();
-      
-      // Cap size to body size if size is larger then body
-      req.size = req.size>bodySize ? bodySize : req.size;
-      
-      while (1) {
-        // If bodySize is <= 0 an empty vector is returned
-        if (bodySize<=0) {
-          *req.outBuffer = {};
-          return true;
-        }
-        // Check if readBuffer contains enough data
-        if (readBuffer.size() >= req.size) {
-          // Set cursor to requested index + 1 (requested size)
-          readBuffer.set(req.size-1);
-          
-          // Copy the requested data (0-requested index) to outBuffer
-          *req.outBuffer = readBuffer.vecBeforeCursor();
-          // Erase the removed data from the buffer
-          readBuffer.eraseBeforeCursor();
-          // Decrement body size
-          bodySize -= req.size;
-          return true;
-        }
+     * Returns the number of bytes sent or -1 with errno set on failure (EAGAIN if the socket blocks)
+     */
+    ssize_t SendMsg(const struct iovec *iov, int iovcnt, int flags=0) {
+      sendMessage = {};
+      sendMessage.msg_iov = const_cast<struct iovec*>(iov);
+      sendMessage.msg_iovlen = iovcnt;
+      if (!completionMode) {
+        ssize_t n = sendmsg(fd.getfd(), &sendMessage, MSG_NOSIGNAL | flags);
+        if (n > 0) sentBytes += n;
+        else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) blockedEvents |= EPOLLOUT;
+        return n;
+      }
 
-        // Try to load the full socketBufferSize to the readBuffer
-        // This avoids underfetching (e.g. if read() is called frequently just for several bytes)
-        unsigned char buffer[socketBufferSize];
-        int n = recv(socket->getfd(), buffer, socketBufferSize, 0);
-        if (n < 1) {
-          if (errno == EAGAIN || errno == EWOULDBLOCK) {
-            // If the call block give the control to the event loop
-            // The event loop will then continue execution if data is available
-            return false;
-          } else {
-            // Throw exception. The eventloop will close and cleanup the tcp connection
-            throw runtime_error(strerror(errno));
-          }
+      if (completedSend.has_value()) {
+        ssize_t n = completedSend.value();
+        completedSend = nullopt;
+        if (n < 0) {
+          errno = -n;
+          return -1;
         }
-        // Insert received data to readBuffer
-        readBuffer.insert(buffer, buffer+n);
+        sentBytes += n;
+        return n;
       }
+      requestedOperation = SEND;
+      errno = EAGAIN;
+      return -1;
     }
 
     /**
-     * Drains the body by reading all remaining body data
-     *
-     * Returns overfetched data if the entire body has been read.
-     * By draining directly on fixedBody, it discards the data immediately without
-     * cycling it through a readBuffer.
-     * Therefore, this will always result in an empty buffer on success.
+     * Returns the number of bytes returned by Recv() since the socket was created
+     */
+    uint64_t ReceivedBytes() const noexcept {
+      return receivedBytes;
+    }
+
+    /**
+     * Returns the number of bytes sent by SendMsg() since the socket was created
+     */
+    uint64_t SentBytes() const noexcept {
+      return sentBytes;
+    }
+
+    /**
+     * Send a file range to the socket from the page cache (akin to sendfile())
      *
-     * Returns nullopt if more data is required and the socket blocks
+     * Only available in readiness mode, in completion mode it fails with EOPNOTSUPP.
      *
-     * Throws a runtime_error if the underlying connection fails
+     * Returns the number of bytes sent or -1 with errno set on failure (EAGAIN if the socket blocks)
      */
-    optional<helper::Buffer> drainBody() override {
-      while (1) {
-        // If body is fully read, return true to complete cleanup
-        if (bodySize<=0) {
-          // Return empty buffer as we directly read the data
-          return helper::Buffer();
-        }
-        // Read data into a pseudo buffer
-        // Unlike with chunkedBody, the data is not cycling over readBuffer
-        // This highly improves performance 
-        unsigned char buffer[bodySize];
-        int n = recv(socket->getfd(), buffer, bodySize, 0);
-        if (n == 0) {
-          // If connection was closed by peer, this is unexpected. The eventloop will clean it up
-          throw runtime_error("Connection closed unexpectedly");
-        }
-        if (n < 1) {
-          if (errno == EAGAIN || errno == EWOULDBLOCK) {
-            // If the call block give the control to the event loop
-            // The event loop will then continue execution if data is available
-            return nullopt;
-          } else {
-            // Throw exception. The eventloop will close and cleanup the tcp connection
-            throw runtime_error(strerror(errno));
-          }
-        }
-        // Decrement body size by the read bytes
-        bodySize -= n;
+    ssize_t SendFile(int fileFd, off_t offset, size_t count) {
+      if (completionMode) {
+        errno = EOPNOTSUPP;
+        return -1;
       }
+      ssize_t n = sendfile(fd.getfd(), fileFd, &offset, count);
+      if (n > 0) sentBytes += n;
+      // A truncated file cannot fill the announced length anymore
+      else if (n == 0) errno = EIO;
+      else if (errno == EAGAIN || errno == EWOULDBLOCK) blockedEvents |= EPOLLOUT;
+      return n == 0 ? -1 : n;
     }
-  };
 
-
-  /**
-   * Inherited object to read an HTTP body with a dynamic size
-   *
-   * Overrides functions to handle chunked HTTP bodys (Transfer-Encoding: chunked)
-   */
-  class ChunkedBodyImpl : public SimpleHTTP::internal::BodyImpl {
-  public:
-    ChunkedBodyImpl(
-      helper::FileDescriptor* socket,
-      int socketBufferSize,
-      helper::Buffer initBuffer
-      // Body size is set to INT_MAX in order that if readAll wants to read all
-      // that it reads until the body is fully read
-    ) : BodyImpl(socket, socketBufferSize, INT_MAX, initBuffer) {}
-    
     /**
-     * Reads the body with transfer encoding "chunked"
-     *
-     * Reads the data requested by the ReadRequest into the outBuffer
-     *
-     * Data is read buffered, which means it reads the defined socketBufferSize
-     * into the readBuffer and then returns the requested amount of data.
+     * Move received data from the socket into a pipe without copying it to user space (akin to splice())
      *
-     * Returns true if the requested amount or the full body was read.
-     *
-     * Returns false if the requested amount was not read but the socket blocks
+     * Only available in readiness mode, in completion mode it fails with EOPNOTSUPP.
      *
-     * Throws a runtime_error if the connection failed or if the transfer-encoding is invalid
+     * Returns the number of bytes moved, 0 if the connection was closed by the peer
+     * or -1 with errno set on failure (EAGAIN if the socket blocks)
      */
-    bool processRequest() override {
-      // If no value is in queue return true to continue      
-      if (!request.has_value()) return true;
-      BodyReadRequest req = request.value();
-
-      while (1) {
-        // Process data from buffer
-        while(1) {
-          if (nextChunkSize==0) break;
-          if (readChunkState) {
-            if (!processChunkData()) {
-              break;
-            }
-          } else {
-            if (!processChunkSize()) {
-              break;
-            }
-          }
-        }
-        
-        // Check if rawReadBuffer contains enough data or if the full body was read
-        if (rawReadBuffer.size() >= req.size || nextChunkSize==0) {
-          // Cap req size to rawReadBuffer size if the full body is read (nextChunkSize==0)
-          req.size = req.size > rawReadBuffer.size() ? rawReadBuffer.size() : req.size;
-          // Set cursor to requested index (requested size - 1)
-          rawReadBuffer.set(req.size-1);
-          // Copy the requested data (0-requested index) to outBuffer
-          *req.outBuffer = rawReadBuffer.vecBeforeCursor();
-          // Erase the removed data from the buffer
-          rawReadBuffer.eraseBeforeCursor();
-          return true;
-        }
-
-        // Try to load the full socketBufferSize to the readBuffer
-        // This avoids underfetching (e.g. if read() is called frequently just for several bytes)
-        unsigned char buffer[socketBufferSize];
-        int n = recv(socket->getfd(), buffer, socketBufferSize, 0);
-        if (n == 0)
-          // If connection was closed by peer, this is unexpected. The eventloop will clean it up
-          throw runtime_error("Connection closed unexpectedly");
-        if (n < 1) {
-          if (errno == EAGAIN || errno == EWOULDBLOCK) {
-            // If the call block give the control to the event loop
-            // The event loop will then continue execution if data is available
-            return false;
-          } else {
-            // Throw exception. The eventloop will close and cleanup the tcp connection
-            throw runtime_error(strerror(errno));
-          }
-        }
-
-        // Insert received data to readBuffer
-        readBuffer.insert(buffer, buffer + n);
-      }      
+    ssize_t Splice(int pipeFd, size_t len) {
+      if (completionMode) {
+        errno = EOPNOTSUPP;
+        return -1;
+      }
+      ssize_t n = splice(fd.getfd(), nullptr, pipeFd, nullptr, len, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+      if (n > 0) receivedBytes += n;
+      else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) blockedEvents |= EPOLLIN;
+      return n;
     }
 
     /**
-     * Drains the body by reading all remaining body data
-     *
-     * Returns overfetched data if the entire body has been read.
-     * This is necessary because to efficiently drain the body, data is overfetched from recv().
-     * Thus, the data fetched that does not belong to the body is returned.
-     *
-     * The readBuffer is explicitly moved to omit a buffercopy, this means using the Body afterwards leads
-     * to undefined behavior!
-     *
-     * Returns nullopt if more data is required and the socket blocks
-     *
-     * Throws a runtime_error if the underlying connection fails
+     * Returns the directions (EPOLLIN / EPOLLOUT) in which Recv() / SendMsg() blocked since the last call
      */
-    optional<helper::Buffer> drainBody() override {
-      while (1) {
-        // Process data from buffer
-        while(1) {
-          if (readChunkState) {
-            if (!skipChunkData()) {
-              break;
-            }
-          } else {
-            if (!processChunkSize()) {
-              break;
-            }
-          }
-        }
-        // Check if readBuffer contains enough data or if the full body was read
-        if (nextChunkSize==0) {
-          return std::move(readBuffer);
-        }
-
-        // Try to load the full socketBufferSize to the readBuffer
-        unsigned char buffer[socketBufferSize];
-        int n = recv(socket->getfd(), buffer, socketBufferSize, 0);
-        if (n == 0)
-          // If connection was closed by peer, this is unexpected. The eventloop will clean it up
-          throw runtime_error("Connection closed unexpectedly");
-        if (n < 1) {
-          if (errno == EAGAIN || errno == EWOULDBLOCK) {
-            // If the call block give the control to the event loop
-            // The event loop will then continue execution if data is available
-            return nullopt;
-          } else {
-            // Throw exception. The eventloop will close and cleanup the tcp connection
-            throw runtime_error(strerror(errno));
-          }
-        }
-
-        // Insert received data to readBuffer
-        readBuffer.insert(buffer, buffer + n);
-      }
+    uint32_t TakeBlockedEvents() noexcept {
+      return exchange(blockedEvents, 0);
     }
 
-  private:
-    // Buffer holding the decoded data
-    helper::Buffer rawReadBuffer;
-    // Identifier buffer for the parser
-    string identifier;
-    // Character buffer for the parser
-    optional<char> c;
-    // Determines if currently chunk data is read or if the size is read
-    bool readChunkState = false;
-    // Determines the size of the next chunk (-1 = uninitialized, 0 = full body is read, other = size to read)
-    int nextChunkSize = -1;
-    // Defines the maximum length of the hexadecimal chunkSize number
-    // If the chunkSize number is larger the encoding is considered invalid
-    const int maxChunkSizeLength = 5;
-    
     /**
-     * Reads and parses the chunk size for the next chunk
-     *
-     * Returns true if the chunkSize was correctly read into nextChunkSize
-     *
-     * Returns false if more data needs to be in the readBuffer
-     *
-     * Throws an exception if the input is invalid encoded
+     * Returns whether the socket is driven by a completion backend
      */
-    bool processChunkSize() {
-      identifier="";
-      // Read size for next chunk
-      // There is a max size for the chunk to prevent invalid or malicious
-      // encoding to starve the performance of the server
-      for (int i=0;i<maxChunkSizeLength;i++) {
-        if (!(c = readBuffer.next()).has_value()) {
-          // Rollback buffer as not enough data is provided to parse the type
-          readBuffer.rollback();
-          return false;
-        }
-        // Skip carriage return as termination is based on newline
-        if (c.value()=='\r') continue;
-        // If newline is read, this indicates the end of the size
-        if (c.value()=='\n') {
-          // Convert identifier into string with stoi on base 16 (hex)
-          // If the identifier cannot be converted stoi throws an error
-          // this error will be thrown to the caller of processRequest()
-          // which is fine because if the size is Not convertable, it is considered invalid encoding
-          nextChunkSize = stoi(identifier, nullptr, 16);
-          readChunkState = true;
-          readBuffer.commit();
-          // If nextchunk is 0, it can immediately break out of the loop
-          if (nextChunkSize==0) return false;
-          
-          return true;
-        }
-        identifier+=c.value();
-      }
-      return true;
+    bool isCompletionMode() const noexcept {
+      return completionMode;
     }
-    
+
     /**
-     * Reads and parses the chunk data
-     *
-     * Returns true if the chunk data was correctly processed into the rawReadBuffer
-     *
-     * Returns false if more data needs to be in the readBuffer
-     *
-     * Throws an exception if the input is invalid encoded
+     * Returns the operation registered by the state machine, that was not submitted yet
      */
-    bool processChunkData() {
-      // Check if the readBuffer has enough data for nextChunkSize + CRLF + Current buffered char
-      if (nextChunkSize+2+1>readBuffer.sizeAfterCursor()) {
-        return false;
-      }
-
-      // Eat current char (most likely '\n')
-      // As cstrAfterCursor includes the current headCursor, we need to eat the first char
-      // of the actual data into the buffers headCursor
-      readBuffer.next(); // No need for bound check as it is already checked above
-
-      // Copy data from readBuffer directly to rawReadBuffer
-      rawReadBuffer.insert(
-        readBuffer.cstrAfterCursor(),
-        readBuffer.cstrAfterCursor()+nextChunkSize
-      );
-
-      // Update readBuffer cursor (-1 because below the current char is eaten by next())
-      readBuffer.increment(nextChunkSize-1);
-
-      // Expect CRLF ('\r' & '\n') after chunk (defined in RFC 7230)
-      identifier = "";
-      // Read '\r'
-      identifier += readBuffer.next().value();
-      // Read '\n'
-      identifier += readBuffer.next().value();
-
-      // Check if CRLF is present
-      if (identifier!="\r\n") {
-        throw runtime_error("Expected CRLF after chunk");
-      }
+    Operation RequestedOperation() const noexcept {
+      return inFlight ? NONE : requestedOperation;
+    }
 
-      // Erase chunk + chunkSize before cursor
-      readBuffer.eraseBeforeCursor();
+    /**
+     * Returns the message of the registered send operation
+     */
+    const struct msghdr* SendRequest() const noexcept {
+      return &sendMessage;
+    }
 
-      readChunkState = false;
+    /**
+     * Marks the registered operation as submitted to the completion backend
+     */
+    void Submitted() {
+      inFlight = true;
+    }
 
-      return true;
+    /**
+     * Returns whether an operation is submitted and not completed yet
+     */
+    bool InFlight() const noexcept {
+      return inFlight;
     }
 
     /**
-     * Parses and skips a chunk block of data
-     * (akin to processChunkData, but the data is discarded instead of written to rawReadBuffer)
-     *
-     * Returns true if the chunk data was correctly processed and skipped
-     *
-     * Returns false if more data needs to be in the readBuffer
+     * Completes the receive operation with the data received into the provided buffer
      *
-     * Throws an exception if the input is invalid encoded
+     * The data is referenced in place, the buffer is held until it is released (see ReleaseBuffer()).
      */
-    bool skipChunkData() {
-      // Check if the readBuffer has enough data for nextChunkSize + CRLF + current buffered char
-      if (nextChunkSize+2+1>readBuffer.sizeAfterCursor()) {
-        return false;
-      }
-      // Update readBuffer cursor (including current buffered char (most likely '\n'))
-      readBuffer.increment(nextChunkSize);
-
-      // Expect CRLF ('\r' & '\n') after chunk (defined in RFC 7230)
-      identifier = "";
-      // Read '\r'
-      identifier += readBuffer.next().value();
-      // Read '\n'
-      identifier += readBuffer.next().value();
-
-
-      // Check if CRLF is present
-      if (identifier!="\r\n") {
-        throw runtime_error("Expected CRLF after chunk");
-      }
-
-      // Erase chunk + chunkSize before cursor
-      readBuffer.eraseBeforeCursor();
-
-      readChunkState = false;
-      
-      return true;
+    void DeliverRecv(const char *data, size_t len, uint16_t bufferId) {
+      delivered = string_view(data, len);
+      deliveredBuffer = bufferId;
+      CompleteOperation();
     }
-  };
-} // namespace SimpleHTTP
 
-
-
-namespace SimpleHTTP::internal {
-    
-  /**
-   * Abstract internal response interface defining members used to inspect the Response object
-   *
-   * Not visible to the end user
-   */
-  class ResponseInternal {
-  public:
-    virtual ~ResponseInternal() {}
+    /**
+     * Completes the receive operation with an error (0 indicates that the peer closed the connection)
+     */
+    void DeliverRecvError(int err) {
+      deliveredError = err;
+      CompleteOperation();
+    }
 
     /**
-     * Get HTTP version (e.g. HTTP/1.1)
+     * Completes the receive operation without any data (e.g. if no receive buffer was available)
      */
-    virtual string getVersion() const noexcept = 0;
+    void DeliverRecvNothing() {
+      CompleteOperation();
+    }
 
     /**
-     * Get HTTP status code (e.g. 200)
+     * Completes the send operation with its result (negative errno on failure)
      */
-    virtual uint getStatusCode() const noexcept = 0;
+    void DeliverSend(ssize_t res) {
+      completedSend = res;
+      CompleteOperation();
+    }
 
     /**
-     * Get HTTP status reason (e.g. OK)
+     * Returns whether delivered data (or a delivered error) is waiting to be consumed by Recv()
      */
-    virtual string getStatusReason() const noexcept = 0;
+    bool HasDelivered() const noexcept {
+      return !Delivered().empty() || deliveredError.has_value();
+    }
 
     /**
-     * Get Content-Type header
+     * Returns the delivered data that was not consumed yet (completion mode only)
      *
-     * If no valid content-type is set, nullopt is returned
+     * The view is invalidated by Consume(), Recv() and ReleaseBuffer()
      */
-    virtual optional<string> getContentType() = 0;
+    string_view Delivered() const noexcept {
+      if (deliveredBuffer.has_value()) return delivered;
+      return string_view(spilled).substr(spilledOffset);
+    }
 
     /**
-     * Get Date header as time_point from response
-     *
-     * If no valid date is set, nullopt is returned
+     * Consumes n bytes of the delivered data (akin to Recv() without copying the data)
      */
-    virtual optional<chrono::system_clock::time_point> getDate() = 0;
+    void Consume(size_t n) noexcept {
+      if (deliveredBuffer.has_value()) {
+        delivered.remove_prefix(n);
+      } else if ((spilledOffset += n) == spilled.size()) {
+        spilled.clear();
+        spilledOffset = 0;
+      }
+      receivedBytes += n;
+    }
 
     /**
-     * Get header from the response
+     * Releases the provided buffer of the delivered data, so that it can be handed back to the backend
+     *
+     * Data that was not consumed yet is copied out of the buffer, or dropped if discard is set.
+     *
+     * Returns the id of the released buffer or nullopt if no buffer is held
      */
-    virtual unordered_map<string, string>& getHeaders() = 0;
+    optional<uint16_t> ReleaseBuffer(bool discard=false) {
+      if (!deliveredBuffer.has_value()) return nullopt;
+      if (!discard && !delivered.empty()) {
+        spilled.append(delivered);
+      }
+      delivered = {};
+      return exchange(deliveredBuffer, nullopt);
+    }
 
     /**
-     * Get header to the response
+     * Marks the socket as closing
      *
-     * If header is not present, nullopt is returned
+     * The socket is shut down, which forces in flight operations to complete.
+     * The owner is expected to release the socket once the operation completed.
      */
-    virtual optional<string> getHeader(string key) = 0;
+    void Shutdown() {
+      closing = true;
+      shutdown(fd.getfd(), SHUT_RDWR);
+    }
 
     /**
-     * Get body from the response
+     * Returns whether the socket is closing
      */
-    virtual string getBody() = 0;
+    bool isClosing() const noexcept {
+      return closing;
+    }
+
+  private:
+    // Underlying filedescriptor
+    FileDescriptor fd;
+    // Determines if the socket is driven by a completion backend
+    bool completionMode = false;
+    // Determines if the socket is closing
+    bool closing = false;
+    // Operation registered by the state machine
+    Operation requestedOperation = NONE;
+    // Determines if the registered operation is in flight
+    bool inFlight = false;
+    // Data delivered by the completed receive operation, referenced in its provided buffer
+    string_view delivered;
+    // Id of the provided buffer holding the delivered data (nullopt if no buffer is held)
+    optional<uint16_t> deliveredBuffer;
+    // Delivered data copied out of its released buffer (see ReleaseBuffer())
+    string spilled;
+    // Offset of the spilled data already consumed
+    size_t spilledOffset = 0;
+    // Error delivered by a completed receive operation (0 indicates that the peer closed the connection)
+    optional<int> deliveredError;
+    // Message of the registered send operation
+    struct msghdr sendMessage = {};
+    // Result of the completed send operation
+    optional<ssize_t> completedSend;
+    // Bytes received / sent on the socket
+    uint64_t receivedBytes = 0;
+    uint64_t sentBytes = 0;
+    // Directions in which the socket blocked (readiness mode only)
+    uint32_t blockedEvents = 0;
+    // Whether recv() supports discarding data with MSG_TRUNC (only tcp sockets do)
+    bool truncSupported = true;
+    // Maximum size discarded at once if MSG_TRUNC is not supported
+    static constexpr size_t discardBufferSize = 65536;
+
+    /**
+     * Resets the registered operation
+     */
+    void CompleteOperation() {
+      inFlight = false;
+      requestedOperation = NONE;
+    }
   };
-} // namespace SimpleHTTP::internal
 
 
+  /**
+   * Sends the front of the queue with a single call
+   *
+   * Data segments are sent with SendMsg() (with MSG_MORE if a file follows, so that the head is coalesced
+   * with the file data), file segments with SendFile(). In completion mode the front file segment is
+   * loaded in pieces of the given size and sent as data.
+   *
+   * Sent data is not consumed from the queue.
+   *
+   * Returns the number of bytes sent or -1 with errno set on failure (EAGAIN if the socket blocks)
+   */
+  inline ssize_t SendQueued(Socket &socket, SendQueue &queue, size_t loadSize) {
+    if (socket.isCompletionMode()) {
+      if (!queue.loadFile(loadSize)) return -1;
+    } else if (auto range = queue.file()) {
+      return socket.SendFile(range->file->fd.getfd(), range->offset, range->length);
+    }
+    auto [iov, iovcnt] = queue.iov();
+    return socket.SendMsg(iov, iovcnt, queue.fileFollows() ? MSG_MORE : 0);
+  }
 
-namespace SimpleHTTP {
 
   /**
-   * Abstract external response interface defining members used to manipulate the Response object
+   * RAII compatible wrapper around a raw io_uring instance
+   *
+   * Provides the minimal set of operations used by the io_uring event loop:
+   * - obtaining submission queue entries, which are submitted in one batch with Enter()
+   * - consuming completion queue entries
+   * - managing a provided buffer ring, from which the kernel selects receive buffers
+   *
+   * Not thread-safe, every event loop uses its own instance.
    */
-  class Response {
+  class Uring {
   public:
     /**
-     * Set HTTP status code (e.g. 200)
-     */
-    virtual Response& setStatusCode(uint newstatuscode) = 0;
-    
-    /**
-     * Set HTTP status reason (e.g. OK)
-     */
-    virtual Response& setStatusReason(string newstatusreason) = 0;
-
-    /**
-     * Set Content-Type header
+     * Creates io_uring instance
+     *
+     * entries defines the submission queue size, bufferCount (power of 2) and bufferSize
+     * define the provided receive buffers.
+     *
+     * Throws a runtime_error if the instance cannot be created
      */
-    virtual Response& setContentType(string newcontenttype) = 0;
+    Uring(unsigned entries, unsigned bufferCount, unsigned bufferSize)
+      : bufferCount(bufferCount), bufferSize(bufferSize) {
+      // The provided buffer ring requires a power of 2 entry count
+      if (bufferCount == 0 || bufferCount > 32768 || (bufferCount & (bufferCount - 1))) {
+        throw runtime_error("Buffer count must be a power of 2 (max 32768)");
+      }
+      struct io_uring_params params;
+      memset(&params, 0, sizeof(params));
+      ringFd = FileDescriptor(syscall(__NR_io_uring_setup, entries, &params));
+      if (ringFd.getfd() < 0) {
+        throw runtime_error(strerror(errno));
+      }
+      // Extended arguments are required for waiting with a timeout
+      if (!(params.features & IORING_FEAT_EXT_ARG)) {
+        throw runtime_error("Kernel does not support io_uring extended arguments");
+      }
 
-    /**
-     * Set Date header to the response
+      // Map submission and completion queue rings
+      sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+      cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+      bool singleMmap = params.features & IORING_FEAT_SINGLE_MMAP;
+      if (singleMmap) {
+        sqRingSize = cqRingSize = max(sqRingSize, cqRingSize);
+      }
+      sqRing = mmap(
+        nullptr, sqRingSize, PROT_READ | PROT_WRITE,
+        MAP_SHARED | MAP_POPULATE, ringFd.getfd(), IORING_OFF_SQ_RING
+      );
+      if (sqRing == MAP_FAILED) {
+        sqRing = nullptr;
+        throw runtime_error(strerror(errno));
+      }
+      if (singleMmap) {
+        cqRing = sqRing;
+      } else {
+        cqRing = mmap(
+          nullptr, cqRingSize, PROT_READ | PROT_WRITE,
+          MAP_SHARED | MAP_POPULATE, ringFd.getfd(), IORING_OFF_CQ_RING
+        );
+        if (cqRing == MAP_FAILED) {
+          cqRing = nullptr;
+          throw runtime_error(strerror(errno));
+        }
+      }
+      sqesSize = params.sq_entries * sizeof(struct io_uring_sqe);
+      sqes = (struct io_uring_sqe *)mmap(
+        nullptr, sqesSize, PROT_READ | PROT_WRITE,
+        MAP_SHARED | MAP_POPULATE, ringFd.getfd(), IORING_OFF_SQES
+      );
+      if (sqes == MAP_FAILED) {
+        sqes = nullptr;
+        throw runtime_error(strerror(errno));
+      }
+
+      char *sq = (char *)sqRing;
+      sqHead = (unsigned *)(sq + params.sq_off.head);
+      sqTail = (unsigned *)(sq + params.sq_off.tail);
+      sqMask = *(unsigned *)(sq + params.sq_off.ring_mask);
+      sqEntries = *(unsigned *)(sq + params.sq_off.ring_entries);
+      sqArray = (unsigned *)(sq + params.sq_off.array);
+      sqeTail = *sqTail;
+      char *cq = (char *)cqRing;
+      cqHead = (unsigned *)(cq + params.cq_off.head);
+      cqTail = (unsigned *)(cq + params.cq_off.tail);
+      cqMask = *(unsigned *)(cq + params.cq_off.ring_mask);
+      cqes = (struct io_uring_cqe *)(cq + params.cq_off.cqes);
+
+      // Create provided buffer ring
+      bufRingSize = bufferCount * sizeof(struct io_uring_buf);
+      bufRing = (struct io_uring_buf_ring *)mmap(
+        nullptr, bufRingSize, PROT_READ | PROT_WRITE,
+        MAP_ANONYMOUS | MAP_PRIVATE, -1, 0
+      );
+      if (bufRing == MAP_FAILED) {
+        bufRing = nullptr;
+        throw runtime_error(strerror(errno));
+      }
+      struct io_uring_buf_reg bufReg;
+      memset(&bufReg, 0, sizeof(bufReg));
+      bufReg.ring_addr = (uint64_t)bufRing;
+      bufReg.ring_entries = bufferCount;
+      bufReg.bgid = bufferGroup;
+      int res = syscall(__NR_io_uring_register, ringFd.getfd(), IORING_REGISTER_PBUF_RING, &bufReg, 1);
+      if (res < 0) {
+        throw runtime_error(strerror(errno));
+      }
+      // Provide all buffers to the kernel
+      bufferMemory.resize(size_t(bufferCount) * bufferSize);
+      for (unsigned i = 0; i < bufferCount; i++) {
+        ProvideBuffer(i);
+      }
+    }
+
+    Uring(const Uring&) = delete;
+    Uring& operator=(const Uring&) = delete;
+
+    ~Uring() {
+      // The kernel references the rings, buffers and operation data until the operations completed
+      if (sqes) CancelAll();
+      ringFd.closefd();
+      if (bufRing) munmap(bufRing, bufRingSize);
+      if (sqes) munmap(sqes, sqesSize);
+      if (cqRing && cqRing != sqRing) munmap(cqRing, cqRingSize);
+      if (sqRing) munmap(sqRing, sqRingSize);
+    }
+
+    /**
+     * Obtain a zeroed submission queue entry
+     *
+     * If the submission queue is full, the queued entries are submitted first
+     *
+     * Throws a runtime_error if the queued entries cannot be submitted
+     */
+    struct io_uring_sqe* GetSqe() {
+      if (sqeTail - __atomic_load_n(sqHead, __ATOMIC_ACQUIRE) >= sqEntries) {
+        if (Enter(0, -1) < 0) {
+          throw runtime_error(strerror(errno));
+        }
+      }
+      struct io_uring_sqe *sqe = &sqes[sqeTail & sqMask];
+      sqArray[sqeTail & sqMask] = sqeTail & sqMask;
+      sqeTail++;
+      memset(sqe, 0, sizeof(*sqe));
+      return sqe;
+    }
+
+    /**
+     * Submit all queued entries and wait for minComplete completions
+     *
+     * timeout defines the maximum time to wait in milliseconds (-1 waits indefinitely)
+     *
+     * Returns the number of submitted entries or -1 with errno set (ETIME if the timeout was reached)
+     */
+    int Enter(unsigned minComplete, int timeout) {
+      // Publish queued entries to the kernel
+      __atomic_store_n(sqTail, sqeTail, __ATOMIC_RELEASE);
+      unsigned toSubmit = sqeTail - sqeSubmitted;
+
+      struct __kernel_timespec ts;
+      ts.tv_sec = timeout / 1000;
+      ts.tv_nsec = (timeout % 1000) * 1000000;
+      struct io_uring_getevents_arg arg;
+      memset(&arg, 0, sizeof(arg));
+      arg.ts = timeout < 0 ? 0 : (uint64_t)&ts;
+
+      unsigned flags = IORING_ENTER_EXT_ARG;
+      if (minComplete > 0) flags |= IORING_ENTER_GETEVENTS;
+
+      int res = syscall(
+        __NR_io_uring_enter, ringFd.getfd(), toSubmit, minComplete, flags, &arg, sizeof(arg)
+      );
+      if (res > 0) {
+        sqeSubmitted += res;
+        inFlight += res;
+      }
+      return res;
+    }
+
+    /**
+     * Consume all available completion queue entries
+     *
+     * handle() is called for every completion
+     */
+    template <typename F>
+    void ForEachCompletion(F&& handle) {
+      unsigned head = *cqHead;
+      unsigned tail = __atomic_load_n(cqTail, __ATOMIC_ACQUIRE);
+      while (head != tail) {
+        struct io_uring_cqe cqe = cqes[head & cqMask];
+        head++;
+        // Release the entry before handling it, handle() may throw
+        __atomic_store_n(cqHead, head, __ATOMIC_RELEASE);
+        // Multishot operations remain in flight until their final completion
+        if (!(cqe.flags & IORING_CQE_F_MORE)) inFlight--;
+        handle(cqe);
+      }
+    }
+
+    /**
+     * Returns the buffer group id of the provided buffer ring
+     */
+    uint16_t getBufferGroup() const noexcept {
+      return bufferGroup;
+    }
+
+    /**
+     * Returns the size of a provided buffer
+     */
+    unsigned getBufferSize() const noexcept {
+      return bufferSize;
+    }
+
+    /**
+     * Returns the memory of the provided buffer
+     */
+    const char* BufferData(uint16_t bufferId) const noexcept {
+      return &bufferMemory[size_t(bufferId) * bufferSize];
+    }
+
+    /**
+     * Hands the provided buffer (back) to the kernel
+     */
+    void ProvideBuffer(uint16_t bufferId) {
+      // Entries are addressed manually, as bufs[] is misaligned when the uapi header is compiled as C++
+      struct io_uring_buf *buf = (struct io_uring_buf *)bufRing + (bufTail & (bufferCount - 1));
+      buf->addr = (uint64_t)&bufferMemory[size_t(bufferId) * bufferSize];
+      buf->len = bufferSize;
+      buf->bid = bufferId;
+      bufTail++;
+      __atomic_store_n(&bufRing->tail, bufTail, __ATOMIC_RELEASE);
+    }
+
+  private:
+    /**
+     * Cancels all operations and waits until they completed
+     *
+     * Closing the ring does not wait for the cancelation, afterwards the kernel could still
+     * write to the provided buffers or read the messages of send operations.
+     */
+    void CancelAll() noexcept {
+      // Entries queued before are submitted with the cancelation (and canceled as well)
+      struct io_uring_sqe *sqe;
+      try {
+        sqe = GetSqe();
+      } catch (exception &_) {
+        return;
+      }
+      sqe->opcode = IORING_OP_ASYNC_CANCEL;
+      sqe->cancel_flags = IORING_ASYNC_CANCEL_ANY;
+      sqe->user_data = UINT64_MAX;
+      while (inFlight > 0) {
+        // Operations complete immediately once canceled, the wait is only bounded in case the kernel fails
+        if (Enter(1, cancelTimeout) < 0 && errno != EINTR) return;
+        ForEachCompletion([](const struct io_uring_cqe&) {});
+      }
+    }
+
+    // Maximum time in milliseconds waited for a completion while canceling (see CancelAll())
+    static constexpr int cancelTimeout = 1000;
+
+    // Filedescriptor of the io_uring instance
+    FileDescriptor ringFd;
+
+    // Mapped submission queue ring
+    void *sqRing = nullptr;
+    size_t sqRingSize = 0;
+    unsigned *sqHead = nullptr;
+    unsigned *sqTail = nullptr;
+    unsigned *sqArray = nullptr;
+    unsigned sqMask = 0;
+    unsigned sqEntries = 0;
+    // Mapped submission queue entries
+    struct io_uring_sqe *sqes = nullptr;
+    size_t sqesSize = 0;
+    // Tail of the queued (local) submission queue entries
+    unsigned sqeTail = 0;
+    // Number of entries submitted to the kernel
+    unsigned sqeSubmitted = 0;
+    // Number of submitted operations that did not complete yet
+    uint64_t inFlight = 0;
+
+    // Mapped completion queue ring
+    void *cqRing = nullptr;
+    size_t cqRingSize = 0;
+    unsigned *cqHead = nullptr;
+    unsigned *cqTail = nullptr;
+    unsigned cqMask = 0;
+    struct io_uring_cqe *cqes = nullptr;
+
+    // Provided buffer ring
+    struct io_uring_buf_ring *bufRing = nullptr;
+    size_t bufRingSize = 0;
+    uint16_t bufTail = 0;
+    static constexpr uint16_t bufferGroup = 0;
+    unsigned bufferCount;
+    unsigned bufferSize;
+    // Memory of the provided buffers
+    vector<char> bufferMemory;
+  };
+} // namespace SimpleHTTP::internal::helper
+
+
+namespace SimpleHTTP::internal {
+
+  /**
+   * Promise state shared by all Task types
+   *
+   * Tasks awaiting other tasks form a chain, whose root is the task resumed by its owner (e.g. the server).
+   * The root tracks the innermost suspended task of the chain (leaf), which is resumed instead of the root.
+   */
+  struct TaskPromiseBase {
+    // Exception ptr
+    exception_ptr exception = nullptr;
+    // Coroutine resumed once the task completed (only set if the task is awaited)
+    coroutine_handle<> continuation = nullptr;
+    // Promise of the root task of the chain
+    TaskPromiseBase* root = this;
+    // Innermost suspended task of the chain (only maintained on the root, nullptr if it is the root itself)
+    coroutine_handle<> leaf = nullptr;
+
+    // Predefined function called when coroutine is initialized
+    // Coroutine is immediately suspended when created
+    suspend_always initial_suspend() noexcept { return {}; }
+    // Predefined function called when exception is thrown
+    void unhandled_exception() { exception = current_exception(); } // Store exception to handle it later
+
+    // Coroutine frames are allocated on the current arena (if set, see internal::helper::Arena::Scope)
+    // The arena is stored in front of the frame, so that the deallocation knows its origin
+    static void* operator new(size_t size) {
+      auto *arena = helper::Arena::current;
+      void *mem = arena ? arena->Allocate(size+frameHeaderSize) : ::operator new(size+frameHeaderSize);
+      *static_cast<helper::Arena**>(mem) = arena;
+      return static_cast<char*>(mem)+frameHeaderSize;
+    }
+    static void operator delete(void *ptr, size_t size) {
+      void *mem = static_cast<char*>(ptr)-frameHeaderSize;
+      // Memory of the arena is released when it is reset, heap frames are released with their allocated size
+      if (!*static_cast<helper::Arena**>(mem)) ::operator delete(mem, size+frameHeaderSize);
+    }
+    // Size of the header in front of the frame (keeps the frame aligned)
+    static constexpr size_t frameHeaderSize = alignof(max_align_t);
+
+    /**
+     * Awaiter of the final suspension
+     *
+     * The finished coroutine remains suspended, so that the return value / exception can be obtained
+     * from the frame. If the task is awaited, the awaiting coroutine is resumed with symmetric transfer,
+     * which does not nest it on the stack of the finished coroutine.
+     */
+    struct FinalAwaiter {
+      bool await_ready() noexcept { return false; }
+      template <typename P>
+      coroutine_handle<> await_suspend(coroutine_handle<P> finished) noexcept {
+        auto &promise = finished.promise();
+        if (!promise.continuation) return noop_coroutine();
+        promise.root->leaf = promise.continuation;
+        return promise.continuation;
+      }
+      void await_resume() noexcept {}
+    };
+  };
+
+  /**
+   * Return value storage of a Task promise
+   */
+  template <typename T>
+  struct TaskResult {
+    // Generic return value (empty until the coroutine returned)
+    optional<T> value = nullopt;
+    // Predefined function called when returning the value (co_return)
+    // Store return value in promise frame before handle is destroyed (constructed in place, without copy)
+    template <typename U = T>
+    void return_value(U&& v) { value.emplace(std::forward<U>(v)); }
+  };
+
+  /**
+   * Return value storage of a Task<void> promise
+   */
+  template <>
+  struct TaskResult<void> {
+    // Predefined function called when returning without value (co_return;)
+    void return_void() noexcept {}
+  };
+} // namespace SimpleHTTP::internal
+
+
+namespace SimpleHTTP {
+  
+  /**
+   * Generic handle wrapper for coroutine
+   *
+   * Used as return type from coroutines
+   *
+   * Ensures the underlying coroutine_handle is only attached to one Task
+   *
+   * Tasks can be awaited inside of other tasks (co_await task), the awaiting task is suspended
+   * until the awaited task returned. Control is transferred symmetrically between the tasks,
+   * therefore deeply nested or recursive tasks do not grow the stack
+   * (requires the tail calls emitted by optimized builds, e.g. -O2 on gcc).
+   */ 
+  template <typename T>
+  class Task {
+  public:
+    // Define promise type (predefined coroutine struct)
+    struct promise_type : internal::TaskPromiseBase, internal::TaskResult<T> {
+      // Predefined coroutine function called when creating the coroutine
+      Task get_return_object() {
+        return Task{coroutine_handle<promise_type>::from_promise(*this)};
+      }
+      // Predefined function called before coroutine is destroyed (value is returned)
+      // Suspend finished coroutine, to obtain things like return value / exception from the frame
+      // Without suspending the operation after completion, the resources may be cleaned up before reading
+      FinalAwaiter final_suspend() noexcept { return {}; }
+    };
+
+    /**
+     * Awaiter used if the task is awaited inside of another coroutine
+     */
+    struct Awaiter {
+      // Awaited coroutine
+      coroutine_handle<promise_type> coro;
+
+      bool await_ready() noexcept {
+        return !coro || coro.done();
+      }
+
+      template <typename P>
+      coroutine_handle<> await_suspend(coroutine_handle<P> awaiting) noexcept {
+        auto &promise = coro.promise();
+        promise.continuation = awaiting;
+        // If awaited by a task, the awaited task becomes the leaf of its chain
+        if constexpr (is_base_of_v<internal::TaskPromiseBase, P>) {
+          promise.root = awaiting.promise().root;
+          promise.root->leaf = coro;
+        }
+        // Start the awaited task with symmetric transfer
+        return coro;
+      }
+
+      T await_resume() {
+        if (!coro) throw logic_error("Attempt to await an empty task");
+        if (coro.promise().exception) rethrow_exception(coro.promise().exception);
+        if constexpr (!is_void_v<T>) return std::move(coro.promise().value.value());
+      }
+    };
+
+    // Default constructor sets coroutine to nullptr
+    Task() : coro(nullptr) {}
+    // Constructor to initialize handle
+    Task(coroutine_handle<promise_type> h) : coro(h) {}
+    // Destructor to cleanup handle
+    ~Task() { if (coro) coro.destroy(); }
+
+    // Delete copy constructor
+    Task(const Task&) = delete;
+
+    // Move constructor explicitly sets the other coroutine to nullptr
+    // To prevent double destruction
+    Task(Task&& other) noexcept : coro(other.coro) {
+      other.coro = nullptr;
+    }
+      
+    // Delete copy assignment
+    Task& operator=(const Task&) = delete;
+
+    // Move assignment explicitly sets the other coroutine to nullptr
+    // and destroys the local coroutine to prevent double destruction
+    Task& operator=(Task&& other) noexcept {
+      if (&other!=this) {
+        if (coro) coro.destroy();
+        coro = other.coro;
+        other.coro = nullptr;
+      }
+      return *this;
+    }
+
+    /**
+     * Awaits the task inside of another coroutine
+     *
+     * The task is started once awaited, co_await returns its return value
+     * (or rethrows the exception it completed with).
+     */
+    Awaiter operator co_await() noexcept {
+      return Awaiter{coro};
+    }
+
+    /**
+     * Checks if coroutine is done/destroyed
+     */
+    bool done() {
+      return !coro || coro.done();
+    }
+
+    /**
+     * Resumes execution of the coroutine
+     *
+     * If the coroutine awaits another task, the innermost suspended task is resumed.
+     *
+     * If the coroutine is suspended, it will return nullopt
+     * otherwise the return value is returned (true for Task<void>)
+     *
+     * Throws a logic_error if coroutine is accessed after its completed
+     * Rethrows exception if the coroutine completed with an uncaught exception
+     */
+    auto resume() {
+      if (!coro || coro.done()) {
+        // Resuming coroutine which is done() is undefined
+        throw logic_error("Attempt to resume a completed coroutine");
+      }
+      // Resume innermost suspended coroutine of the chain
+      auto &promise = coro.promise();
+      if (promise.leaf) promise.leaf.resume(); else coro.resume();
+
+      using Result = conditional_t<is_void_v<T>, bool, T>;
+      if (coro.done()) {
+        // If coroutine returned, handle return / exception
+
+        // Rethrow exception on exception
+        if (promise.exception) {
+          rethrow_exception(promise.exception);
+        }
+        // Return value
+        if constexpr (is_void_v<T>) return optional<Result>(true);
+        else return optional<Result>(std::move(promise.value));
+      } else {
+        // Else return nullopt
+        return optional<Result>(nullopt);
+      }
+    }
+  private:
+    // Main coroutine handle
+    coroutine_handle<promise_type> coro;
+  };
+} // namespace SimpleHTTP
+  
+
+namespace SimpleHTTP::internal {
+
+  /**
+   * Abstract internal request interface defining members used to manipulate the Request object
+   *
+   * Not visible to the end user
+   */
+  class RequestInternal {
+  public:
+    virtual ~RequestInternal() {}
+
+    /**
+     * Set the raw HTTP head (request line and header fields) to the request
+     *
+     * The request takes ownership of the head, returns a view on the owned head.
+     * Views passed to the setters below must point into this view.
+     */
+    virtual string_view setHead(string newhead) = 0;
+    
+    /**
+     * Set HTTP method (e.g. GET, POST) to the request
+     */
+    virtual RequestInternal& setMethod(string_view newmethod) = 0;
+
+    /**
+     * Set HTTP path to the request (query parameters are split off)
+     */
+    virtual RequestInternal& setPath(string_view newpath) = 0;
+
+    /**
+     * Set HTTP version to the request
+     */
+    virtual RequestInternal& setVersion(string_view newversion) = 0;
+
+    /**
+     * Add a header field of the head to the request
+     *
+     * Key is kept as is, header lookups are case insensitive
+     */
+    virtual RequestInternal& addHeader(string_view key, string_view value) = 0;
+
+    /**
+     * Set a header to the request, which overrides the header fields of the head
+     *
+     * Key is converted to lowercase
+     */
+    virtual RequestInternal& setHeader(string key, string value) = 0;
+
+    /**
+     * Get HTTP path as view into the head
+     */
+    virtual string_view getPathView() const noexcept = 0;
+
+    /**
+     * Get path parameters captured by the route (name, value)
+     *
+     * Names point into the route tree, values into the head
+     */
+    virtual helper::ArenaVector<pair<string_view, string_view>>& getPathParams() = 0;
+  };
+} // namespace SimpleHTTP::internal
+
+
+namespace SimpleHTTP {
+
+  /**
+   * Abstract external request interface defining members used to inspect the Request object
+   */
+  class Request {
+  public:
+    virtual ~Request() {};
+    /**
+     * Get HTTP method (e.g. GET, POST)
+     */
+    virtual string getMethod() const noexcept = 0;
+
+    /**
+     * Get HTTP path/route (e.g. /api/some)
+     */
+    virtual string getPath() const noexcept = 0;
+
+    /**
+     * Get HTTP version (e.g. HTTP/1.1)
+     */
+    virtual string getVersion() const noexcept = 0;
+
+    /**
+     * Get Content-Length header as integer
+     *
+     * If no valid content-length is set, nullopt is returned
+     */
+    virtual optional<int> getContentLength() = 0;
+
+    /**
+     * Get Transfer-Encoding header as list of encodings (e.g. [ gzip, chunked ])
+     *
+     * If no valid transfer-encoding header is set, nullopt is returned
+     */
+    virtual optional<unordered_set<string>> getTransferEncoding() = 0;
+
+    /**
+     * Get a query parameter from the request
+     */
+    virtual optional<string> getQueryParam(string key) = 0;
+
+    /**
+     * Get a path parameter captured by the route (e.g. "id" for /users/:id)
+     *
+     * The rest matched by a wildcard is captured by its name (e.g. "file" for a trailing "*file" segment)
+     * or by "*" if the wildcard is unnamed
+     */
+    virtual optional<string> getPathParam(string key) = 0;
+
+    /**
+     * Get a header from the request
+     *
+     * Key is strictly lowercase
+     */
+    virtual optional<string> getHeader(string key) = 0;
+  };
+} // namespace SimpleHTTP
+
+
+
+namespace SimpleHTTP::internal {
+
+  /**
+   * Request objects internal derivate, implementing members of the internal and external interfaces
+   *
+   * The request owns the raw HTTP head, method, path, version, query and header fields are stored
+   * as views into it. Strings are only materialized when they are requested by the getters.
+   */
+  class RequestImpl : public SimpleHTTP::Request, public SimpleHTTP::internal::RequestInternal {
+  public:
+    RequestImpl() {}
+
+    // Header fields and path parameters are allocated on the arena
+    RequestImpl(helper::Arena* arena) : headers(arena), pathParams(arena) {}
+
+    // Views point into the owned head, therefore the object must not be copied
+    RequestImpl(const RequestImpl&) = delete;
+    RequestImpl& operator=(const RequestImpl&) = delete;
+    
+    /**
+     * Get HTTP method (e.g. GET, POST)
+     */
+    string getMethod() const noexcept override {
+      return string(method);
+    }
+
+    /**
+     * Get HTTP path/route (e.g. /api/some)
+     */
+    string getPath() const noexcept override {
+      return string(path);
+    }
+
+    /**
+     * Get HTTP version (e.g. HTTP/1.1)
+     */
+    string getVersion() const noexcept override {
+      return string(version);
+    }
+
+    /**
+     * Get Content-Length header as integer
+     *
+     * If no valid content-length is set, nullopt is returned
+     */
+    optional<int> getContentLength() override {
+      auto value = findHeader("content-length");
+      if (!value.has_value()) return nullopt;
+
+      // Skip leading spaces and convert value to integer
+      auto start = value->find_first_not_of(' ');
+      if (start==string_view::npos) return nullopt;
+      int length;
+      auto res = from_chars(value->data()+start, value->data()+value->size(), length);
+      if (res.ec==errc())
+        return length;
+      else return nullopt;
+    }
+
+    /**
+     * Get Transfer-Encoding header as list of encodings (e.g. [ gzip, chunked ])
+     *
+     * If no valid transfer-encoding header is set, nullopt is returned
+     */
+    optional<unordered_set<string>> getTransferEncoding() override {
+      auto value = findHeader("transfer-encoding");
+      if (!value.has_value()) return nullopt;
+
+      // Convert transfer-encoding to a string set
+      auto tokens = parseTransferEncoding(string(value.value()));
+      // If no tokens are found return nullopt
+      if (tokens.empty()) return nullopt;
+      return tokens;
+    }
+
+    /**
+     * Get a query parameter from the request
+     *
+     * If the parameter is set multiple times, the last occurence is returned
+     */
+    optional<string> getQueryParam(string key) override {
+      optional<string_view> result = nullopt;
+      string_view rest = query;
+      // Iterate over every query param (key=value) fragment
+      while (!rest.empty()) {
+        auto fragmentEnd = rest.find('&');
+        string_view fragment = rest.substr(0, fragmentEnd);
+        rest = fragmentEnd==string_view::npos ? string_view() : rest.substr(fragmentEnd+1);
+
+        // Search split character ("=")
+        auto splitPos = fragment.find('=');
+        // If split char not found, the fragment is invalid and skipped
+        if (splitPos==string_view::npos) continue;
+        if (fragment.substr(0, splitPos)==key)
+          result = fragment.substr(splitPos+1);
+      }
+      if (result.has_value())
+        return string(result.value());
+      else
+        return nullopt;
+    }
+
+    /**
+     * Get a path parameter captured by the route (e.g. "id" for /users/:id)
+     *
+     * The rest matched by a wildcard is captured by its name (e.g. "file" for a trailing "*file" segment)
+     * or by "*" if the wildcard is unnamed
+     */
+    optional<string> getPathParam(string key) override {
+      for (auto &param : pathParams) {
+        if (param.first==key) return string(param.second);
+      }
+      return nullopt;
+    }
+
+    /**
+     * Get a header from the request
+     *
+     * Key is strictly lowercase
+     */
+    optional<string> getHeader(string key) override {
+      auto value = findHeader(key);
+      if (value.has_value()) {
+        return string(value.value());
+      } else
+        return nullopt;
+    }
+
+    /**
+     * Set the raw HTTP head (request line and header fields) to the request
+     *
+     * The request takes ownership of the head, returns a view on the owned head.
+     */
+    string_view setHead(string newhead) override {
+      head = std::move(newhead);
+      return head;
+    }
+
+    /**
+     * Set HTTP method (e.g. GET, POST) to the request
+     */
+    RequestImpl& setMethod(string_view newmethod) override {
+      method = newmethod;
+      return *this;
+    }
+
+    /**
+     * Set HTTP path to the request (query parameters are split off)
+     */
+    RequestImpl& setPath(string_view newpath) override {
+      // Search query indicator
+      auto queryPos = newpath.find('?');
+      if (queryPos==string_view::npos) {
+        path = newpath;
+        query = string_view();
+      } else {
+        path = newpath.substr(0, queryPos);
+        query = newpath.substr(queryPos+1);
+      }
+      return *this;
+    }
+
+    /**
+     * Set HTTP version to the request
+     */
+    RequestImpl& setVersion(string_view newversion) override {
+      version = newversion;
+      return *this;
+    }
+
+    /**
+     * Add a header field of the head to the request
+     *
+     * Key is kept as is, header lookups are case insensitive
+     */
+    RequestImpl& addHeader(string_view key, string_view value) override {
+      headers.emplace_back(key, value);
+      return *this;
+    }
+
+    /**
+     * Set a header to the request, which overrides the header fields of the head
+     *
+     * Key is converted to lowercase
+     */
+    RequestImpl& setHeader(string key, string value) override {
+      // Key is converted tolower
+      // in order to properly handle those in the internal structure
+      transform(key.begin(), key.end(), key.begin(),
+        [](unsigned char c){ return tolower(c); }
+      );
+      // Replace existing override
+      for (auto &header : headerOverrides) {
+        if (header.first==key) {
+          header.second = std::move(value);
+          return *this;
+        }
+      }
+      headerOverrides.emplace_back(std::move(key), std::move(value));
+      return *this;
+    }
+
+    /**
+     * Get HTTP path as view into the head
+     */
+    string_view getPathView() const noexcept override {
+      return path;
+    }
+
+    /**
+     * Get path parameters captured by the route (name, value)
+     *
+     * Names point into the route tree, values into the head
+     */
+    helper::ArenaVector<pair<string_view, string_view>>& getPathParams() override {
+      return pathParams;
+    }
+
+  private:
+    // Raw HTTP head, all views below point into it
+    string head;
+    // HTTP Method (e.g. Get, Post, etc.)
+    string_view method;
+    // HTTP Path (e.g. /api/some)
+    string_view path;
+    // HTTP Version (e.g. HTTP/1.1)
+    string_view version;
+
+    // HTTP query string (without '?')
+    string_view query;
+    // HTTP header fields in order of occurrence
+    helper::ArenaVector<pair<string_view, string_view>> headers;
+    // HTTP headers set after parsing (lowercase keys)
+    vector<pair<string, string>> headerOverrides;
+    // Path parameters captured by the route
+    helper::ArenaVector<pair<string_view, string_view>> pathParams;
+
+    /**
+     * Find a header by its lowercase key
+     *
+     * Overrides take precedence, if a header field occurs multiple times the last occurrence is returned
+     */
+    optional<string_view> findHeader(string_view key) {
+      for (auto &header : headerOverrides) {
+        if (header.first==key) return header.second;
+      }
+      for (auto it = headers.rbegin(); it != headers.rend(); it++) {
+        if (it->first.size()!=key.size()) continue;
+        bool match = true;
+        for (size_t i = 0; i < key.size(); i++) {
+          if (tolower((unsigned char)it->first[i])!=key[i]) {
+            match = false;
+            break;
+          }
+        }
+        if (match) return it->second;
+      }
+      return nullopt;
+    }
+    
+    /**
+     * Parse transfer encoding header into a string set
+     *
+     * Returns tokens parsed as string set
+     */
+    unordered_set<string> parseTransferEncoding(string rawValue) {
+      unordered_set<string> tokens;
+      // Create input stream
+      istringstream iss(rawValue);
+      string currentItem;
+      // Parse Transfer Encodings
+      while (getline(iss, currentItem, ',')) {
+        // Trim off spaces
+        auto start = currentItem.find_first_not_of(" ");
+        auto end = currentItem.find_last_not_of(" ");
+        // Skip if no regular char was found in the item
+        if (start==string::npos || end==string::npos) continue;
+        // Insert slice without spaces 
+        tokens.insert(currentItem.substr(start, end - start + 1));
+      }
+      return tokens;
+    }
+  };
+} // namespace SimpleHTTP::internal
+
+
+namespace SimpleHTTP::internal {
+
+  /**
+   * Abstract internal body interface defining members used for the body
+   *
+   * Not visible to the end user
+   */
+  class BodyInternal {
+  public:
+    virtual ~BodyInternal() {}
+
+    /**
+     * Set read request to the body
+     */
+    virtual void setReadRequest(int size, std::vector<unsigned char>* outBuffer) = 0;
+
+    /**
+     * Set read request filling a caller-provided buffer to the body
+     */
+    virtual void setReadRequest(std::span<std::byte> buffer, size_t* readSize) = 0;
+
+    /**
+     * Set request moving body data to a filedescriptor to the body
+     */
+    virtual void setSpliceRequest(int fd, size_t max, size_t* splicedSize) = 0;
+    
+    /**
+     * Clear read request from the body
+     */
+    virtual void clearReadRequest() = 0;
+
+    /**
+     * Process the read request in the event loop
+     */
+    virtual bool processRequest() = 0;
+
+    /**
+     * Returns the size of the body data that was not read yet, nullopt if it is unknown (chunked bodies)
+     */
+    virtual optional<size_t> remainingSize() = 0;
+
+    /**
+     * Function to drain the body in the event loop
+     *
+     * Throws a runtime_error if more then maxSize bytes would have to be drained
+     */
+    virtual optional<internal::helper::Buffer> drainBody(int maxSize) = 0;
+  };
+} // namespace SimpleHTTP::internal
+
+
+namespace SimpleHTTP {
+
+  /**
+   * Awaitable structure to schedule read requests
+   */
+  struct BodyReader {
+    internal::BodyInternal& body;
+    int size;
+    vector<unsigned char> outBuffer;
+
+    // Always suspend
+    bool await_ready() const noexcept { return false; }
+
+    // Before suspending a new readRequest is created
+    void await_suspend(coroutine_handle<> h) {
+      body.setReadRequest(size, &outBuffer);
+    }
+
+    // When resuming, reset the request and move out the outBuffer
+    vector<unsigned char> await_resume() {
+      body.clearReadRequest();
+      return std::move(outBuffer);
+    }
+  };
+
+  /**
+   * Awaitable structure to schedule read requests into a caller-provided buffer
+   */
+  struct BodyIntoReader {
+    internal::BodyInternal& body;
+    span<std::byte> buffer;
+    size_t readSize = 0;
+
+    // Only suspend if there is space to fill
+    bool await_ready() const noexcept { return buffer.empty(); }
+
+    // Before suspending a new readRequest is created
+    void await_suspend(coroutine_handle<> h) {
+      body.setReadRequest(buffer, &readSize);
+    }
+
+    // When resuming, reset the request and return the number of bytes written to the buffer
+    size_t await_resume() {
+      body.clearReadRequest();
+      return readSize;
+    }
+  };
+
+  /**
+   * Awaitable structure to schedule requests moving body data to a filedescriptor
+   */
+  struct BodySplicer {
+    internal::BodyInternal& body;
+    int fd;
+    size_t max;
+    size_t splicedSize = 0;
+
+    // Only suspend if data should be moved
+    bool await_ready() const noexcept { return max == 0; }
+
+    // Before suspending a new spliceRequest is created
+    void await_suspend(coroutine_handle<> h) {
+      body.setSpliceRequest(fd, max, &splicedSize);
+    }
+
+    // When resuming, reset the request and return the number of bytes moved to the filedescriptor
+    size_t await_resume() {
+      body.clearReadRequest();
+      return splicedSize;
+    }
+  };
+
+  /**
+   * Datastructure defining a request to read a certain amount of data from the body
+   */
+  struct BodyReadRequest {
+    int size;
+    vector<unsigned char>* outBuffer;
+  };
+
+  /**
+   * Datastructure defining a request to fill a caller-provided buffer with data from the body
+   */
+  struct BodyReadIntoRequest {
+    span<std::byte> buffer;
+    // Number of bytes written to the buffer (incremented while the request is processed)
+    size_t* readSize;
+  };
+
+  /**
+   * Datastructure defining a request to move data from the body to a filedescriptor
+   */
+  struct BodySpliceRequest {
+    int fd;
+    size_t max;
+    // Number of bytes moved to the filedescriptor (incremented while the request is processed)
+    size_t* splicedSize;
+  };
+
+  
+  /**
+   * Abstract external body interface defining members used to create a readrequest
+   *
+   * Provides functions to create a awaitable read request (read() / readAll())
+   */
+  class Body {
+  public:
+    virtual ~Body() {};
+
+    /**
+     * Read a specified amount data from the body
+     *
+     * Blocks until every the requested data is read
+     *
+     * This function will return an awaitable and schedules reading to the simplehttp event loop.
+     *
+     * Use this function inside a coroutine like this: "auto body = co_await readAll();"
+     *
+     * Returns a vector containing data. If the full body was read an empty vector is returned
+     */
+    virtual BodyReader read(int size) = 0;
+
+    /**
+     * Read all data from the body
+     *
+     * Blocks until every the full body is read
+     *
+     * This function will return an awaitable and schedules reading to the simplehttp event loop.
+     *
+     * Use this function inside a coroutine like this: "auto body = co_await readAll();"
+     *
+     * Returns a vector containing data. If the full body was read an empty vector is returned
+     */
+    virtual BodyReader readAll() = 0;
+
+    /**
+     * Read data from the body directly into the provided buffer
+     *
+     * Blocks until the buffer is filled or the full body is read
+     *
+     * Unlike read(), no intermediate vector is allocated: If no data is buffered internally, the socket
+     * is read directly into the buffer, otherwise the buffered data is copied exactly once.
+     *
+     * Use this function inside a coroutine like this: "size_t n = co_await body.readInto(buffer);"
+     *
+     * Returns the number of bytes written to the buffer. If the full body was read 0 is returned
+     */
+    virtual BodyIntoReader readInto(span<std::byte> buffer) = 0;
+
+    /**
+     * Move data from the body to a filedescriptor (e.g. a file or pipe)
+     *
+     * Blocks until max bytes are moved or the full body is read
+     *
+     * With the epoll backend the data is moved with splice() through a pipe and never enters user space,
+     * only data that is already buffered (e.g. received together with the request head) is written.
+     * For chunked bodies only the chunk delimiters are received, the chunk data is spliced as well.
+     * With the io_uring backend the received data is written to the filedescriptor.
+     *
+     * If writing to the filedescriptor would block (e.g. a full non-blocking pipe), the function waits
+     * until it is writable while the event loop continues serving other connections. Data already moved
+     * out of the socket is kept and written once the filedescriptor is writable again.
+     * Blocking filedescriptors (e.g. a blocking pipe) block the event loop while they are full.
+     * If writing fails, the request fails like on invalid body data.
+     *
+     * Use this function inside a coroutine like this: "size_t n = co_await body.spliceTo(fd, SIZE_MAX);"
+     *
+     * Returns the number of bytes moved to the filedescriptor. If the full body was read 0 is returned
+     */
+    virtual BodySplicer spliceTo(int fd, size_t max) = 0;
+  };
+} // namespace SimpleHTTP
+
+
+
+namespace SimpleHTTP::internal {
+  
+  /**
+   * Filedescriptor watch registered on the watch instance of a loop by a waiting function (see waitReadable())
+   */
+  struct FdWatch {
+    // Filedescriptor of the connection whose function waits
+    int connectionFd = -1;
+    // Id of the wait completed by the watch
+    uint64_t waitId = 0;
+    // Events reported for the watched filedescriptor
+    uint32_t events = 0;
+  };
+
+  /**
+   * Body objects internal derivate, implementing members to process the ReadRequest from internal eventloop
+   */
+  class BodyImpl : public SimpleHTTP::Body, public SimpleHTTP::internal::BodyInternal {
+  public:
+    
+    /**
+     * Read a specified amount data from the body
+     *
+     * Blocks until every the requested data is read
+     *
+     * This function will return an awaitable and schedules reading to the simplehttp event loop.
+     *
+     * Use this function inside a coroutine like this: "auto body = co_await readAll();"
+     *
+     * Returns a vector containing data. If the full body was read an empty vector is returned
+     */
+    BodyReader read(int size) override {
+      return BodyReader{*this, size};
+    }
+
+    /**
+     * Read all data from the body
+     *
+     * Blocks until every the full body is read
+     *
+     * This function will return an awaitable and schedules reading to the simplehttp event loop.
+     *
+     * Use this function inside a coroutine like this: "auto body = co_await readAll();"
+     *
+     * Returns a vector containing data. If the full body was read an empty vector is returned
+     */
+    BodyReader readAll() override {
+      return BodyReader{*this, bodySize};
+    }
+
+    /**
+     * Read data from the body directly into the provided buffer
+     *
+     * Blocks until the buffer is filled or the full body is read
+     *
+     * Unlike read(), no intermediate vector is allocated: If no data is buffered internally, the socket
+     * is read directly into the buffer, otherwise the buffered data is copied exactly once.
+     *
+     * Use this function inside a coroutine like this: "size_t n = co_await body.readInto(buffer);"
+     *
+     * Returns the number of bytes written to the buffer. If the full body was read 0 is returned
+     */
+    BodyIntoReader readInto(span<std::byte> buffer) override {
+      return BodyIntoReader{*this, buffer};
+    }
+
+    /**
+     * Move data from the body to a filedescriptor (e.g. a file or pipe)
+     *
+     * Blocks until max bytes are moved or the full body is read
+     *
+     * With the epoll backend the data is moved with splice() through a pipe and never enters user space,
+     * only data that is already buffered (e.g. received together with the request head) is written.
+     * For chunked bodies only the chunk delimiters are received, the chunk data is spliced as well.
+     * With the io_uring backend the received data is written to the filedescriptor.
+     *
+     * If writing to the filedescriptor would block (e.g. a full non-blocking pipe), the function waits
+     * until it is writable while the event loop continues serving other connections. Data already moved
+     * out of the socket is kept and written once the filedescriptor is writable again.
+     * Blocking filedescriptors (e.g. a blocking pipe) block the event loop while they are full.
+     * If writing fails, the request fails like on invalid body data.
+     *
+     * Use this function inside a coroutine like this: "size_t n = co_await body.spliceTo(fd, SIZE_MAX);"
+     *
+     * Returns the number of bytes moved to the filedescriptor. If the full body was read 0 is returned
+     */
+    BodySplicer spliceTo(int fd, size_t max) override {
+      return BodySplicer{*this, fd, max};
+    }
+
+    
+    /**
+     * Set read request to the body
+     */
+    void setReadRequest(int size, std::vector<unsigned char>* outBuffer) override {
+      request = BodyReadRequest{size, outBuffer};
+    }
+
+    /**
+     * Set read request filling a caller-provided buffer to the body
+     */
+    void setReadRequest(std::span<std::byte> buffer, size_t* readSize) override {
+      intoRequest = BodyReadIntoRequest{buffer, readSize};
+    }
+
+    /**
+     * Set request moving body data to a filedescriptor to the body
+     */
+    void setSpliceRequest(int fd, size_t max, size_t* splicedSize) override {
+      spliceRequest = BodySpliceRequest{fd, max, splicedSize};
+    }
+    
+    /**
+     * Clear read request from the body
+     */
+    void clearReadRequest() override {
+      request = nullopt;
+      intoRequest = nullopt;
+      spliceRequest = nullopt;
+    }
+
+    /**
+     * Returns true if the pending SpliceRequest could not continue because writing to its filedescriptor blocks
+     */
+    bool isSpliceBlocked() const noexcept {
+      return spliceBlocked;
+    }
+
+    /**
+     * Registers the filedescriptor of the blocked SpliceRequest on the watch instance
+     *
+     * The watch is registered oneshot and completes the wait of the connection once the filedescriptor
+     * is writable. It is unregistered with unwatchSpliceTarget() or when the body is destroyed.
+     *
+     * Throws a runtime_error if the filedescriptor cannot be registered
+     */
+    void watchSpliceTarget(int watchInstance, int connectionFd, uint64_t waitId) {
+      int fd = spliceRequest.value().fd;
+      struct epoll_event event;
+      event.events = EPOLLOUT | EPOLLONESHOT;
+      event.data.ptr = &spliceWatch;
+      if (epoll_ctl(watchInstance, EPOLL_CTL_ADD, fd, &event) < 0) throw runtime_error(strerror(errno));
+      spliceWatch = FdWatch{connectionFd, waitId, 0};
+      spliceWatchFd = fd;
+      spliceWatchInstance = watchInstance;
+    }
+
+    /**
+     * Unregisters the filedescriptor of the SpliceRequest from the watch instance
+     *
+     * Returns true if it was registered
+     */
+    bool unwatchSpliceTarget() noexcept {
+      if (spliceWatchInstance < 0) return false;
+      epoll_ctl(spliceWatchInstance, EPOLL_CTL_DEL, spliceWatchFd, nullptr);
+      spliceWatchInstance = -1;
+      return true;
+    }
+
+    ~BodyImpl() {
+      unwatchSpliceTarget();
+      helper::PipePool::Return(splicePipe, splicePending);
+    }
+    
+  protected:
+    BodyImpl(
+      helper::Socket* socket,
+      int socketBufferSize,
+      int bodySize,
+      helper::Buffer initBuffer
+    ) : socket(socket), socketBufferSize(socketBufferSize), bodySize(bodySize), readBuffer(std::move(initBuffer)) {}
+    
+    // Socket filedescriptor
+    helper::Socket* socket;
+    // Socket buffer size
+    int socketBufferSize;
+    // Remaining body size (this value is decremented when reading the body)
+    int bodySize;
+    // Temporary buffer holding the received data
+    // Data which is read from the user is erased from this
+    helper::Buffer readBuffer;
+    // Current pending read request
+    optional<BodyReadRequest> request;
+    // Current pending read request into a caller-provided buffer
+    optional<BodyReadIntoRequest> intoRequest;
+    // Current pending request moving data to a filedescriptor
+    optional<BodySpliceRequest> spliceRequest;
+    // Pipe used to splice data from the socket to the filedescriptor
+    // (taken from the PipePool of the loop while data is spliced)
+    helper::Pipe splicePipe;
+    // Bytes spliced into the splicePipe that were not moved to the filedescriptor yet (its write blocked)
+    size_t splicePending = 0;
+    // Determines if writing to the filedescriptor of the spliceRequest blocked
+    bool spliceBlocked = false;
+    // Watch waiting until the filedescriptor of the spliceRequest is writable
+    FdWatch spliceWatch;
+    // Filedescriptor registered with the spliceWatch
+    int spliceWatchFd = -1;
+    // Watch instance the spliceWatch is registered on (-1 if not registered)
+    int spliceWatchInstance = -1;
+
+    /**
+     * Writes up to size bytes from the front of the buffer to the filedescriptor and erases them
+     *
+     * Returns the number of bytes written, spliceBlocked is set if the write blocked before size bytes were written
+     *
+     * Throws a runtime_error if writing fails
+     */
+    size_t writeBuffered(helper::Buffer& buffer, int fd, size_t size) {
+      string_view data = buffer.view();
+      size = writeSome(fd, data.data(), min(size, data.size()));
+      if (size > 0) {
+        buffer.set(size-1);
+        buffer.eraseBeforeCursor();
+      }
+      return size;
+    }
+
+    /**
+     * Moves up to size bytes of data received from the socket to the filedescriptor
+     *
+     * In readiness mode the data is moved with splice() through the splicePipe without copying it
+     * to user space. In completion mode the delivered data is written directly from its provided buffer.
+     * If writing blocks, the data which was already received is kept (in the splicePipe or readBuffer)
+     * and moved first on the next call.
+     *
+     * Returns the number of bytes moved (spliceBlocked is set if the write blocked)
+     * or -1 if the socket blocks
+     *
+     * Throws a runtime_error if the connection failed or writing fails
+     */
+    ssize_t spliceSocket(int fd, size_t size) {
+      ssize_t n;
+      if (socket->isCompletionMode()) {
+        // The delivered data is written directly from the provided buffer
+        string_view delivered = socket->Delivered();
+        if (!delivered.empty()) {
+          delivered = delivered.substr(0, size);
+          size_t written = writeSome(fd, delivered.data(), delivered.size());
+          // The readBuffer is empty while data is received here, the rest is written from it on the next call
+          if (written < delivered.size()) readBuffer.insert(delivered.data()+written, delivered.data()+delivered.size());
+          socket->Consume(delivered.size());
+          return written;
+        }
+        // Without delivered data the receive operation is registered (or the delivered error is returned)
+        n = socket->Recv(nullptr, 0);
+      } else {
+        if (splicePipe.ReadFd() < 0 && !helper::PipePool::Take(splicePipe)) throw runtime_error(strerror(errno));
+        if (splicePending == 0) {
+          n = socket->Splice(splicePipe.WriteFd(), size);
+          if (n > 0) splicePending = n;
+        }
+        if (splicePending > 0) {
+          // Move the data out of the pipe, so that it is empty for the next call
+          size_t moved = 0;
+          while (moved < min(size, splicePending)) {
+            ssize_t w = splice(splicePipe.ReadFd(), nullptr, fd, nullptr, min(size, splicePending)-moved, SPLICE_F_MOVE);
+            if (w < 0 && errno == EINTR) continue;
+            if (w < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+              spliceBlocked = true;
+              break;
+            }
+            if (w < 1) throw runtime_error(w < 0 ? strerror(errno) : "Failed writing body data");
+            moved += w;
+          }
+          splicePending -= moved;
+          // The pipe is only held while data is pending in it
+          if (splicePending == 0) helper::PipePool::Return(splicePipe, 0);
+          return moved;
+        }
+        helper::PipePool::Return(splicePipe, 0);
+      }
+      if (n == 0)
+        // If connection was closed by peer, this is unexpected. The eventloop will clean it up
+        throw runtime_error("Connection closed unexpectedly");
+      if (n < 1) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+          // If the call block give the control to the event loop
+          // The event loop will then continue execution if data is available
+          return -1;
+        } else {
+          // Throw exception. The eventloop will close and cleanup the tcp connection
+          throw runtime_error(strerror(errno));
+        }
+      }
+      return n;
+    }
+
+    /**
+     * Discards up to size bytes of data received from the socket
+     *
+     * Returns the number of bytes discarded or -1 if the socket blocks
+     *
+     * Throws a runtime_error if the connection failed
+     */
+    ssize_t discardSocket(size_t size) {
+      ssize_t n = socket->Discard(size);
+      if (n == 0)
+        // If connection was closed by peer, this is unexpected. The eventloop will clean it up
+        throw runtime_error("Connection closed unexpectedly");
+      if (n < 1) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+          // If the call block give the control to the event loop
+          // The event loop will then continue execution if data is available
+          return -1;
+        } else {
+          // Throw exception. The eventloop will close and cleanup the tcp connection
+          throw runtime_error(strerror(errno));
+        }
+      }
+      return n;
+    }
+
+    /**
+     * Writes the data to the filedescriptor until it is written or the write blocks
+     *
+     * Returns the number of bytes written, spliceBlocked is set if the write blocked
+     *
+     * Throws a runtime_error if writing fails
+     */
+    size_t writeSome(int fd, const void* data, size_t size) {
+      size_t written = 0;
+      while (written < size) {
+        ssize_t n = write(fd, (const char*)data + written, size - written);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+          spliceBlocked = true;
+          break;
+        }
+        if (n < 1) throw runtime_error(n < 0 ? strerror(errno) : "Failed writing body data");
+        written += n;
+      }
+      return written;
+    }
+  };
+
+  
+  /**
+   * Inherited object to read an HTTP body with a fixed size
+   *
+   * Overrides functions to handle fixed HTTP bodys (Content-Length: xy)
+   */
+  class FixedBodyImpl : public SimpleHTTP::internal::BodyImpl {
+  public:
+    FixedBodyImpl(
+      helper::Socket* socket,
+      int socketBufferSize,
+      int bodySize,
+      helper::Buffer initBuffer
+    ) : BodyImpl(socket, socketBufferSize, bodySize, std::move(initBuffer)) {}
+    
+    /**
+     * Reads the body with a fixed size (HTTP Content-Length header is set)
+     *
+     * Reads the data requested by the ReadRequest into the outBuffer
+     * and updates the bodySize of the Body accordingly
+     *
+     * Data is read buffered, which means it reads the defined socketBufferSize
+     * into the readBuffer and then returns the requested amount of data.
+     *
+     * Returns true if the requested amount or the full body was read.
+     *
+     * Returns false if the requested amount was not read but the socket blocks
+     *
+     * Throws a runtime_error if the connection failed
+     */
+    bool processRequest() override {
+      if (intoRequest.has_value()) return processIntoRequest();
+      if (spliceRequest.has_value()) return processSpliceRequest();
+      // If no value is in queue return true to continue      
+      if (!request.has_value()) return true;
+      BodyReadRequest req = request.value();
+      
+      // Cap size to body size if size is larger then body
+      req.size = req.size>bodySize ? bodySize : req.size;
+      
+      while (1) {
+        // If bodySize is <= 0 an empty vector is returned
+        if (bodySize<=0) {
+          *req.outBuffer = {};
+          return true;
+        }
+        // Check if readBuffer contains enough data
+        if (readBuffer.size() >= req.size) {
+          // Set cursor to requested index + 1 (requested size)
+          readBuffer.set(req.size-1);
+          
+          // Copy the requested data (0-requested index) to outBuffer
+          *req.outBuffer = readBuffer.vecBeforeCursor();
+          // Erase the removed data from the buffer
+          readBuffer.eraseBeforeCursor();
+          // Decrement body size
+          bodySize -= req.size;
+          return true;
+        }
+
+        // Try to load the full socketBufferSize to the readBuffer
+        // This avoids underfetching (e.g. if read() is called frequently just for several bytes)
+        unsigned char* buffer = helper::ScratchBuffer(socketBufferSize);
+        int n = socket->Recv(buffer, socketBufferSize);
+        if (n == 0)
+          // If connection was closed by peer, this is unexpected. The eventloop will clean it up
+          throw runtime_error("Connection closed unexpectedly");
+        if (n < 1) {
+          if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            // If the call block give the control to the event loop
+            // The event loop will then continue execution if data is available
+            return false;
+          } else {
+            // Throw exception. The eventloop will close and cleanup the tcp connection
+            throw runtime_error(strerror(errno));
+          }
+        }
+        // Insert received data to readBuffer
+        readBuffer.insert(buffer, buffer+n);
+      }
+    }
+
+    /**
+     * Returns the size of the body data that was not read yet
+     */
+    optional<size_t> remainingSize() override {
+      return size_t(max(bodySize, 0));
+    }
+
+    /**
+     * Drains the body by reading all remaining body data
+     *
+     * Returns overfetched data if the entire body has been read.
+     * By draining directly on fixedBody, it discards the data immediately without
+     * cycling it through a readBuffer (with MSG_TRUNC no data is copied at all).
+     * Therefore, this will always result in an empty buffer on success.
+     *
+     * Returns nullopt if more data is required and the socket blocks
+     *
+     * Throws a runtime_error if the underlying connection fails or if the remaining body exceeds maxSize
+     */
+    optional<helper::Buffer> drainBody(int maxSize) override {
+      // Closing the connection is cheaper then draining a large body
+      if (bodySize > maxSize) throw runtime_error("Body exceeds the drain limit");
+      // Discard body data that is already buffered (e.g. received together with the request head)
+      if (!readBuffer.empty()) {
+        if (readBuffer.size() >= bodySize) {
+          // Buffer contains the rest of the body, the remaining data belongs to the next request
+          readBuffer.set(bodySize-1);
+          readBuffer.eraseBeforeCursor();
+          bodySize = 0;
+          return std::move(readBuffer);
+        }
+        bodySize -= readBuffer.size();
+        readBuffer = helper::Buffer();
+      }
+      while (bodySize > 0) {
+        // Discard the data on the socket
+        // The read is capped to the body size, so that no data of a pipelined request is consumed
+        ssize_t n = discardSocket(bodySize);
+        if (n < 0) return nullopt;
+        // Decrement body size by the discarded bytes
+        bodySize -= n;
+      }
+      // Return empty buffer as we directly discarded the data
+      return helper::Buffer();
+    }
+
+  private:
+    /**
+     * Fills the buffer of the ReadIntoRequest with body data
+     *
+     * Data already buffered in the readBuffer is copied once, afterwards the socket is read
+     * directly into the buffer. Reads are capped to the remaining body size, so that no data
+     * of a pipelined request is consumed.
+     *
+     * Returns true if the buffer is filled or the full body was read.
+     *
+     * Returns false if the buffer is not filled but the socket blocks
+     *
+     * Throws a runtime_error if the connection failed
+     */
+    bool processIntoRequest() {
+      BodyReadIntoRequest& req = intoRequest.value();
+      while (*req.readSize < req.buffer.size() && bodySize > 0) {
+        std::byte* target = req.buffer.data() + *req.readSize;
+        size_t size = min(req.buffer.size() - *req.readSize, size_t(bodySize));
+
+        // Copy data that is already buffered (e.g. received together with the request head)
+        if (!readBuffer.empty()) {
+          string_view buffered = readBuffer.view();
+          size = min(size, buffered.size());
+          memcpy(target, buffered.data(), size);
+          readBuffer.set(size-1);
+          readBuffer.eraseBeforeCursor();
+          *req.readSize += size;
+          bodySize -= size;
+          continue;
+        }
+
+        int n = socket->Recv(target, size);
+        if (n == 0)
+          // If connection was closed by peer, this is unexpected. The eventloop will clean it up
+          throw runtime_error("Connection closed unexpectedly");
+        if (n < 1) {
+          if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            // If the call block give the control to the event loop
+            // The event loop will then continue execution if data is available
+            return false;
+          } else {
+            // Throw exception. The eventloop will close and cleanup the tcp connection
+            throw runtime_error(strerror(errno));
+          }
+        }
+        *req.readSize += n;
+        bodySize -= n;
+      }
+      return true;
+    }
+
+    /**
+     * Moves body data of the SpliceRequest to the filedescriptor
+     *
+     * Data already buffered in the readBuffer is written, afterwards the socket data is spliced.
+     * Moves are capped to the remaining body size, so that no data of a pipelined request is consumed.
+     *
+     * Returns true if the requested amount or the full body was moved.
+     *
+     * Returns false if the requested amount was not moved but the socket or the filedescriptor blocks
+     * (spliceBlocked is set if the filedescriptor blocks)
+     *
+     * Throws a runtime_error if the connection failed or writing fails
+     */
+    bool processSpliceRequest() {
+      BodySpliceRequest& req = spliceRequest.value();
+      spliceBlocked = false;
+      while (*req.splicedSize < req.max && bodySize > 0) {
+        size_t size = min(req.max - *req.splicedSize, size_t(bodySize));
+        size_t n;
+        if (!readBuffer.empty()) {
+          n = writeBuffered(readBuffer, req.fd, size);
+        } else {
+          ssize_t spliced = spliceSocket(req.fd, size);
+          if (spliced < 0) return false;
+          n = spliced;
+        }
+        *req.splicedSize += n;
+        bodySize -= n;
+        if (spliceBlocked) return false;
+      }
+      return true;
+    }
+  };
+
+
+  /**
+   * Inherited object to read an HTTP body with a dynamic size
+   *
+   * Overrides functions to handle chunked HTTP bodys (Transfer-Encoding: chunked)
+   */
+  class ChunkedBodyImpl : public SimpleHTTP::internal::BodyImpl {
+  public:
+    ChunkedBodyImpl(
+      helper::Socket* socket,
+      int socketBufferSize,
+      helper::Buffer initBuffer,
+      size_t maxBodySize
+      // Body size is set to INT_MAX in order that if readAll wants to read all
+      // that it reads until the body is fully read
+    ) : BodyImpl(socket, socketBufferSize, INT_MAX, std::move(initBuffer)), maxBodySize(maxBodySize) {}
+    
+    /**
+     * Reads the body with transfer encoding "chunked"
+     *
+     * Reads the data requested by the ReadRequest into the outBuffer
+     *
+     * Data is read buffered, which means it reads the defined socketBufferSize
+     * into the readBuffer and then returns the requested amount of data.
+     *
+     * Returns true if the requested amount or the full body was read.
+     *
+     * Returns false if the requested amount was not read but the socket blocks
+     *
+     * Throws a runtime_error if the connection failed or if the transfer-encoding is invalid
+     */
+    bool processRequest() override {
+      if (intoRequest.has_value()) {
+        BodyReadIntoRequest& req = intoRequest.value();
+        size_t size = min(req.buffer.size(), size_t(INT_MAX));
+        if (!decode(size)) return false;
+        // Copy the decoded data once into the buffer
+        size = min(size, size_t(rawReadBuffer.size()));
+        if (size > 0) {
+          memcpy(req.buffer.data(), rawReadBuffer.view().data(), size);
+          rawReadBuffer.set(size-1);
+          rawReadBuffer.eraseBeforeCursor();
+        }
+        *req.readSize = size;
+        return true;
+      }
+      if (spliceRequest.has_value()) return processSpliceRequest();
+      // If no value is in queue return true to continue      
+      if (!request.has_value()) return true;
+      BodyReadRequest req = request.value();
+
+      if (!decode(req.size)) return false;
+      // Cap req size to rawReadBuffer size if the full body is read
+      req.size = req.size > rawReadBuffer.size() ? rawReadBuffer.size() : req.size;
+      // Set cursor to requested index (requested size - 1)
+      rawReadBuffer.set(req.size-1);
+      // Copy the requested data (0-requested index) to outBuffer
+      *req.outBuffer = rawReadBuffer.vecBeforeCursor();
+      // Erase the removed data from the buffer
+      rawReadBuffer.eraseBeforeCursor();
+      return true;
+    }
+
+    /**
+     * Returns the size of the body data that was not read yet
+     *
+     * The size is unknown (nullopt) until the last chunk was decoded
+     */
+    optional<size_t> remainingSize() override {
+      if (bodyDecoded()) return rawReadBuffer.size();
+      return nullopt;
+    }
+
+    /**
+     * Drains the body by reading all remaining body data
+     *
+     * Returns overfetched data if the entire body has been read.
+     * Chunk data is discarded directly on the socket, only the chunk delimiters are received into
+     * the readBuffer. The data fetched that does not belong to the body is returned.
+     *
+     * The readBuffer is explicitly moved to omit a buffercopy, this means using the Body afterwards leads
+     * to undefined behavior!
+     *
+     * Returns nullopt if more data is required and the socket blocks
+     *
+     * Throws a runtime_error if the underlying connection fails or if more then maxSize bytes are drained
+     */
+    optional<helper::Buffer> drainBody(int maxSize) override {
+      // Decoded data which was not read counts to the drained data
+      drainedSize += rawReadBuffer.size();
+      rawReadBuffer = helper::Buffer();
+      while (1) {
+        // Process data from buffer, chunk data is discarded
+        while (chunkState!=ChunkState::DONE) {
+          if (chunkState==ChunkState::DATA) {
+            size_t n = min(chunkRemaining, size_t(readBuffer.size()));
+            if (n==0) break;
+            drainedSize += n;
+            consumeChunkData(n);
+          } else if (!processDelimiter()) {
+            break;
+          }
+        }
+        // Closing the connection is cheaper then draining a large body
+        if (drainedSize > size_t(maxSize)) throw runtime_error("Body exceeds the drain limit");
+        // Check if the full body including the trailer was read
+        if (chunkState==ChunkState::DONE) {
+          return std::move(readBuffer);
+        }
+
+        if (chunkState==ChunkState::DATA) {
+          // Discard the chunk data on the socket (at most one byte more then the limit allows)
+          ssize_t n = discardSocket(min(chunkRemaining, size_t(maxSize) - drainedSize + 1));
+          if (n < 0) return nullopt;
+          drainedSize += n;
+          chunkDataConsumed(n);
+        } else if (!receive()) {
+          return nullopt;
+        }
+      }
+    }
+
+  private:
+    /**
+     * State of the decoder
+     */
+    enum class ChunkState {
+      SIZE,     // Expecting the chunk size line
+      DATA,     // Reading chunk data (chunkRemaining bytes left)
+      DATA_END, // Expecting the CRLF after the chunk data
+      TRAILER,  // Last chunk was read, expecting the trailer section
+      DONE      // Full body including the trailer was read
+    };
+
+    // Buffer holding the decoded data
+    helper::Buffer rawReadBuffer;
+    // Current state of the decoder
+    ChunkState chunkState = ChunkState::SIZE;
+    // Remaining data of the current chunk
+    size_t chunkRemaining = 0;
+    // Size of the chunk data discarded by drainBody()
+    size_t drainedSize = 0;
+    // Sum of the chunk sizes declared so far
+    size_t declaredSize = 0;
+    // Defines the maximum size of the body, chunks exceeding it are considered invalid
+    size_t maxBodySize;
+    // Defines the maximum length of the chunk size line (hexadecimal size, extensions and CRLF)
+    // If the line is longer the encoding is considered invalid
+    const size_t maxChunkSizeLineLength = 64;
+
+    /**
+     * Returns whether all chunk data was decoded (the trailer may not be read yet)
+     */
+    bool bodyDecoded() const noexcept {
+      return chunkState==ChunkState::TRAILER || chunkState==ChunkState::DONE;
+    }
+
+    /**
+     * Decodes the chunked body into the rawReadBuffer
+     *
+     * Chunks are decoded as they arrive, so a chunk does not need to be fully buffered.
+     *
+     * Returns true if the rawReadBuffer contains at least size bytes or the full body was decoded.
+     *
+     * Returns false if more data is required but the socket blocks
+     *
+     * Throws a runtime_error if the connection failed or if the transfer-encoding is invalid
+     */
+    bool decode(int size) {
+      while (1) {
+        // Process data from buffer
+        while (!bodyDecoded() && rawReadBuffer.size() < size) {
+          if (chunkState==ChunkState::DATA) {
+            size_t n = min(chunkRemaining, size_t(readBuffer.size()));
+            if (n==0) break;
+            // Copy chunk data from readBuffer directly to rawReadBuffer
+            string_view data = readBuffer.view();
+            rawReadBuffer.insert(data.data(), data.data()+n);
+            consumeChunkData(n);
+          } else if (!processDelimiter()) {
+            break;
+          }
+        }
+        
+        // Check if rawReadBuffer contains enough data or if the full body was read
+        if (rawReadBuffer.size() >= size || bodyDecoded()) return true;
+
+        if (!receive()) return false;
+      }
+    }
+
+    /**
+     * Moves decoded body data of the SpliceRequest to the filedescriptor
+     *
+     * Chunk data already buffered is written, afterwards the chunk data is spliced from the socket.
+     * Only the chunk delimiters (size lines and CRLF) are received into the readBuffer (see receiveDelimiter()).
+     * The trailer and data received by previous read requests are still buffered.
+     *
+     * Returns true if the requested amount or the full body was moved.
+     *
+     * Returns false if the requested amount was not moved but the socket or the filedescriptor blocks
+     * (spliceBlocked is set if the filedescriptor blocks)
+     *
+     * Throws a runtime_error if the connection failed, writing fails or if the transfer-encoding is invalid
+     */
+    bool processSpliceRequest() {
+      BodySpliceRequest& req = spliceRequest.value();
+      spliceBlocked = false;
+      while (*req.splicedSize < req.max) {
+        size_t size = req.max - *req.splicedSize;
+        // Write data that was decoded by previous read requests first
+        if (!rawReadBuffer.empty()) {
+          *req.splicedSize += writeBuffered(rawReadBuffer, req.fd, size);
+          if (spliceBlocked) return false;
+          continue;
+        }
+        if (bodyDecoded()) return true;
+
+        if (chunkState==ChunkState::DATA) {
+          size = min(size, chunkRemaining);
+          size_t n;
+          if (!readBuffer.empty()) {
+            n = writeBuffered(readBuffer, req.fd, size);
+          } else {
+            ssize_t spliced = spliceSocket(req.fd, size);
+            if (spliced < 0) return false;
+            n = spliced;
+          }
+          chunkDataConsumed(n);
+          *req.splicedSize += n;
+          if (spliceBlocked) return false;
+        } else if (!processDelimiter()) {
+          if (!receiveDelimiter()) return false;
+        }
+      }
+      return true;
+    }
+
+    /**
+     * Processes the delimiter of the current state (chunk size line, CRLF after the data or trailer)
+     *
+     * Returns true if the delimiter was processed
+     *
+     * Returns false if more data needs to be in the readBuffer
+     *
+     * Throws a runtime_error if the input is invalid encoded
+     */
+    bool processDelimiter() {
+      switch (chunkState) {
+      case ChunkState::SIZE:
+        return processChunkSize();
+      case ChunkState::DATA_END:
+        return processChunkEnd();
+      case ChunkState::TRAILER:
+        return processTrailer();
+      default:
+        return false;
+      }
+    }
+
+    /**
+     * Reads and parses the chunk size line for the next chunk
+     *
+     * Chunk extensions (";name=value") are ignored.
+     *
+     * Returns true if the chunk size was read into chunkRemaining
+     *
+     * Returns false if more data needs to be in the readBuffer
+     *
+     * Throws a runtime_error if the input is invalid encoded
+     */
+    bool processChunkSize() {
+      string_view data = readBuffer.view();
+      // There is a max size for the line to prevent invalid or malicious
+      // encoding to starve the performance of the server
+      size_t lineEnd = helper::FindByte(data.substr(0, maxChunkSizeLineLength), 0, '\n');
+      if (lineEnd==string_view::npos) {
+        if (data.size() >= maxChunkSizeLineLength) throw runtime_error("Chunk size line too long");
+        return false;
+      }
+      string_view line = data.substr(0, lineEnd);
+      if (!line.empty() && line.back()=='\r') line.remove_suffix(1);
+
+      // Parse the size as hexadecimal number (sizes that do not fit into size_t are out of range)
+      size_t size;
+      const char* end = line.data()+line.size();
+      auto [ptr, ec] = from_chars(line.data(), end, size, 16);
+      if (ec!=errc() || ptr==line.data() || (ptr!=end && *ptr!=';' && *ptr!=' ' && *ptr!='\t')) {
+        throw runtime_error("Invalid chunk size");
+      }
+      // The declared size never exceeds maxBodySize, therefore the subtraction cannot wrap
+      if (size > maxBodySize - declaredSize) {
+        throw runtime_error("Chunked body exceeds the maximum body size");
+      }
+      declaredSize += size;
+
+      // Erase the size line
+      readBuffer.set(lineEnd);
+      readBuffer.eraseBeforeCursor();
+      chunkRemaining = size;
+      chunkState = size==0 ? ChunkState::TRAILER : ChunkState::DATA;
+      return true;
+    }
+
+    /**
+     * Parses the CRLF after the chunk data
+     *
+     * Returns true if the CRLF was read
+     *
+     * Returns false if more data needs to be in the readBuffer
+     *
+     * Throws a runtime_error if the input is invalid encoded
+     */
+    bool processChunkEnd() {
+      string_view data = readBuffer.view();
+      if (data.size() < 2) return false;
+      // Expect CRLF ('\r' & '\n') after chunk (defined in RFC 7230)
+      if (data[0]!='\r' || data[1]!='\n') {
+        throw runtime_error("Expected CRLF after chunk");
+      }
+      readBuffer.set(1);
+      readBuffer.eraseBeforeCursor();
+      chunkState = ChunkState::SIZE;
+      return true;
+    }
+
+    /**
+     * Parses and skips the trailer section after the last chunk
+     *
+     * Trailer fields are discarded, only the terminating empty line is required.
+     * Afterwards the readBuffer only contains data that belongs to the next request.
+     *
+     * Returns true if the trailer section was fully consumed
+     *
+     * Returns false if more data needs to be in the readBuffer
+     */
+    bool processTrailer() {
+      while (1) {
+        string_view data = readBuffer.view();
+        size_t lineEnd = helper::FindByte(data, 0, '\n');
+        if (lineEnd==string_view::npos) return false;
+        // Line is empty if it only consists of CRLF (or LF)
+        bool emptyLine = lineEnd==0 || (lineEnd==1 && data[0]=='\r');
+        readBuffer.set(lineEnd);
+        readBuffer.eraseBeforeCursor();
+        if (emptyLine) {
+          chunkState = ChunkState::DONE;
+          return true;
+        }
+      }
+    }
+
+    /**
+     * Erases n bytes of chunk data from the front of the readBuffer
+     */
+    void consumeChunkData(size_t n) {
+      readBuffer.set(n-1);
+      readBuffer.eraseBeforeCursor();
+      chunkDataConsumed(n);
+    }
+
+    /**
+     * Marks n bytes of the current chunk as consumed
+     */
+    void chunkDataConsumed(size_t n) {
+      chunkRemaining -= n;
+      if (chunkRemaining==0) chunkState = ChunkState::DATA_END;
+    }
+
+    /**
+     * Receives the delimiter of the current state from the socket into the readBuffer
+     *
+     * In readiness mode only the bytes of the delimiter are received, so that the following chunk data
+     * remains on the socket and can be spliced: the size line is located with MSG_PEEK and received
+     * up to its line feed, the CRLF after the chunk data is received exactly.
+     * If the size line is incomplete, the received part of it is kept in the readBuffer.
+     * The trailer (followed by the next request) and sockets in completion mode, whose data
+     * was already delivered to user space, are received with receive().
+     *
+     * Returns false if the socket blocks
+     *
+     * Throws a runtime_error if the connection failed
+     */
+    bool receiveDelimiter() {
+      if (socket->isCompletionMode() || chunkState==ChunkState::TRAILER) return receive();
+      size_t size;
+      unsigned char* buffer;
+      if (chunkState==ChunkState::DATA_END) {
+        // processChunkEnd() requires two bytes
+        size = 2 - readBuffer.size();
+        buffer = helper::ScratchBuffer(size);
+      } else {
+        // processChunkSize() throws once the buffered line reaches maxChunkSizeLineLength
+        size = maxChunkSizeLineLength - readBuffer.size();
+        buffer = helper::ScratchBuffer(size);
+        ssize_t n = socket->Recv(buffer, size, MSG_PEEK);
+        if (!checkReceived(n)) return false;
+        const void* lineFeed = memchr(buffer, '\n', n);
+        size = lineFeed ? (unsigned char*)lineFeed - buffer + 1 : n;
+      }
+      ssize_t n = socket->Recv(buffer, size);
+      if (!checkReceived(n)) return false;
+      readBuffer.insert(buffer, buffer + n);
+      return true;
+    }
+
+    /**
+     * Checks the result of a receive call
+     *
+     * Returns false if the socket blocks
+     *
+     * Throws a runtime_error if the connection failed
+     */
+    bool checkReceived(ssize_t n) {
+      if (n == 0)
+        // If connection was closed by peer, this is unexpected. The eventloop will clean it up
+        throw runtime_error("Connection closed unexpectedly");
+      if (n < 1) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+          // If the call block give the control to the event loop
+          // The event loop will then continue execution if data is available
+          return false;
+        } else {
+          // Throw exception. The eventloop will close and cleanup the tcp connection
+          throw runtime_error(strerror(errno));
+        }
+      }
+      return true;
+    }
+
+    /**
+     * Receives data from the socket into the readBuffer
+     *
+     * Tries to load the full socketBufferSize to the readBuffer
+     * This avoids underfetching (e.g. if read() is called frequently just for several bytes)
+     *
+     * Returns false if the socket blocks
+     *
+     * Throws a runtime_error if the connection failed
+     */
+    bool receive() {
+      unsigned char* buffer = helper::ScratchBuffer(socketBufferSize);
+      int n = socket->Recv(buffer, socketBufferSize);
+      if (!checkReceived(n)) return false;
+
+      // Insert received data to readBuffer
+      readBuffer.insert(buffer, buffer + n);
+      return true;
+    }
+  };
+} // namespace SimpleHTTP
+
+
+
+namespace SimpleHTTP::internal {
+    
+  /**
+   * Abstract internal response interface defining members used to inspect the Response object
+   *
+   * Not visible to the end user
+   */
+  class ResponseInternal {
+  public:
+    virtual ~ResponseInternal() {}
+
+    /**
+     * Get HTTP version (e.g. HTTP/1.1)
+     */
+    virtual string getVersion() const noexcept = 0;
+
+    /**
+     * Get HTTP status code (e.g. 200)
+     */
+    virtual uint getStatusCode() const noexcept = 0;
+
+    /**
+     * Get HTTP status reason (e.g. OK)
+     */
+    virtual string getStatusReason() const noexcept = 0;
+
+    /**
+     * Get Content-Type header
+     *
+     * If no valid content-type is set, nullopt is returned
+     */
+    virtual optional<string> getContentType() = 0;
+
+    /**
+     * Get Date header as time_point from response
+     *
+     * If no valid date is set, nullopt is returned
+     */
+    virtual optional<chrono::system_clock::time_point> getDate() = 0;
+
+    /**
+     * Get header from the response
+     */
+    virtual helper::ArenaMap<string, string>& getHeaders() = 0;
+
+    /**
+     * Get header to the response
+     *
+     * If header is not present, nullopt is returned
+     */
+    virtual optional<string> getHeader(string key) = 0;
+
+    /**
+     * Get body from the response
+     */
+    virtual string getBody() = 0;
+
+    /**
+     * Move body out of the response
+     *
+     * Afterwards the body of the response is empty
+     */
+    virtual string takeBody() = 0;
+
+    /**
+     * Move the file range set by sendFile() out of the response
+     *
+     * Returns nullopt if the body is not sent from a file
+     */
+    virtual optional<helper::FileRange> takeFile() = 0;
+
+    /**
+     * Serialize status line and headers (including the terminating empty line)
+     */
+    virtual string serializeHead() = 0;
+
+    /**
+     * Attach the connection the response is streamed to
+     *
+     * Written data is queued to the queue, which is sent to the socket
+     * once it exceeds maxQueueSize (or if it is flushed)
+     */
+    virtual void attachConnection(helper::Socket* socket, helper::SendQueue* queue, size_t maxQueueSize) = 0;
+
+    /**
+     * Returns whether the response is streamed (head was queued by write() / flush())
+     */
+    virtual bool isStreaming() = 0;
+
+    /**
+     * Terminates the streamed body
+     *
+     * The remaining body (set by setBody() / appendBody()) is queued as last chunk
+     */
+    virtual void finishStream() = 0;
+
+    /**
+     * Set write request to the response
+     */
+    virtual void setWriteRequest(bool flush) = 0;
+
+    /**
+     * Clear write request from the response
+     */
+    virtual void clearWriteRequest() = 0;
+
+    /**
+     * Returns whether a write request is pending
+     */
+    virtual bool hasWriteRequest() = 0;
+
+    /**
+     * Process the write request (directly or in the event loop)
+     *
+     * Returns true if the request is completed
+     */
+    virtual bool processRequest() = 0;
+  };
+} // namespace SimpleHTTP::internal
+
+
+
+namespace SimpleHTTP {
+
+  /**
+   * Awaitable structure to schedule write requests
+   */
+  struct ResponseWriter {
+    internal::ResponseInternal& response;
+    bool flush;
+
+    // Always suspend
+    bool await_ready() const noexcept { return false; }
+
+    // Before suspending a new writeRequest is created
+    // If it can be completed immediately, the coroutine is resumed without involving the event loop
+    bool await_suspend(coroutine_handle<> h) {
+      response.setWriteRequest(flush);
+      try {
+        return !response.processRequest();
+      } catch (exception &_) {
+        // Errors are handled by the event loop, which processes the request again
+        return true;
+      }
+    }
+
+    // When resuming, reset the request
+    void await_resume() const {
+      response.clearWriteRequest();
+    }
+  };
+
+  /**
+   * Abstract external response interface defining members used to manipulate the Response object
+   */
+  class Response {
+  public:
+    /**
+     * Set HTTP status code (e.g. 200)
+     */
+    virtual Response& setStatusCode(uint newstatuscode) = 0;
+    
+    /**
+     * Set HTTP status reason (e.g. OK)
+     */
+    virtual Response& setStatusReason(string newstatusreason) = 0;
+
+    /**
+     * Set Content-Type header
+     */
+    virtual Response& setContentType(string newcontenttype) = 0;
+
+    /**
+     * Set Date header to the response
+     */
+    virtual Response& setDate(chrono::system_clock::time_point newdate) = 0;
+
+    /**
+     * Set header to the response
+     */
+    virtual Response& setHeader(string key, string newvalue) = 0;
+
+    /**
+     * Set Body to the response
+     */
+    virtual Response& setBody(string newbody) = 0;
+
+    /**
+     * Append data to the Body of the response
+     */
+    virtual Response& appendBody(string appendbody) = 0;
+
+    /**
+     * Send a file (or the range starting at offset with the given length) as body of the response
+     *
+     * The file is sent from the page cache straight to the socket (sendfile), it is never copied
+     * to user space. Opened files are cached per event loop. Content-Length and Last-Modified are set,
+     * the body set before is replaced (setBody() / appendBody() replace the file again).
+     * The range is capped to the end of the file. Files cannot be sent on streamed responses.
+     *
+     * Returns false with errno set if the file cannot be opened, is no regular file
+     * or if the offset exceeds the file size
+     */
+    virtual bool sendFile(string path, size_t offset=0, size_t length=string::npos) = 0;
+
+    /**
+     * Write data to the streamed body of the response
+     *
+     * The first write sends the head with Transfer-Encoding chunked (Content-Length is dropped),
+     * every write is queued as one chunk. Data set by setBody() / appendBody() is sent as last chunk
+     * after the handler returned.
+     *
+     * This function will return an awaitable, which blocks while the queued data exceeds
+     * the maxResponseQueueSize and the socket is not ready to send it.
+     *
+     * Use this function inside a coroutine like this: "co_await res.write(data);"
+     */
+    virtual ResponseWriter write(span<const char> data) = 0;
+
+    /**
+     * Flush the streamed body of the response
+     *
+     * This function will return an awaitable, which blocks until all queued data is sent.
+     *
+     * Use this function inside a coroutine like this: "co_await res.flush();"
+     */
+    virtual ResponseWriter flush() = 0;
+  };
+} // namespace SimpleHTTP
+
+
+namespace SimpleHTTP::internal {
+
+  /**
+   * Response objects internal derivate, implementing members of the internal and external interfaces
+   */
+  class ResponseImpl : public SimpleHTTP::Response, public SimpleHTTP::internal::ResponseInternal {
+  public:
+    /**
+     * Initialize response with default headers
+     *
+     * Headers are allocated on the arena (or on the heap if no arena is provided)
+     */
+    ResponseImpl(helper::Arena* arena=nullptr) : headers({
+      {"Content-Length", "0"},
+      {"Content-Type", "text/plain"}, 
+      {"Server", "simplehttp"}
+    }, 0, helper::ArenaAllocator<pair<const string, string>>(arena)) {}
+    
+    /**
+     * Get HTTP version (e.g. HTTP/1.1)
+     */
+    string getVersion() const noexcept override {
+      return version;
+    }
+
+    /**
+     * Get HTTP status code (e.g. 200)
+     */
+    uint getStatusCode() const noexcept override {
+      return statusCode;
+    }
+
+    /**
+     * Get HTTP status reason (e.g. OK)
+     */
+    string getStatusReason() const noexcept override {
+      return statusReason;
+    }
+
+    /**
+     * Get Content-Type header
+     *
+     * If no valid content-type is set, nullopt is returned
+     */
+    optional<string> getContentType() override {
+      auto it = headers.find("Content-Type");
+      if (it != headers.end()) {
+        return it->second;
+      } else
+        return nullopt;
+    }
+
+    /**
+     * Get Date header as time_point from response
+     *
+     * If no valid date is set, nullopt is returned
+     */
+    optional<chrono::system_clock::time_point> getDate() override {
+      auto it = headers.find("Date");
+      if (it == headers.end()) {
+        return nullopt;
+      }
+
+      // Create input stream to parse the time
+      istringstream iss(it->second);
+      tm date_tm = {};
+      // Parse from IMF_fixdate
+      iss >> get_time(&date_tm, "%a, %d %b %Y %H:%M:%S");
+
+      if (iss.fail()) {
+        // If it fails return nullopt
+        return nullopt;
+      } else {
+        // If succeeded, convert to time_t and the time_t to a time_point
+        return chrono::system_clock::from_time_t(mktime(&date_tm));
+      }
+    }
+
+    /**
+     * Get header from the response
+     */
+    helper::ArenaMap<string, string>& getHeaders() override {
+      return headers;
+    }
+
+    /**
+     * Get header to the response
+     *
+     * If header is not present, nullopt is returned
+     */
+    optional<string> getHeader(string key) override {
+      auto it = headers.find(key);
+      if (it != headers.end()) {
+        return it->second;
+      } else
+        return nullopt;
+    }
+
+    /**
+     * Get body from the response
+     */
+    string getBody() override {
+      return body;
+    }
+
+    /**
+     * Move body out of the response
+     *
+     * Afterwards the body of the response is empty
+     */
+    string takeBody() override {
+      return std::move(body);
+    }
+
+    /**
+     * Move the file range set by sendFile() out of the response
+     *
+     * Returns nullopt if the body is not sent from a file
+     */
+    optional<helper::FileRange> takeFile() override {
+      return exchange(file, nullopt);
+    }
+
+    /**
+     * Serialize status line and headers (including the terminating empty line)
+     *
+     * If no Date header is set, the cached date of the current thread is used
+     */
+    string serializeHead() override {
+      string statusCodeStr = to_string(statusCode);
+      // Use the cached date, unless the date was explicitly set
+      const string *cachedDate = headers.contains("Date") ? nullptr : &helper::DateCache::Get();
+
+      // Calculate head size to allocate the head at once
+      size_t headSize = version.size() + statusCodeStr.size() + statusReason.size() + 4 + 2;
+      for (auto &header : headers) {
+        headSize += header.first.size() + header.second.size() + 4;
+      }
+      if (cachedDate) headSize += cachedDate->size() + 8;
+
+      // Append status line
+      string head;
+      head.reserve(headSize);
+      head.append(version).append(" ").append(statusCodeStr).append(" ").append(statusReason).append("\r\n");
+
+      // Iterate over all headers and append them
+      for (auto &header : headers) {
+        // Skip empty headers
+        if (header.second.empty()) {
+          continue;
+        }
+        // Append header to the head
+        head.append(header.first).append(": ").append(header.second).append("\r\n");
+      }
+      if (cachedDate) head.append("Date: ").append(*cachedDate).append("\r\n");
+      // Append empty line terminating the head
+      head.append("\r\n");
+      return head;
+    }
+
+    /**
+     * Attach the connection the response is streamed to
+     *
+     * Written data is queued to the queue, which is sent to the socket
+     * once it exceeds maxQueueSize (or if it is flushed)
      */
-    virtual Response& setDate(chrono::system_clock::time_point newdate) = 0;
+    void attachConnection(helper::Socket* newsocket, helper::SendQueue* newqueue, size_t newmaxqueuesize) override {
+      socket = newsocket;
+      queue = newqueue;
+      maxQueueSize = newmaxqueuesize;
+    }
+
+    /**
+     * Returns whether the response is streamed (head was queued by write() / flush())
+     */
+    bool isStreaming() override {
+      return streaming;
+    }
+
+    /**
+     * Terminates the streamed body
+     *
+     * The remaining body (set by setBody() / appendBody()) is queued as last chunk
+     */
+    void finishStream() override {
+      if (!body.empty()) {
+        queue->push(helper::EncodeChunk(body));
+        body.clear();
+      }
+      // Queue last chunk (without trailer)
+      queue->push("0\r\n\r\n");
+    }
+
+    /**
+     * Set write request to the response
+     */
+    void setWriteRequest(bool flush) override {
+      request = flush;
+    }
+
+    /**
+     * Clear write request from the response
+     */
+    void clearWriteRequest() override {
+      request = nullopt;
+    }
+
+    /**
+     * Returns whether a write request is pending
+     */
+    bool hasWriteRequest() override {
+      return request.has_value();
+    }
+
+    /**
+     * Process the write request
+     *
+     * Queued data is only sent if it exceeds the maxQueueSize or if it is flushed,
+     * so that small writes are coalesced (the event loop sends the rest once the handler suspends).
+     *
+     * Returns true if the request is completed
+     *
+     * Returns false if the socket blocks
+     *
+     * Throws a runtime_error if the underlying connection fails
+     */
+    bool processRequest() override {
+      bool flush = request.value_or(false);
+      while (!queue->empty()) {
+        if (!flush && queue->size() < maxQueueSize) {
+          return true;
+        }
+        ssize_t n = helper::SendQueued(*socket, *queue, maxQueueSize);
+        if (n < 1) {
+          if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            // If the call block give the control to the event loop
+            // The event loop will then continue execution if the socket is writable
+            return false;
+          } else {
+            // Throw exception. The eventloop will close and cleanup the tcp connection
+            throw runtime_error(strerror(errno));
+          }
+        }
+        queue->consume(n);
+      }
+      return true;
+    }
+
+    /**
+     * Write data to the streamed body of the response
+     *
+     * The first write sends the head with Transfer-Encoding chunked (Content-Length is dropped),
+     * every write is queued as one chunk. Data set by setBody() / appendBody() is sent as last chunk
+     * after the handler returned.
+     *
+     * This function will return an awaitable, which blocks while the queued data exceeds
+     * the maxResponseQueueSize and the socket is not ready to send it.
+     *
+     * Use this function inside a coroutine like this: "co_await res.write(data);"
+     */
+    ResponseWriter write(span<const char> data) override {
+      startStream();
+      // Empty chunks are skipped, as they would terminate the body
+      if (!data.empty()) {
+        queue->push(helper::EncodeChunk(string_view(data.data(), data.size())));
+      }
+      return ResponseWriter{*this, false};
+    }
+
+    /**
+     * Flush the streamed body of the response
+     *
+     * This function will return an awaitable, which blocks until all queued data is sent.
+     *
+     * Use this function inside a coroutine like this: "co_await res.flush();"
+     */
+    ResponseWriter flush() override {
+      startStream();
+      return ResponseWriter{*this, true};
+    }
+
+    /**
+     * Set HTTP status code (e.g. 200)
+     */
+    ResponseImpl& setStatusCode(uint newstatuscode) override {
+      statusCode = newstatuscode;
+      return *this;
+    }
+    
+    /**
+     * Set HTTP status reason (e.g. OK)
+     */
+    ResponseImpl& setStatusReason(string newstatusreason) override {
+      statusReason = newstatusreason;
+      return *this;
+    }
+
+    /**
+     * Set Content-Type header
+     */
+    ResponseImpl& setContentType(string newcontenttype) override {
+      headers["Content-Type"] = newcontenttype;
+      return *this;
+    }
+
+    /**
+     * Set Date header to the response
+     */
+    ResponseImpl& setDate(chrono::system_clock::time_point newdate) override {
+      // Convert to time_t
+      time_t newdate_t = chrono::system_clock::to_time_t(newdate);
+      // Convert to GMT
+      tm newdate_tm = *gmtime(&newdate_t);
+
+      ostringstream oss;
+      // Parse to the IMF_fixdate format
+      oss << put_time(&newdate_tm, "%a, %d %b %Y %H:%M:%S GMT");
+      headers["Date"] = oss.str();
+      return *this;
+    }
 
     /**
      * Set header to the response
      */
-    virtual Response& setHeader(string key, string newvalue) = 0;
+    ResponseImpl& setHeader(string key, string newvalue) override {
+      headers[key] = newvalue;
+      return *this;
+    }
 
     /**
      * Set Body to the response
      */
-    virtual Response& setBody(string newbody) = 0;
+    ResponseImpl& setBody(string newbody) override {
+      body = std::move(newbody);
+      file = nullopt;
+      headers["Content-Length"] = to_string(body.length());
+      return *this;
+    }
 
     /**
      * Append data to the Body of the response
      */
-    virtual Response& appendBody(string appendbody) = 0;
+    ResponseImpl& appendBody(string appendbody) override {
+      body += appendbody;
+      file = nullopt;
+      headers["Content-Length"] = to_string(body.length());
+      return *this;
+    }
+
+    /**
+     * Send a file (or the range starting at offset with the given length) as body of the response
+     *
+     * The file is sent from the page cache straight to the socket (sendfile), it is never copied
+     * to user space. Opened files are cached per event loop. Content-Length and Last-Modified are set,
+     * the body set before is replaced (setBody() / appendBody() replace the file again).
+     * The range is capped to the end of the file. Files cannot be sent on streamed responses.
+     *
+     * Returns false with errno set if the file cannot be opened, is no regular file
+     * or if the offset exceeds the file size
+     *
+     * Throws a logic_error if the response is streamed
+     */
+    bool sendFile(string path, size_t offset=0, size_t length=string::npos) override {
+      if (streaming) {
+        throw logic_error("Attempt to send a file on a streamed response");
+      }
+      auto opened = helper::FileCache::Open(path);
+      if (!opened) return false;
+      if (offset > opened->size) {
+        errno = EINVAL;
+        return false;
+      }
+      length = min(length, opened->size - offset);
+      body.clear();
+      headers["Content-Length"] = to_string(length);
+      headers["Last-Modified"] = helper::FormatHttpDate(opened->modified);
+      file = helper::FileRange{std::move(opened), off_t(offset), length};
+      return true;
+    }
+    
+  private:
+    // HTTP Version, constant as simpleHTTP only supports HTTP/1.1
+    string version = "HTTP/1.1";
+    // HTTP Status code, default is 200
+    uint statusCode = 200;
+    // HTTP Status reason, default is OK
+    string statusReason = "OK";
+    // HTTP headers, default headers are defined (see constructor)
+    helper::ArenaMap<string, string> headers;
+    // Body represented as string
+    string body = "";
+    // File range sent as body instead of the string body (see sendFile())
+    optional<helper::FileRange> file;
+    // Socket the response is streamed to
+    helper::Socket* socket = nullptr;
+    // Queue the response is streamed to
+    helper::SendQueue* queue = nullptr;
+    // Size of queued data, after which written data is sent
+    size_t maxQueueSize = 0;
+    // Determines if the head was queued and the body is streamed
+    bool streaming = false;
+    // Current pending write request (true if it is a flush)
+    optional<bool> request;
+
+    /**
+     * Queues the head with Transfer-Encoding chunked, if the stream is not started yet
+     *
+     * Throws a logic_error if the response is not attached to a connection
+     */
+    void startStream() {
+      if (streaming) return;
+      if (!queue) {
+        throw logic_error("Attempt to stream a response without connection");
+      }
+      if (file) {
+        throw logic_error("Attempt to stream a response with a file body");
+      }
+      headers.erase("Content-Length");
+      headers["Transfer-Encoding"] = "chunked";
+      queue->push(serializeHead());
+      streaming = true;
+    }
   };
-} // namespace SimpleHTTP
+} // namespace SimpleHTTP::internal
+
 
 
 namespace SimpleHTTP::internal {
 
   /**
-   * Response objects internal derivate, implementing members of the internal and external interfaces
+   * Deserializes the head at the start of data into request
+   *
+   * The data is scanned in place for the end of the head (empty line) using the SIMD delimiter
+   * scan (see helper::FindByte()). Once it's found, the head is handed to the request and method,
+   * path, version and header fields are parsed as views into it.
+   *
+   * Returns the size of the head if the full header is deserialized
+   * Returns 0 if it needs more data to fully deserialize
+   * Parsing errors (or a head exceeding maxHeaderSize) will lead to an exception
    */
-  class ResponseImpl : public SimpleHTTP::Response, public SimpleHTTP::internal::ResponseInternal {
-  public:
-    
+  inline size_t deserializeRequest(string_view data, RequestInternal &request, size_t maxHeaderSize) {
+
+    // Search the empty line terminating the head (carriage returns are optional)
+    size_t headEnd = helper::FindHeadEnd(data);
+    // Check if head exceeds maxHeaderSize, regardless of whether it's complete.
+    // Body parts in the buffer don't affect the count, as they are located after headEnd.
+    if ((headEnd==string_view::npos ? data.size() : headEnd) > maxHeaderSize) {
+      throw runtime_error("Header size exceeds defined maximum size");
+    }
+    // If the head is incomplete; more data is required
+    if (headEnd==string_view::npos) return false;
+
+    // Hand the head (including its last character) to the request
+    string_view head = request.setHead(string(data.substr(0, headEnd+1)));
+
+    // Returns the next line of the head without line terminator
+    size_t lineStart = 0;
+    auto nextLine = [&]() {
+      size_t lineEnd = helper::FindByte(head, lineStart, '\n');
+      string_view line = head.substr(lineStart, lineEnd-lineStart);
+      lineStart = lineEnd+1;
+      if (!line.empty() && line.back()=='\r') line.remove_suffix(1);
+      return line;
+    };
+
+    // Parse request line (method, path, version)
+    string_view requestLine = nextLine();
+    auto methodEnd = requestLine.find(' ');
+    auto pathEnd = methodEnd==string_view::npos ? methodEnd : requestLine.find(' ', methodEnd+1);
+    if (pathEnd==string_view::npos) {
+      throw runtime_error("Expected method, path and version in request line");
+    }
+    request.setMethod(requestLine.substr(0, methodEnd));
+    request.setPath(requestLine.substr(methodEnd+1, pathEnd-methodEnd-1));
+    request.setVersion(requestLine.substr(pathEnd+1));
+
+    // Parse header fields until the empty line
+    while (1) {
+      string_view line = nextLine();
+      if (line.empty()) return headEnd+1;
+
+      // Read until key value delimiter
+      auto colonPos = helper::FindByte(line, 0, ':');
+      if (colonPos==string_view::npos) {
+        throw runtime_error("Expected colon (':') in header field");
+      }
+      // Expect ' ' after ':'
+      if (colonPos+1 >= line.size() || line[colonPos+1]!=' ') {
+        throw runtime_error(
+          "Expected space (' ') character after colon (':'). Got " +
+          (colonPos+1 < line.size() ? to_string(line[colonPos+1]) : string("end of line"))
+        );
+      }
+      request.addHeader(line.substr(0, colonPos), line.substr(colonPos+2));
+    }
+  }
+
+  /**
+   * Deserializes buffer into request (see deserializeRequest() above)
+   *
+   * The buffer cursor is set to the last character of the head.
+   *
+   * Returns true if the full header is deserialized
+   * Returns false if it needs more data to fully deserialize
+   */
+  inline bool deserializeRequest(helper::Buffer &buffer, RequestInternal &request, size_t maxHeaderSize) {
+    size_t headSize = deserializeRequest(buffer.view(), request, maxHeaderSize);
+    if (headSize==0) return false;
+    buffer.set(headSize-1);
+    return true;
+  }
+
+  /**
+   * Serializes response and appends it to the queue
+   *
+   * Status line and headers are serialized into one head segment,
+   * the body is moved out of the response into a separate segment without copying it
+   * (or the file range is queued, if the body is sent from a file).
+   */
+  inline void serializeResponse(ResponseInternal &response, helper::SendQueue &queue) {
+    queue.push(response.serializeHead());
+    if (auto file = response.takeFile()) {
+      queue.push(std::move(file.value()));
+    } else {
+      queue.push(response.takeBody());
+    }
+  }
+} // namespace SimpleHTTP::internal
+
+
+
+namespace SimpleHTTP::internal {
+
+  /**
+   * Function handling the requests of a route (stored without heap allocation)
+   *
+   * 64 bytes fit lambdas capturing a few references or a string (std::function heap allocates above 16 bytes).
+   * Larger callables are wrapped in a std::function by Server::Route(), which costs a heap allocation
+   * when the route is registered and a second indirect call per request.
+   * Calling is on par with std::function (bench/dispatch_bench.cpp: ~11 cycles for a plain handler,
+   * ~50-55 cycles including the coroutine frame, both within 1 cycle of std::function),
+   * so the gain is the handler state living in the route tree instead of a separate allocation.
+   */
+  using RouteFunction = helper::InplaceFunction<Task<bool>(Request&, Body&, Response&), 64>;
+
+  /**
+   * Metrics recorded for one route and method on one event loop
+   */
+  struct RouteMetrics {
+    // Handled requests by status class (1xx - 5xx)
+    helper::LocalCounter requests[5];
+    // Received bytes (request head and body)
+    helper::LocalCounter bytesIn;
+    // Sent bytes (response head and body)
+    helper::LocalCounter bytesOut;
+    // Time from accepting the connection until the first byte of its first request
+    helper::LatencyHistogram firstByte;
+    // Time from the first byte of the request until its head is parsed
+    helper::LatencyHistogram parse;
+    // Time from the parsed head until the response is queued (includes reading the body)
+    helper::LatencyHistogram handler;
+    // Time from queueing the response until it is fully sent
+    helper::LatencyHistogram send;
+  };
+
+  /**
+   * Metrics recorded by one event loop
+   *
+   * Every loop records into its own object without locks, the metrics endpoint sums up all loops.
+   */
+  struct LoopMetrics {
+    LoopMetrics(size_t routeCount) : routeCount(routeCount), routes(make_unique<RouteMetrics[]>(routeCount)) {}
+
     /**
-     * Get HTTP version (e.g. HTTP/1.1)
+     * Get metrics of the route (routes registered after the loop was started are recorded as unmatched)
      */
-    string getVersion() const noexcept override {
-      return version;
+    RouteMetrics& Route(size_t index) {
+      return routes[index < routeCount ? index : 0];
     }
 
+    // Number of routes
+    size_t routeCount;
+    // Metrics per route and method (indexed by the metrics index of the route, 0 holds unmatched requests)
+    unique_ptr<RouteMetrics[]> routes;
+    // Currently open connections
+    helper::LocalCounter openConnections;
+    // Accepted connections
+    helper::LocalCounter acceptedConnections;
+    // Wakeups of the loop (returns from epoll_wait / io_uring_enter)
+    helper::LocalCounter wakeups;
+    // Handled events (epoll events / completions)
+    helper::LocalCounter events;
+  };
+
+  /**
+   * Metrics state of a connection
+   */
+  struct ConnectionMetrics {
     /**
-     * Get HTTP status code (e.g. 200)
+     * Response queued but not fully sent yet
      */
-    uint getStatusCode() const noexcept override {
-      return statusCode;
+    struct PendingSend {
+      // Sent bytes of the socket after which the response is fully sent
+      uint64_t end;
+      // Metrics index of the route
+      size_t route;
+      // Time the response was queued
+      chrono::steady_clock::time_point queued;
+    };
+
+    // Metrics of the loop (nullptr if metrics are disabled)
+    LoopMetrics* loop = nullptr;
+    // Time the connection was accepted (reset once the first request is recorded)
+    chrono::steady_clock::time_point accepted;
+    // Time the first byte of the current request was processed
+    chrono::steady_clock::time_point requestStart;
+    // Time the head of the current request was parsed
+    chrono::steady_clock::time_point headParsed;
+    // Metrics index of the route of the current request
+    size_t route = 0;
+    // Received bytes of the socket before the current request started
+    uint64_t requestOffset = 0;
+    // Sent bytes of the socket after which the last queued response ends
+    uint64_t queuedEnd = 0;
+    // Responses queued but not fully sent yet (from sendsDone on)
+    vector<PendingSend> sends;
+    size_t sendsDone = 0;
+
+    /**
+     * Resets the request specific metrics for the next request on the connection
+     */
+    void NextRequest(uint64_t offset) {
+      requestStart = {};
+      headParsed = {};
+      route = 0;
+      requestOffset = offset;
     }
 
     /**
-     * Get HTTP status reason (e.g. OK)
+     * Resets the metrics for the next connection, the storage of the pending sends is kept
      */
-    string getStatusReason() const noexcept override {
-      return statusReason;
+    void Clear() {
+      loop = nullptr;
+      accepted = {};
+      NextRequest(0);
+      queuedEnd = 0;
+      sends.clear();
+      sendsDone = 0;
+    }
+  };
+
+  
+  /**
+   * Stage defines various stages for a http connection
+   */
+  enum Stage {
+    REQ, // Request must be handled
+    RES, // Queued responses must be sent, then the connection is closed
+    CLEANUP, // Connection must be cleaned up for reuse
+    FUNC_INIT, // User defined function must be initialized
+    FUNC_PROC, // User defined function must be processed
+    FUNC_BODY, // Function blocks and body must be handled
+    FUNC_RES, // Function blocks and streamed response must be sent
+    FUNC_WAIT, // Function waits on an event outside of the connection (e.g. offloaded work, a sleep or another fd)
+  };
+
+  /**
+   * WaitState defines the state of a function waiting on an event outside of the connection
+   */
+  enum class WaitState {
+    NONE, // Function does not wait
+    PENDING, // Function waits until the event occurs
+    READY, // Event occured, function must be resumed
+    EXPIRED, // Timeout of the wait expired before the event occured (see withTimeout())
+  };
+    
+  /**
+   * ConnectionState holds the state of a http connection
+   */
+  struct ConnectionState {
+    // Connection socket
+    helper::Socket fd;
+    // Unique id of the connection inside its loop (used to identify timers)
+    uint64_t id;
+    // Connection stage
+    Stage stage;
+    // Request buffer
+    helper::Buffer reqBuffer;
+    // Response queue (serialized responses queued for sending)
+    helper::SendQueue resQueue;
+    // Arena holding the objects of the current request (reset on cleanup)
+    // Declared before those objects, so that it is destroyed after them
+    // (the state must therefore not be move-assigned while those objects are alive)
+    unique_ptr<helper::Arena> arena = make_unique<helper::Arena>();
+    // Request Implementation object
+    helper::ArenaPtr<RequestImpl> request = arena->New<RequestImpl>(arena.get());
+    // Body object (default initialized to nullptr as there is no default constructor)
+    helper::ArenaPtr<BodyImpl> body = nullptr;
+    // Response Implementation object
+    helper::ArenaPtr<ResponseImpl> response = arena->New<ResponseImpl>(arena.get());
+    // Coroutine (function) frame
+    Task<bool> funcHandle;
+    // Timeout when the connection is killed
+    chrono::steady_clock::time_point expirationTime;
+    // Event interest registered on the epoll instance
+    uint32_t events = 0;
+    // Readiness reported by edge triggered events (EPOLLIN / EPOLLOUT), cleared once the socket blocks
+    uint32_t readiness = 0;
+    // Determines if input processing is paused until queued responses are sent
+    bool inputPaused = false;
+    // State of the function waiting in FUNC_WAIT (set by the awaitable suspending the function)
+    WaitState wait = WaitState::NONE;
+    // Id of the current wait (identifies wakeups and timers of the wait)
+    uint64_t waitId = 0;
+    // Id of the timeout timer of the current wait (0 if the wait has no timeout)
+    uint64_t timeoutId = 0;
+    // Determines if the last wait expired (set once the wait is consumed, read by withTimeout())
+    bool waitExpired = false;
+    // Time after which the connection is closed if its function still waits (see ServerConfiguration::waitTimeout)
+    chrono::steady_clock::time_point waitDeadline;
+    // Metrics state (only recorded if metrics are enabled)
+    ConnectionMetrics metrics;
+
+    /**
+     * Destroys the objects of the current request and resets their arena
+     */
+    void ResetRequest() {
+      funcHandle = Task<bool>();
+      body.reset();
+      request.reset();
+      response.reset();
+      arena->Reset();
     }
 
     /**
-     * Get Content-Type header
+     * Creates the request and response objects of the next request on the arena
      *
-     * If no valid content-type is set, nullopt is returned
-     */
-    optional<string> getContentType() override {
-      auto it = headers.find("Content-Type");
-      if (it != headers.end()) {
-        return it->second;
-      } else
-        return nullopt;
+     * The objects of the previous request must be destroyed before (see ResetRequest())
+     */
+    void CreateRequest() {
+      request = arena->New<RequestImpl>(arena.get());
+      response = arena->New<ResponseImpl>(arena.get());
     }
 
     /**
-     * Get Date header as time_point from response
+     * Closes the socket and resets the state for the next connection
      *
-     * If no valid date is set, nullopt is returned
-     */
-    optional<chrono::system_clock::time_point> getDate() override {
-      auto it = headers.find("Date");
-      if (it == headers.end()) {
-        return nullopt;
-      }
+     * The containers (reqBuffer, resQueue, metrics) are cleared but keep their storage
+     * and the arena is reset, so that the next connection does not allocate them again.
+     */
+    void Clear() {
+      ResetRequest();
+      fd = helper::Socket();
+      id = 0;
+      stage = Stage::REQ;
+      reqBuffer.clear();
+      resQueue.clear();
+      CreateRequest();
+      expirationTime = {};
+      events = 0;
+      readiness = 0;
+      inputPaused = false;
+      wait = WaitState::NONE;
+      waitId = 0;
+      timeoutId = 0;
+      waitExpired = false;
+      waitDeadline = {};
+      metrics.Clear();
+    }
+  };
 
-      // Create input stream to parse the time
-      istringstream iss(it->second);
-      tm date_tm = {};
-      // Parse from IMF_fixdate
-      iss >> get_time(&date_tm, "%a, %d %b %Y %H:%M:%S");
+  /**
+   * ConnectionSlab holds the connection states of one loop indexed by their filedescriptor
+   *
+   * Slots are allocated in pages of fixed size, so that their address remains valid while the slab grows
+   * and can be registered as epoll_event.data.ptr. Once allocated, slots are recycled: releasing a slot
+   * closes the connection and increments its generation, which identifies operations of former connections.
+   * The state of a slot is constructed by its first connection and kept after it is released, its containers
+   * (request buffer, response queue, arena, metrics) are cleared and reused by the next connection of the slot.
+   * Therefore accepting / closing connections does not allocate the connection state again.
+   */
+  class ConnectionSlab {
+  public:
+    /**
+     * Slot holding the state of one filedescriptor
+     */
+    struct Slot {
+      // Connection state (nullopt until the first connection of the slot, kept once it is released)
+      optional<ConnectionState> state;
+      // Determines if the state holds an open connection
+      bool open = false;
+      // Generation of the slot (incremented whenever the state is released)
+      uint32_t generation = 0;
+    };
 
-      if (iss.fail()) {
-        // If it fails return nullopt
-        return nullopt;
-      } else {
-        // If succeeded, convert to time_t and the time_t to a time_point
-        return chrono::system_clock::from_time_t(mktime(&date_tm));
+    /**
+     * Get the slot of the filedescriptor, the slab is grown if required
+     */
+    Slot& Get(int fd) {
+      size_t page = size_t(fd) / pageSize;
+      while (pages.size() <= page) {
+        pages.push_back(make_unique<Slot[]>(pageSize));
       }
+      return pages[page][size_t(fd) % pageSize];
     }
 
     /**
-     * Get header from the response
+     * Find the connection state of the filedescriptor
+     *
+     * Returns nullptr if the slot is free
      */
-    unordered_map<string, string>& getHeaders() override {
-      return headers;
+    ConnectionState* Find(int fd) {
+      size_t page = size_t(fd) / pageSize;
+      if (fd < 0 || page >= pages.size()) return nullptr;
+      auto &slot = pages[page][size_t(fd) % pageSize];
+      return slot.open ? &slot.state.value() : nullptr;
     }
 
     /**
-     * Get header to the response
+     * Find the connection state of the filedescriptor if the slot has the specified generation
      *
-     * If header is not present, nullopt is returned
+     * Returns nullptr if the slot is free or holds another connection
      */
-    optional<string> getHeader(string key) override {
-      auto it = headers.find(key);
-      if (it != headers.end()) {
-        return it->second;
-      } else
-        return nullopt;
+    ConnectionState* Find(int fd, uint32_t generation) {
+      auto *state = Find(fd);
+      if (!state || pages[size_t(fd) / pageSize][size_t(fd) % pageSize].generation != generation) return nullptr;
+      return state;
     }
 
     /**
-     * Get body from the response
-     */
-    string getBody() override {
-      return body;
+     * Opens a connection for the socket in the slot of its filedescriptor
+     *
+     * The state released by the former connection of the slot is reused, only the first connection
+     * of a slot constructs it. The remaining fields of the state (e.g. id, expiration time)
+     * are set by the caller.
+     */
+    Slot& Open(helper::Socket&& socket) {
+      auto &slot = Get(socket.getfd());
+      if (slot.open) Release(slot);
+      if (!slot.state) slot.state.emplace();
+      slot.state.value().fd = std::move(socket);
+      slot.open = true;
+      count++;
+      return slot;
     }
 
     /**
-     * Set HTTP status code (e.g. 200)
+     * Closes the connection of the slot and keeps its cleared state for the next connection
      */
-    ResponseImpl& setStatusCode(uint newstatuscode) override {
-      statusCode = newstatuscode;
-      return *this;
+    void Release(Slot& slot) {
+      slot.state.value().Clear();
+      slot.open = false;
+      slot.generation++;
+      count--;
     }
-    
+
     /**
-     * Set HTTP status reason (e.g. OK)
+     * Get number of stored connection states
      */
-    ResponseImpl& setStatusReason(string newstatusreason) override {
-      statusReason = newstatusreason;
-      return *this;
+    size_t Size() const noexcept {
+      return count;
     }
 
+  private:
+    // Number of slots per page
+    static constexpr size_t pageSize = 256;
+    // Pages of slots (page n holds the filedescriptors [n*pageSize, (n+1)*pageSize))
+    vector<unique_ptr<Slot[]>> pages;
+    // Number of stored connection states
+    size_t count = 0;
+  };
+
+  /**
+   * LoopState holds the state of one event loop
+   *
+   * Every event loop runs on its own thread and owns its event instance (epoll or io_uring) and connections,
+   * therefore the LoopState is never accessed by more than one thread.
+   */
+  struct LoopState {
+    // Core bsd socket owned by this loop (only set if the loop uses a dedicated SO_REUSEPORT socket)
+    helper::FileDescriptor ownedSocket;
+    // Filedescriptor of the core socket the loop accepts connections from
+    int coreSockfd = -1;
+    // Epoll event instance (responsible for event infrastructure)
+    helper::FileDescriptor epollInstance;
+    // Epoll instance holding the filedescriptors awaited by functions (see waitReadable())
+    // Attached to the event instance of the loop, declared before the connections,
+    // so that waiting functions can unregister their filedescriptors when they are destroyed
+    helper::FileDescriptor watchInstance;
+    // Slab holding connection state
+    // Slots are indexed by the filedescriptor number of the socket
+    // and contain a ConnectionState object with information about the connection
+    // including a FileDescriptor resource
+    //
+    // If the slab is destructed (e.g. error is thrown),
+    // all sockets are closed automatically due to the RAII compatible FileDescriptor in the ConnectionState
+    ConnectionSlab connections;
+    // Timer wheel holding the expiration timers of the connections
+    helper::TimerWheel timerWheel;
+    // Id assigned to the next connection
+    uint64_t nextConnectionId = 0;
+    // Metrics recorded by this loop (nullptr if metrics are disabled)
+    LoopMetrics* metrics = nullptr;
+    // Queue of connections woken up by other threads (shared with the jobs that post to it)
+    shared_ptr<helper::WakeQueue> wakeQueue;
+    // Timer wheel holding the timers of waiting functions (sleeps and timeouts)
+    helper::TimerWheel waitTimers;
+    // Id assigned to the next wait or timer of a waiting function (unique inside the loop, 0 is never assigned)
+    uint64_t nextWaitId = 1;
+    // Io_uring instance (only set if the loop uses the io_uring backend)
+    // Declared last, so that the ring is destructed before the connections it references
+    unique_ptr<helper::Uring> uring;
+  };
+
+  /**
+   * Context of the function resumed on the current thread
+   *
+   * Awaitables suspending the function on events outside of its connection (e.g. offload())
+   * use it to register the wakeup of the connection on its loop.
+   */
+  struct FunctionContext {
+    // Loop running on the current thread (set when the loop is started)
+    static inline thread_local LoopState* loop = nullptr;
+    // Connection whose function is resumed (nullptr outside of functions)
+    static inline thread_local ConnectionState* state = nullptr;
+
+    /**
+     * Sets the resumed connection for the lifetime of the scope
+     */
+    class Scope {
+    public:
+      Scope(ConnectionState* resumed) : previous(state) { state = resumed; }
+      ~Scope() { state = previous; }
+      Scope(const Scope&) = delete;
+      Scope& operator=(const Scope&) = delete;
+    private:
+      // Connection restored when the scope ends
+      ConnectionState* previous;
+    };
+
     /**
-     * Set Content-Type header
+     * Returns the resumed connection
+     *
+     * Throws a logic_error if no function is resumed on the current thread
      */
-    ResponseImpl& setContentType(string newcontenttype) override {
-      headers["Content-Type"] = newcontenttype;
-      return *this;
+    static ConnectionState& Current() {
+      if (!state) {
+        throw logic_error("Attempt to wait on an event outside of a function resumed by the server");
+      }
+      return *state;
     }
 
     /**
-     * Set Date header to the response
+     * Suspends the function of the resumed connection in FUNC_WAIT
+     *
+     * Returns the id of the wait, the function is resumed once the wait is completed
+     * with this id (through the wake queue or the wait timers of the loop).
+     */
+    static uint64_t Wait() {
+      auto &current = Current();
+      current.wait = WaitState::PENDING;
+      current.waitId = loop->nextWaitId++;
+      return current.waitId;
+    }
+  };
+} // namespace SimpleHTTP::internal
+
+
+namespace SimpleHTTP {
+
+  /**
+   * Pool of worker threads executing work offloaded from functions (see offload())
+   *
+   * The pool runs a fixed number of threads, jobs submitted while all threads are busy are queued.
+   * It can be shared by multiple servers and must outlive the functions offloading work to it.
+   * On destruction, queued jobs are still executed before the threads are joined.
+   */
+  class ThreadPool {
+  public:
+    /**
+     * Launches the worker threads
+     *
+     * If threadCount is 0, one thread per available cpu core is launched.
+     * Throws a system_error if a thread cannot be launched
      */
-    ResponseImpl& setDate(chrono::system_clock::time_point newdate) override {
-      // Convert to time_t
-      time_t newdate_t = chrono::system_clock::to_time_t(newdate);
-      // Convert to GMT
-      tm newdate_tm = *gmtime(&newdate_t);
+    explicit ThreadPool(int threadCount=0) {
+      // hardware_concurrency() may return 0 if the value is not computable
+      if (threadCount < 1) threadCount = max(1u, thread::hardware_concurrency());
+      try {
+        for (int i = 0; i < threadCount; i++) {
+          workers.emplace_back([this]() { Work(); });
+        }
+      } catch (...) {
+        // If a thread cannot be launched, shut down the launched ones and rethrow
+        Shutdown();
+        throw;
+      }
+    }
 
-      ostringstream oss;
-      // Parse to the IMF_fixdate format
-      oss << put_time(&newdate_tm, "%a, %d %b %Y %H:%M:%S GMT");
-      headers["Date"] = oss.str();
-      return *this;
+    ~ThreadPool() {
+      Shutdown();
     }
 
+    // Workers reference the pool, therefore it must not be copied or moved
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
     /**
-     * Set header to the response
+     * Queues the job for execution on one of the worker threads
+     *
+     * Submit is thread-safe.
      */
-    ResponseImpl& setHeader(string key, string newvalue) override {
-      headers[key] = newvalue;
-      return *this;
+    void Submit(function<void()> job) {
+      {
+        lock_guard<mutex> lock(jobsMut);
+        jobs.push_back(std::move(job));
+      }
+      jobsCond.notify_one();
     }
 
+  private:
+    // Worker threads
+    vector<thread> workers;
+    // Mutex lock protecting the jobs and the stopping flag
+    mutex jobsMut;
+    // Signaled if jobs are queued or the pool is stopped
+    condition_variable jobsCond;
+    // Queued jobs
+    deque<function<void()>> jobs;
+    // Determines if the workers exit once the queue is empty
+    bool stopping = false;
+
     /**
-     * Set Body to the response
+     * Executes queued jobs until the pool is stopped
      */
-    ResponseImpl& setBody(string newbody) override {
-      body = newbody;
-      headers["Content-Length"] = to_string(body.length());
-      return *this;
+    void Work() {
+      while (1) {
+        function<void()> job;
+        {
+          unique_lock<mutex> lock(jobsMut);
+          jobsCond.wait(lock, [this]() { return stopping || !jobs.empty(); });
+          if (jobs.empty()) return;
+          job = std::move(jobs.front());
+          jobs.pop_front();
+        }
+        job();
+      }
     }
 
     /**
-     * Append data to the Body of the response
+     * Stops the workers once the queue is empty and joins them
      */
-    ResponseImpl& appendBody(string appendbody) override {
-      body += appendbody;
-      headers["Content-Length"] = to_string(body.length());
-      return *this;
+    void Shutdown() {
+      {
+        lock_guard<mutex> lock(jobsMut);
+        stopping = true;
+      }
+      jobsCond.notify_all();
+      for (auto &worker : workers) worker.join();
+      workers.clear();
     }
-    
+  };
+
+  /**
+   * Awaitable executing a callable on a thread pool (see offload())
+   */
+  template <typename F>
+  class OffloadAwaitable {
+  public:
+    // Result of the callable
+    using Result = invoke_result_t<F&>;
+    // Function waits in FUNC_WAIT (required by withTimeout())
+    static constexpr bool waitsOnLoop = true;
+
+    OffloadAwaitable(ThreadPool &pool, F fn) : pool(pool), job(make_shared<Job>(std::move(fn))) {}
+
+    bool await_ready() { return false; }
+
+    void await_suspend(coroutine_handle<>) {
+      // The function is resumed by the loop once the wait is posted to its wake queue
+      auto &state = internal::FunctionContext::Current();
+      uint64_t waitId = internal::FunctionContext::Wait();
+      // The job is shared with the worker, as the function may be destroyed before the job completed
+      // (e.g. if the connection is closed or the wait timed out). In this case the wakeup is ignored by the loop.
+      try {
+        pool.Submit([job = job, queue = internal::FunctionContext::loop->wakeQueue,
+                     fd = state.fd.getfd(), waitId]() {
+          try {
+            if constexpr (is_void_v<Result>) {
+              job->fn();
+              job->result.emplace();
+            } else {
+              job->result.emplace(job->fn());
+            }
+          } catch (...) {
+            job->exception = current_exception();
+          }
+          queue->Post(fd, waitId);
+        });
+      } catch (...) {
+        state.wait = internal::WaitState::NONE;
+        throw;
+      }
+    }
+
+    Result await_resume() {
+      // The results are visible, as the wake queue synchronizes the worker with the loop
+      if (job->exception) rethrow_exception(job->exception);
+      if constexpr (!is_void_v<Result>) return std::move(job->result.value());
+    }
+
   private:
-    // HTTP Version, constant as simpleHTTP only supports HTTP/1.1
-    string version = "HTTP/1.1";
-    // HTTP Status code, default is 200
-    uint statusCode = 200;
-    // HTTP Status reason, default is OK
-    string statusReason = "OK";
-    // HTTP headers, default headers are defined
-    unordered_map<string, string> headers = {
-      {"Content-Length", "0"},
-      {"Content-Type", "text/plain"}, 
-      {"Server", "simplehttp"}
+    /**
+     * State shared by the awaitable and the worker
+     */
+    struct Job {
+      // Offloaded callable
+      F fn;
+      // Result of the callable (monostate for void callables)
+      optional<conditional_t<is_void_v<Result>, monostate, Result>> result = nullopt;
+      // Exception thrown by the callable
+      exception_ptr exception = nullptr;
     };
-    // Body represented as string
-    string body = "";
+
+    // Pool executing the job
+    ThreadPool &pool;
+    // Shared job state
+    shared_ptr<Job> job;
   };
-} // namespace SimpleHTTP::internal
 
+  /**
+   * Executes fn on the thread pool without blocking the event loop
+   *
+   * Usage inside of a function: auto digest = co_await offload(pool, [data]() { return hash(data); });
+   *
+   * The function is suspended until fn returned and is then resumed on its event loop,
+   * which processes other connections in the meantime. The result of fn is returned by co_await,
+   * exceptions thrown by fn are rethrown inside of the function.
+   *
+   * fn may outlive the function (e.g. if the connection is closed while fn runs),
+   * therefore it should capture the data it works on by value.
+   */
+  template <typename F>
+  OffloadAwaitable<decay_t<F>> offload(ThreadPool &pool, F&& fn) {
+    return OffloadAwaitable<decay_t<F>>(pool, std::forward<F>(fn));
+  }
+
+  /**
+   * Awaitable suspending the function for a duration (see sleepFor())
+   */
+  class SleepAwaitable {
+  public:
+    // Function waits in FUNC_WAIT (required by withTimeout())
+    static constexpr bool waitsOnLoop = true;
+
+    SleepAwaitable(chrono::steady_clock::duration duration) : duration(duration) {}
 
+    bool await_ready() { return duration <= chrono::steady_clock::duration::zero(); }
 
-namespace SimpleHTTP::internal {
+    void await_suspend(coroutine_handle<>) {
+      // The wait is completed by its timer
+      auto &state = internal::FunctionContext::Current();
+      uint64_t waitId = internal::FunctionContext::Wait();
+      internal::FunctionContext::loop->waitTimers.Insert(
+        state.fd.getfd(), waitId, chrono::steady_clock::now() + duration
+      );
+    }
+
+    void await_resume() {}
+
+  private:
+    // Duration of the sleep
+    chrono::steady_clock::duration duration;
+  };
 
-  
   /**
-   * Stage defines various stages for a http connection
+   * Suspends the function for the duration without blocking the event loop
+   *
+   * Usage inside of a function: co_await sleepFor(chrono::milliseconds(100));
+   *
+   * The sleep is driven by the timers of the loop (resolution of 10ms), the function is resumed
+   * once the duration passed (never earlier). Sleeps longer then ServerConfiguration::waitTimeout close the connection.
    */
-  enum Stage {
-    REQ, // Request must be handled
-    RES, // Response must be handled
-    CLEANUP, // Connection must be cleaned up for reuse
-    FUNC_INIT, // User defined function must be initialized
-    FUNC_PROC, // User defined function must be processed
-    FUNC_BODY, // Function blocks and body must be handled
+  template <typename Rep, typename Period>
+  SleepAwaitable sleepFor(chrono::duration<Rep, Period> duration) {
+    return SleepAwaitable(chrono::ceil<chrono::steady_clock::duration>(duration));
+  }
+
+  /**
+   * Awaitable limiting the wait of another awaitable (see withTimeout())
+   */
+  template <typename A>
+  class TimeoutAwaitable {
+  public:
+    // Result of the awaitable
+    using Result = decltype(declval<A&>().await_resume());
+    TimeoutAwaitable(A awaitable, chrono::steady_clock::duration timeout)
+      : awaitable(std::move(awaitable)), timeout(timeout) {}
+
+    bool await_ready() { return awaitable.await_ready(); }
+
+    void await_suspend(coroutine_handle<> handle) {
+      // The awaitable suspends the function in FUNC_WAIT,
+      // the timer completes the same wait as expired if it fires first
+      awaitable.await_suspend(handle);
+      auto &state = internal::FunctionContext::Current();
+      state.timeoutId = internal::FunctionContext::loop->nextWaitId++;
+      internal::FunctionContext::loop->waitTimers.Insert(
+        state.fd.getfd(), state.timeoutId, chrono::steady_clock::now() + timeout
+      );
+      suspended = true;
+    }
+
+    auto await_resume() {
+      bool expired = false;
+      if (suspended) {
+        auto &state = internal::FunctionContext::Current();
+        expired = state.waitExpired;
+        // The timer is left in the wheel, it is ignored once the timeout is reset
+        state.timeoutId = 0;
+      }
+      if constexpr (is_void_v<Result>) {
+        if (!expired) awaitable.await_resume();
+        return !expired;
+      } else {
+        return expired ? nullopt : optional<Result>(awaitable.await_resume());
+      }
+    }
+
+  private:
+    // Awaitable whose wait is limited
+    A awaitable;
+    // Maximum duration of the wait
+    chrono::steady_clock::duration timeout;
+    // Determines if the function was suspended (the timer was registered)
+    bool suspended = false;
   };
-    
+
   /**
-   * ConnectionState holds the state of a http connection
+   * Waits on the awaitable for at most the duration
+   *
+   * Usage inside of a function: auto result = co_await withTimeout(offload(pool, fn), chrono::seconds(1));
+   *
+   * Supports the awaitables waiting on the event loop (offload(), sleepFor(), waitReadable(), waitWritable()).
+   * Returns an optional holding the result of the awaitable or nullopt if the timeout expired
+   * (awaitables without result return true if completed, false if the timeout expired).
+   *
+   * On expiration the wait is abandoned, the awaitable is not canceled (e.g. offloaded work still runs).
+   *
+   * Waits without timeout are still bounded by ServerConfiguration::waitTimeout, after which the connection
+   * is closed instead of resuming the function.
    */
-  struct ConnectionState {
-    // Socket descriptor
-    helper::FileDescriptor fd;
-    // Connection stage
-    Stage stage;
-    // Request buffer
-    helper::Buffer reqBuffer;
-    // Response buffer
-    helper::Buffer resBuffer;
-    // Request Implementation object
-    unique_ptr<RequestImpl> request = make_unique<RequestImpl>();
-    // Body object (default initialized to nullptr as there is no default constructor)
-    unique_ptr<BodyImpl> body = nullptr;
-    // Response Implementation object
-    unique_ptr<ResponseImpl> response = make_unique<ResponseImpl>();
-    // Coroutine (function) frame
-    Task<bool> funcHandle;
-    // Timeout when the connection is killed
-    chrono::system_clock::time_point expirationTime;
+  template <typename A, typename Rep, typename Period>
+    requires (decay_t<A>::waitsOnLoop)
+  TimeoutAwaitable<decay_t<A>> withTimeout(A&& awaitable, chrono::duration<Rep, Period> timeout) {
+    return TimeoutAwaitable<decay_t<A>>(
+      std::forward<A>(awaitable), chrono::ceil<chrono::steady_clock::duration>(timeout)
+    );
+  }
+
+  /**
+   * Awaitable suspending the function until a filedescriptor is ready (see waitReadable() / waitWritable())
+   *
+   * The filedescriptor is registered on the watch instance of the loop while the function waits
+   * and is unregistered once the function is resumed or destroyed.
+   * The awaitable must not be moved once it was awaited.
+   */
+  class ReadinessAwaitable {
+  public:
+    // Function waits in FUNC_WAIT (required by withTimeout())
+    static constexpr bool waitsOnLoop = true;
+
+    ReadinessAwaitable(int fd, uint32_t events) : fd(fd), events(events) {}
+
+    ReadinessAwaitable(ReadinessAwaitable&& other) noexcept
+      : fd(other.fd), events(other.events), watch(other.watch), watchInstance(other.watchInstance) {
+      other.watchInstance = -1;
+    }
+    ReadinessAwaitable(const ReadinessAwaitable&) = delete;
+    ReadinessAwaitable& operator=(const ReadinessAwaitable&) = delete;
+
+    ~ReadinessAwaitable() {
+      Unwatch();
+    }
+
+    bool await_ready() {
+      // If the filedescriptor is already ready, the function continues without registering it
+      struct pollfd pollFd = {fd, short(events), 0};
+      if (poll(&pollFd, 1, 0) < 1) return false;
+      watch.events = pollFd.revents;
+      return true;
+    }
+
+    void await_suspend(coroutine_handle<>) {
+      auto &state = internal::FunctionContext::Current();
+      auto *loop = internal::FunctionContext::loop;
+      // The watch is registered oneshot, it reports the readiness once and is then disabled
+      struct epoll_event event;
+      event.events = events | EPOLLONESHOT;
+      event.data.ptr = &watch;
+      int res = epoll_ctl(loop->watchInstance.getfd(), EPOLL_CTL_ADD, fd, &event);
+      if (res < 0) {
+        throw runtime_error(
+          format(
+            "Failed to wait on filedescriptor ({}):\n{}",
+            "add filedescriptor to watch instance", strerror(errno)
+          )
+        );
+      }
+      watchInstance = loop->watchInstance.getfd();
+      // The function is resumed by the loop once the watch reported the readiness
+      watch.connectionFd = state.fd.getfd();
+      watch.waitId = internal::FunctionContext::Wait();
+    }
+
+    uint32_t await_resume() {
+      Unwatch();
+      if (watch.events & POLLNVAL) {
+        throw runtime_error(
+          format(
+            "Failed to wait on filedescriptor ({}):\n{}",
+            "poll filedescriptor", "Invalid filedescriptor"
+          )
+        );
+      }
+      return watch.events;
+    }
+
+  private:
+    // Awaited filedescriptor
+    int fd;
+    // Awaited events (EPOLLIN / EPOLLOUT)
+    uint32_t events;
+    // Watch registered on the watch instance
+    internal::FdWatch watch;
+    // Watch instance the filedescriptor is registered on (-1 if not registered)
+    int watchInstance = -1;
+
+    /**
+     * Unregisters the filedescriptor from the watch instance (if registered)
+     */
+    void Unwatch() {
+      if (watchInstance < 0) return;
+      epoll_ctl(watchInstance, EPOLL_CTL_DEL, fd, nullptr);
+      watchInstance = -1;
+    }
   };
-} // namespace SimpleHTTP::internal
+
+  /**
+   * Suspends the function until the filedescriptor is readable without blocking the event loop
+   *
+   * Usage inside of a function: co_await waitReadable(backendSocket); read(backendSocket, ...);
+   *
+   * Supports every filedescriptor that can be registered on epoll (sockets, pipes, eventfds etc.),
+   * a filedescriptor can only be awaited by one function of a loop at a time.
+   * Returns the reported events (EPOLLIN, EPOLLERR, EPOLLHUP).
+   * Throws a runtime_error if the filedescriptor cannot be awaited (e.g. invalid filedescriptor)
+   */
+  inline ReadinessAwaitable waitReadable(int fd) {
+    return ReadinessAwaitable(fd, EPOLLIN);
+  }
+
+  /**
+   * Suspends the function until the filedescriptor is writable without blocking the event loop
+   *
+   * Usage inside of a function: co_await waitWritable(backendSocket); write(backendSocket, ...);
+   *
+   * Supports every filedescriptor that can be registered on epoll (sockets, pipes, eventfds etc.),
+   * a filedescriptor can only be awaited by one function of a loop at a time.
+   * Returns the reported events (EPOLLOUT, EPOLLERR, EPOLLHUP).
+   * Throws a runtime_error if the filedescriptor cannot be awaited (e.g. invalid filedescriptor)
+   */
+  inline ReadinessAwaitable waitWritable(int fd) {
+    return ReadinessAwaitable(fd, EPOLLOUT);
+  }
+} // namespace SimpleHTTP
 
 
 namespace SimpleHTTP {
+
+  /**
+   * EventBackend defines the kernel interface used to drive the event loops
+   */
+  enum class EventBackend {
+    EPOLL, // Readiness based event loop (epoll)
+    IO_URING, // Completion based event loop (io_uring), requires Linux >= 5.19
+  };
   
   /**
    * Server Configuration Object
@@ -1872,10 +6131,82 @@ namespace SimpleHTTP {
      * Defines the maximum size of the header. If exceeded, request will fail
      */
     int maxHeaderSize = 8192;
+    /**
+     * Defines the size of queued responses (in bytes) on a connection, after which no further
+     * pipelined requests are processed until the queued responses are sent.
+     * Streamed responses (see Response::write()) block the handler once this size is exceeded.
+     */
+    int maxResponseQueueSize = 65536;
+    /**
+     * Defines the maximum size of unread body data (in bytes) which is drained to reuse the connection.
+     *
+     * Body data not read by the handler is discarded after the response without buffering it.
+     * If more data remains, the connection is closed instead, as this is cheaper then receiving
+     * the body. Fixed bodies are checked upfront (the response is sent with "Connection: close"),
+     * chunked bodies are closed once the limit is exceeded while draining.
+     */
+    int maxDrainSize = 1 << 20;
+    /**
+     * Defines the maximum size of a chunked request body (in bytes).
+     *
+     * Chunk sizes are validated as soon as their size line is parsed. If a chunk would grow the body
+     * beyond this size, it is rejected like an invalid encoding: reading the body fails with 400,
+     * draining it closes the connection. The default matches the largest Content-Length of fixed bodies.
+     */
+    size_t maxChunkedBodySize = INT_MAX;
     /**
      * Connection timeout. If exceeded without any interaction, the connection is closed
      */
     chrono::seconds connectionTimeout = chrono::seconds(120);
+    /**
+     * Maximum time a function waits on an event outside of the connection (offload(), sleepFor(),
+     * waitReadable(), waitWritable() or a blocked splice target). If exceeded, the connection is closed.
+     *
+     * Waiting connections are not idle, therefore the connectionTimeout does not apply while the function waits
+     * (e.g. long polling). The wait timeout is checked by the connection timer, the connection is closed
+     * at the first expiration of the connectionTimeout after the wait timeout passed.
+     */
+    chrono::seconds waitTimeout = chrono::seconds(600);
+    /**
+     * Number of event loops launched by Serve(), each one running on its own thread.
+     * If set to 0, one event loop per available cpu core is launched.
+     *
+     * Every event loop uses its own epoll instance and connections. On tcp servers every loop
+     * also gets its own SO_REUSEPORT socket, so that the kernel loadbalances new connections.
+     */
+    int workerThreads = 1;
+    /**
+     * Event backend used by the event loops.
+     *
+     * The io_uring backend submits accept / recv / send operations in batches and receives data
+     * into kernel selected buffers, which reduces the syscalls per request.
+     */
+    EventBackend eventBackend = EventBackend::EPOLL;
+    /**
+     * Registers connections edge triggered on the epoll instance (epoll backend only).
+     *
+     * Every connection is registered once for input, output and peer hangup. The readiness reported
+     * by epoll is tracked per connection and the socket is processed until it blocks, therefore the
+     * event interest never has to be modified (no epoll_ctl() per stage change).
+     */
+    bool edgeTriggered = false;
+    /**
+     * Number of submission queue entries of every io_uring instance (io_uring backend only)
+     */
+    int uringQueueSize = 256;
+    /**
+     * Number of receive buffers (power of 2) provided to every io_uring instance (io_uring backend only).
+     * Every buffer has the size of sockBufferSize.
+     */
+    int uringBufferCount = 256;
+    /**
+     * Path of the metrics endpoint. If set, the event loops record metrics (request counts, bytes and
+     * latency histograms per route and method, loop gauges) which are served on GET requests to this path
+     * in the Prometheus text exposition format.
+     *
+     * Metrics are recorded per loop without locks, if the path is empty (default) nothing is recorded.
+     */
+    string metricsPath = "";
   };
   
   /**
@@ -1912,13 +6243,13 @@ namespace SimpleHTTP {
       struct sockaddr_un* unSockAddr = (struct sockaddr_un *)&coreSockAddr;
       // Clean unSockAddr, 'cause maybe some weird libs
       // still expect it to zero out sin_zero (which C++ does not do by def)
-      memset(unSockAddr, 0, sizeof(struct sockaddr));
+      memset(unSockAddr, 0, sizeof(struct sockaddr_un));
       // Set unSockAddr options
       unSockAddr->sun_family = AF_UNIX;
       strcpy(unSockAddr->sun_path, unixSockPath.c_str());
 
       // Bind unix socket
-      int res = bind(coreSocket.getfd(), &coreSockAddr, sizeof(struct sockaddr_un));
+      int res = bind(coreSocket.getfd(), (struct sockaddr *)&coreSockAddr, sizeof(struct sockaddr_un));
       if (res < 0) {
         throw runtime_error(
           format(
@@ -1929,7 +6260,7 @@ namespace SimpleHTTP {
       }
 
       // Retrieve current flags
-      sockFlags = fcntl(coreSocket.getfd(), F_GETFL, 0);
+      int sockFlags = fcntl(coreSocket.getfd(), F_GETFL, 0);
       if (sockFlags < 0) {
         throw runtime_error(
           format(
@@ -1991,8 +6322,307 @@ namespace SimpleHTTP {
       }
 
       // Initialize core socket
-      coreSocket = internal::helper::FileDescriptor(socket(AF_INET, SOCK_STREAM, 0));
-      if (coreSocket.getfd() < 0) {
+      coreSocket = CreateInetSocket();
+
+      // Socket is closed automatically in destructor, because Socket is RAII compatible.
+    };
+
+    /**
+     * Adds a route to the server
+     *
+     * Method parameter maps to the HTTP method
+     *
+     * Route parameter maps to the HTTP path
+     * Segments starting with ':' (e.g. /users/:id) match any single path segment,
+     * a trailing segment starting with '*' (e.g. "*file" in /static/...) matches the rest of the path.
+     * Captured values are available with Request::getPathParam(). Static segments take precedence.
+     * Throws a logic_error if the route conflicts with another route (e.g. /users/:name and /users/:id)
+     *
+     * Func defines a coroutine which is called on matching requests.
+     * The coroutine defined provides a Request, Body, and a Response object.
+     *
+     * Request / Response:
+     * Those objects can be used to analyze and manipulate the request / response.
+     *
+     * Body:
+     * The body object provides a read() and readAll() function; those functions can be used
+     * with co_await to read data from the HTTP body.
+     *
+     *
+     * If not all data from the body is read and the Connection header is set to "keep-alive",
+     * the body is drained after the request, blocking new incoming requests on this stream
+     * until the full body is read.
+     *
+     * To manually close the stream after the response (even if Connection is set to "keep-alive"),
+     * you can use co_return false;
+     *
+     * co_return true; indicates that the regular flow is continued
+     * (connection remains open after the body is drained)
+     *
+     *
+     * Func shall NOT perform any blocking IO operation besides those provided by simplehttp.
+     * Performing another blocking IO operation will block the whole HTTP server, not just this function!
+     * CPU intensive work can be moved to a ThreadPool with co_await offload(pool, fn);
+     * Waiting is possible with co_await sleepFor(duration); and co_await withTimeout(awaitable, duration);
+     * Other sockets and pipes can be awaited with co_await waitReadable(fd); and co_await waitWritable(fd);
+     *
+     * Func is stored inline without heap allocation if it fits into 64 bytes
+     * (e.g. lambdas capturing some references), larger callables are stored in a std::function.
+     */
+    template <typename F>
+      requires is_invocable_r_v<Task<bool>, decay_t<F>&, Request&, Body&, Response&>
+    void Route(string method, string route, F&& func) {
+      
+      // Convert method toupper
+      transform(method.begin(), method.end(), method.begin(),
+        [](unsigned char c){ return toupper(c); }
+      );
+
+      auto &handler = routeTree.Insert(route)[method];
+      // Assign metrics index to new routes (replaced handlers keep their index)
+      if (!handler.func) {
+        handler.metricsIndex = routeLabels.size();
+        routeLabels.push_back({method, route});
+      }
+      if constexpr (internal::RouteFunction::Fits<decay_t<F>>) {
+        handler.func = std::forward<F>(func);
+      } else {
+        handler.func = function<Task<bool>(Request&, Body&, Response&)>(std::forward<F>(func));
+      }
+    }
+
+    /**
+     * Serve the files of a directory below the path prefix (e.g. Static("/assets", "./public"))
+     *
+     * GET requests to prefix/<file> are answered with <directory>/<file>, which is sent from the page cache
+     * (see Response::sendFile()). Paths ending with '/' are answered with the index.html of the directory.
+     * The Content-Type is derived from the file extension. Requests with an If-Modified-Since header are
+     * answered with 304 Not Modified, if the file was not modified since.
+     *
+     * Paths with "." or ".." segments are rejected, so that no file outside the directory is served.
+     */
+    void Static(string prefix, string directory) {
+      // The wildcard segment starts after the slash of the prefix
+      while (!prefix.empty() && prefix.back()=='/') prefix.pop_back();
+      Route("GET", prefix+"/*file", [directory](Request &req, Body &, Response &res) -> Task<bool> {
+        string file = req.getPathParam("file").value_or("");
+        if (file.empty() || file.back()=='/') file += "index.html";
+
+        // Reject segments that navigate out of the directory
+        bool valid = file.find('\0')==string::npos;
+        for (size_t segmentStart = 0; valid && segmentStart <= file.size(); ) {
+          size_t segmentEnd = min(file.find('/', segmentStart), file.size());
+          string_view segment = string_view(file).substr(segmentStart, segmentEnd-segmentStart);
+          valid = segment!="." && segment!="..";
+          segmentStart = segmentEnd+1;
+        }
+
+        string path = directory+"/"+file;
+        auto opened = valid ? internal::helper::FileCache::Open(path) : nullptr;
+        if (!opened) {
+          res.setStatusCode(404)
+            .setStatusReason("Not Found")
+            .setContentType("text/plain")
+            .setBody("The requested resource "+req.getPath()+" was not found on this server\n");
+          co_return true;
+        }
+        res.setContentType(string(internal::helper::ContentTypeOf(file)));
+
+        // Answer conditional requests without body if the file was not modified
+        auto modifiedSince = req.getHeader("if-modified-since");
+        auto since = modifiedSince ? internal::helper::ParseHttpDate(modifiedSince.value()) : nullopt;
+        if (since && opened->modified <= since.value()) {
+          res.setStatusCode(304)
+            .setStatusReason("Not Modified")
+            .setHeader("Last-Modified", internal::helper::FormatHttpDate(opened->modified))
+            // Empty headers are not serialized
+            .setHeader("Content-Length", "");
+          co_return true;
+        }
+
+        if (!res.sendFile(path)) {
+          res.setStatusCode(500)
+            .setStatusReason("Internal Server Error")
+            .setContentType("text/plain")
+            .setBody("Failed to open "+req.getPath()+": "+strerror(errno)+"\n");
+        }
+        co_return true;
+      });
+    }
+
+    /**
+     * Serve launches the HTTP server
+     *
+     * tcp listener is initialized and the main event loops are started
+     *
+     * If more then one workerThread is configured, the event loops are launched on separate threads
+     * (the first loop runs on the calling thread). Connections are then spread over all loops.
+     *
+     * This function will run forever and block the thread, unless:
+     * - the server encounters a critical error, it will then throw a runtime_error
+     *   (if one loop fails, all other loops are shut down before the error is thrown)
+     * - the socket is closed (e.g. with Kill()), it will then exit without error
+     */
+    void Serve() {
+      // Obtain number of event loops
+      // hardware_concurrency() may return 0 if the value is not computable
+      int loopCount = config.workerThreads>0 ? config.workerThreads : thread::hardware_concurrency();
+      if (loopCount < 1) loopCount = 1;
+
+      // Unix sockets cannot be clustered with SO_REUSEPORT
+      // therefore all loops share the same core socket
+      bool sharedCoreSocket = coreSockAddr.ss_family!=AF_INET && loopCount>1;
+
+      // Create exit event descriptor
+      // The eventfd is shared by all loops, it is never read,
+      // this means once it's signaled, it remains readable until every loop is shut down
+      exitEvent = internal::helper::FileDescriptor(eventfd(0, 0));
+      if (exitEvent.getfd() < 0) {
+        throw runtime_error(
+          format(
+            "Failed to initialize HTTP server ({}):\n{}",
+            "create exit eventfd", strerror(errno)
+          )
+        );
+      }
+
+      // Register metrics endpoint (metrics of previous runs are discarded)
+      loopMetrics.clear();
+      if (!config.metricsPath.empty()) {
+        Route("GET", config.metricsPath, [this](Request &, Body &, Response &res) -> Task<bool> {
+          res.setContentType("text/plain; version=0.0.4").setBody(SerializeMetrics());
+          co_return true;
+        });
+      }
+
+      // Initialize event loops
+      vector<unique_ptr<internal::LoopState>> loops;
+      for (int i = 0; i < loopCount; i++) {
+        auto loop = make_unique<internal::LoopState>();
+        if (i==0 || sharedCoreSocket) {
+          // First loop always uses the core socket
+          loop->coreSockfd = coreSocket.getfd();
+        } else {
+          // Other tcp loops obtain their own socket, which is loadbalanced by the kernel
+          loop->ownedSocket = CreateInetSocket();
+          loop->coreSockfd = loop->ownedSocket.getfd();
+        }
+        InitializeLoop(*loop, sharedCoreSocket);
+        if (!config.metricsPath.empty()) {
+          loopMetrics.push_back(make_unique<internal::LoopMetrics>(routeLabels.size()));
+          loop->metrics = loopMetrics.back().get();
+        }
+        loops.push_back(std::move(loop));
+      }
+
+      // Run event loop directly if only one loop is used
+      if (loops.size()==1) {
+        StartEventLoop(*loops[0]);
+        return;
+      }
+
+      // First exception thrown by any of the loops
+      exception_ptr loopException = nullptr;
+      mutex loopExceptionMut;
+      // Runs the loop and captures its exception
+      auto runLoop = [&](internal::LoopState &loop) {
+        try {
+          StartEventLoop(loop);
+        } catch (...) {
+          lock_guard<mutex> lock(loopExceptionMut);
+          if (!loopException) loopException = current_exception();
+          // Shut down all other loops
+          Kill();
+        }
+      };
+
+      // Launch worker threads for all loops except the first one
+      vector<thread> workers;
+      try {
+        for (size_t i = 1; i < loops.size(); i++) {
+          workers.emplace_back(runLoop, ref(*loops[i]));
+        }
+      } catch (...) {
+        // If a thread cannot be launched, shut down the launched ones and rethrow
+        Kill();
+        for (auto &worker : workers) worker.join();
+        throw;
+      }
+      
+      // Run first loop on the calling thread
+      runLoop(*loops[0]);
+
+      // Wait until all loops are shut down
+      for (auto &worker : workers) worker.join();
+
+      if (loopException) rethrow_exception(loopException);
+    }
+
+
+
+    /**
+     * Kill shuts down the server
+     *
+     * tcp/unix will shut down gracefully; http will be forcefully closed (no 500 status)
+     *
+     * Kill() will essentially signal every event loop of the server to shut down
+     * This leads to the following events:
+     * - Immediately, new tcp connections to the server are rejected
+     * - Running sessions are closed on tcp level in the next event loop
+     * - The blocking Serve() will exit after every loop finished its iteration
+     *
+     * Kill is thread-safe.
+     */
+    void Kill() {
+      uint64_t increment = 1;
+      write(exitEvent.getfd(), &increment, sizeof(uint64_t));
+    }
+
+    
+  private:
+    // Core bsd socket (responsible for establishing connections)
+    internal::helper::FileDescriptor coreSocket;
+    // Exit event descriptor - eventfd (used to exit the event loops)
+    internal::helper::FileDescriptor exitEvent;
+    
+    // Socket addr
+    // Storage is large enough to hold every address type (e.g. sockaddr_un with its full path)
+    struct sockaddr_storage coreSockAddr;
+    // Server configuration
+    ServerConfiguration config;
+    
+    /**
+     * Handler registered for a route and method
+     */
+    struct RouteHandler {
+      // User defined function
+      internal::RouteFunction func;
+      // Index of the metrics recorded for the route and method
+      size_t metricsIndex = 0;
+    };
+
+    // Defines a radix tree in which each route pattern (e.g. "/api/users/:id")
+    // maps to a map. This inner map associates HTTP methods (e.g., "GET") 
+    // with their respective handlers.
+    internal::helper::RadixTree<unordered_map<string, RouteHandler>> routeTree;
+
+    // Method and route of every metrics index (index 0 holds unmatched requests)
+    vector<pair<string, string>> routeLabels = {{"", ""}};
+    // Metrics of every event loop (only set if metrics are enabled)
+    // Created by Serve() before the loops are started, so that every loop can read them
+    vector<unique_ptr<internal::LoopMetrics>> loopMetrics;
+
+    /**
+     * Creates a tcp socket bound to the core socket addr
+     *
+     * The socket is created with SO_REUSEPORT, therefore this function can be called multiple times
+     * to create multiple sockets for the same ip + port combination (one per event loop).
+     *
+     * Throws a runtime_error if the socket cannot be initialized
+     */
+    internal::helper::FileDescriptor CreateInetSocket() {
+      internal::helper::FileDescriptor inetSocket(socket(AF_INET, SOCK_STREAM, 0));
+      if (inetSocket.getfd() < 0) {
         throw runtime_error(
           format(
             "Failed to initialize HTTP server ({}):\n{}",
@@ -2004,7 +6634,7 @@ namespace SimpleHTTP {
       // SO_REUSEADDR = Enable binding TIME_WAIT network ports forcefully
       // SO_REUSEPORT = Enable to cluster (lb) multiple bsd sockets with same ip + port combination
       int opt = 1; // opt 1 indicates that the options should be enabled
-      res = setsockopt(coreSocket.getfd(), SOL_SOCKET, SO_REUSEADDR | SO_REUSEPORT, &opt, sizeof(opt));
+      int res = setsockopt(inetSocket.getfd(), SOL_SOCKET, SO_REUSEADDR | SO_REUSEPORT, &opt, sizeof(opt));
       if (res < 0) {
         throw runtime_error(
           format(
@@ -2016,7 +6646,7 @@ namespace SimpleHTTP {
       
       // Set socket recv buffer (should match a regular HTTP package for optimal performance)
       res = setsockopt(
-        coreSocket.getfd(),
+        inetSocket.getfd(),
         SOL_SOCKET,
         SO_RCVBUF,
         &config.sockBufferSize,
@@ -2032,7 +6662,7 @@ namespace SimpleHTTP {
       }
       // Set socket send buffer (should match a regular HTTP package for optimal performance)
       res = setsockopt(
-        coreSocket.getfd(),
+        inetSocket.getfd(),
         SOL_SOCKET,
         SO_SNDBUF,
         &config.sockBufferSize,
@@ -2045,104 +6675,61 @@ namespace SimpleHTTP {
             "set socket options", strerror(errno)
           )
         );
-      }
-
-      // Bind socket to specified addr
-      res = bind(coreSocket.getfd(), &coreSockAddr, sizeof(struct sockaddr_in));
-      if (res < 0) {
-        throw runtime_error(
-          format(
-            "Failed to initialize HTTP server ({}):\n{}",
-            "bind socket", strerror(errno)
-          )
-        );
-      }
-
-      // Retrieve current flags
-      sockFlags = fcntl(coreSocket.getfd(), F_GETFL, 0);
-      if (res < 0) {
-        throw runtime_error(
-          format(
-            "Failed to initialize HTTP server ({}):\n{}",
-            "read socket flags", strerror(errno)
-          )
-        );
-      }
-
-      // Add nonblocking flag
-      sockFlags = sockFlags | O_NONBLOCK;
-
-      // Set flags for core socket
-      res = fcntl(coreSocket.getfd(), F_SETFL, sockFlags);
-      if (res < 0) {
-        throw runtime_error(
-          format(
-            "Failed to initialize HTTP server ({}):\n{}",
-            "update socket flags", strerror(errno)
-          )
-        );
-      }
-
-      // Socket is closed automatically in destructor, because Socket is RAII compatible.
-    };
-
-    /**
-     * Adds a route to the server
-     *
-     * Method parameter maps to the HTTP method
-     *
-     * Route parameter maps to the HTTP path
-     *
-     * Func defines a coroutine which is called on matching requests.
-     * The coroutine defined provides a Request, Body, and a Response object.
-     *
-     * Request / Response:
-     * Those objects can be used to analyze and manipulate the request / response.
-     *
-     * Body:
-     * The body object provides a read() and readAll() function; those functions can be used
-     * with co_await to read data from the HTTP body.
-     *
-     *
-     * If not all data from the body is read and the Connection header is set to "keep-alive",
-     * the body is drained after the request, blocking new incoming requests on this stream
-     * until the full body is read.
-     *
-     * To manually close the stream after the response (even if Connection is set to "keep-alive"),
-     * you can use co_return false;
-     *
-     * co_return true; indicates that the regular flow is continued
-     * (connection remains open after the body is drained)
-     *
-     *
-     * Func shall NOT perform any blocking IO operation besides those provided by simplehttp.
-     * Performing another blocking IO operation will block the whole HTTP server, not just this function!
-     */
-    void Route(
-      string method,
-      string route,
-      function<Task<bool>(Request&, Body&, Response&)> func) {
-      
-      // Convert method toupper
-      transform(method.begin(), method.end(), method.begin(),
-        [](unsigned char c){ return toupper(c); }
-      );
+      }
+
+      // Bind socket to specified addr
+      res = bind(inetSocket.getfd(), (struct sockaddr *)&coreSockAddr, sizeof(struct sockaddr_in));
+      if (res < 0) {
+        throw runtime_error(
+          format(
+            "Failed to initialize HTTP server ({}):\n{}",
+            "bind socket", strerror(errno)
+          )
+        );
+      }
+
+      // Retrieve current flags
+      int sockFlags = fcntl(inetSocket.getfd(), F_GETFL, 0);
+      if (sockFlags < 0) {
+        throw runtime_error(
+          format(
+            "Failed to initialize HTTP server ({}):\n{}",
+            "read socket flags", strerror(errno)
+          )
+        );
+      }
+
+      // Add nonblocking flag
+      sockFlags = sockFlags | O_NONBLOCK;
 
-      routeMap[route][method] = func;
+      // Set flags for core socket
+      res = fcntl(inetSocket.getfd(), F_SETFL, sockFlags);
+      if (res < 0) {
+        throw runtime_error(
+          format(
+            "Failed to initialize HTTP server ({}):\n{}",
+            "update socket flags", strerror(errno)
+          )
+        );
+      }
+      return inetSocket;
     }
 
     /**
-     * Serve launches the HTTP server
+     * Initializes the event loop state
      *
-     * tcp listener is initialized and the main event loop is started
+     * Starts the listener on the loops core socket and creates the epoll instance
+     * with the core socket, the exit eventfd, the wake eventfd and the watch instance attached.
      *
-     * This function will run forever and block the thread, unless:
-     * - the server encounters a critical error, it will then throw a runtime_error
-     * - the socket is closed (e.g. with Kill()), it will then exit without error
+     * If the core socket is shared with other loops, it is attached exclusively
+     * to prevent waking up all loops on a new connection.
+     *
+     * If the io_uring backend is configured, an io_uring instance is created instead of the epoll instance.
+     * Core socket, exit eventfd, wake eventfd and watch instance are then attached when the loop is started.
      */
-    void Serve() {
+    void InitializeLoop(internal::LoopState &loop, bool sharedCoreSocket) {
       // Start listener on core socket
-      int res = listen(coreSocket.getfd(), config.sockQueueSize);
+      int res = listen(loop.coreSockfd, config.sockQueueSize);
       if (res < 0) {
         throw runtime_error(
           format(
@@ -2152,9 +6739,48 @@ namespace SimpleHTTP {
         );
       }
 
+      // Create wake queue (signaled by threads that completed work offloaded by a function)
+      loop.wakeQueue = make_shared<internal::helper::WakeQueue>();
+      if (loop.wakeQueue->getfd() < 0) {
+        throw runtime_error(
+          format(
+            "Failed to initialize HTTP server ({}):\n{}",
+            "create wake eventfd", strerror(errno)
+          )
+        );
+      }
+
+      // Create watch instance (holds the filedescriptors awaited by functions)
+      loop.watchInstance = internal::helper::FileDescriptor(epoll_create1(EPOLL_CLOEXEC));
+      if (loop.watchInstance.getfd() < 0) {
+        throw runtime_error(
+          format(
+            "Failed to initialize HTTP server ({}):\n{}",
+            "create watch instance", strerror(errno)
+          )
+        );
+      }
+
+      if (config.eventBackend == EventBackend::IO_URING) {
+        // Create io_uring instance
+        try {
+          loop.uring = make_unique<internal::helper::Uring>(
+            config.uringQueueSize, config.uringBufferCount, config.sockBufferSize
+          );
+        } catch (exception &e) {
+          throw runtime_error(
+            format(
+              "Failed to initialize HTTP server ({}):\n{}",
+              "create io_uring instance", e.what()
+            )
+          );
+        }
+        return;
+      }
+
       // Create epoll instance
-      epollInstance = internal::helper::FileDescriptor(epoll_create1(0));
-      if (epollInstance.getfd() < 0) {
+      loop.epollInstance = internal::helper::FileDescriptor(epoll_create1(0));
+      if (loop.epollInstance.getfd() < 0) {
         throw runtime_error(
           format(
             "Failed to initialize HTTP server ({}):\n{}",
@@ -2166,10 +6792,11 @@ namespace SimpleHTTP {
       // This is just used to inform the epoll_ctl which events we are interested in
       struct epoll_event coreSockEvent;
       // On core socket we are only interested in readable state, there is no need for any writes to it
-      coreSockEvent.events = EPOLLIN;
-      coreSockEvent.data.fd = coreSocket.getfd();
+      coreSockEvent.events = sharedCoreSocket ? EPOLLIN | EPOLLEXCLUSIVE : EPOLLIN;
+      // Connection events carry the address of their slot, the core socket is identified by the loops coreSockfd
+      coreSockEvent.data.ptr = &loop.coreSockfd;
       
-      res = epoll_ctl(epollInstance.getfd(), EPOLL_CTL_ADD, coreSocket.getfd(), &coreSockEvent);
+      res = epoll_ctl(loop.epollInstance.getfd(), EPOLL_CTL_ADD, loop.coreSockfd, &coreSockEvent);
       if (res < 0) {
         throw runtime_error(
           format(
@@ -2179,25 +6806,15 @@ namespace SimpleHTTP {
         );
       }
 
-      // Create exit event descriptor
-      exitEvent = internal::helper::FileDescriptor(eventfd(0, 0));
-      if (exitEvent.getfd() < 0) {
-        throw runtime_error(
-          format(
-            "Failed to initialize HTTP server ({}):\n{}",
-            "create exit eventfd", strerror(errno)
-          )
-        );
-      }
       // Add exit eventfd to epoll instance
       // This is just used to inform the epoll_ctl which events we are interested in
       struct epoll_event exitEventEvent;
       
-      // On core socket we are only interested in readable state, there is no need for any writes to it
+      // On exit eventfd we are only interested in readable state, there is no need for any writes to it
       exitEventEvent.events = EPOLLIN;
-      exitEventEvent.data.fd = exitEvent.getfd();
+      exitEventEvent.data.ptr = &exitEvent;
       
-      res = epoll_ctl(epollInstance.getfd(), EPOLL_CTL_ADD, exitEvent.getfd(), &exitEventEvent);
+      res = epoll_ctl(loop.epollInstance.getfd(), EPOLL_CTL_ADD, exitEvent.getfd(), &exitEventEvent);
       if (res < 0) {
         throw runtime_error(
           format(
@@ -2207,91 +6824,77 @@ namespace SimpleHTTP {
         );
       }
 
+      // Add wake eventfd to epoll instance
+      struct epoll_event wakeEventEvent;
+      wakeEventEvent.events = EPOLLIN;
+      wakeEventEvent.data.ptr = loop.wakeQueue.get();
 
-      // Run event loop
-      StartEventLoop();
-    }
-
+      res = epoll_ctl(loop.epollInstance.getfd(), EPOLL_CTL_ADD, loop.wakeQueue->getfd(), &wakeEventEvent);
+      if (res < 0) {
+        throw runtime_error(
+          format(
+            "Failed to initialize HTTP server ({}):\n{}",
+            "add wake eventfd to epoll instance", strerror(errno)
+          )
+        );
+      }
 
+      // Add watch instance to epoll instance (it is readable if an awaited filedescriptor is ready)
+      struct epoll_event watchInstanceEvent;
+      watchInstanceEvent.events = EPOLLIN;
+      watchInstanceEvent.data.ptr = &loop.watchInstance;
 
-    /**
-     * Kill shuts down the server
-     *
-     * tcp/unix will shut down gracefully; http will be forcefully closed (no 500 status)
-     *
-     * Kill() will essentially close the core socket of the server
-     * This leads to the following events:
-     * - Immediately, new tcp connections to the server are rejected
-     * - Running sessions are closed on tcp level in the next event loop
-     * - The blocking Serve() will exit after next event loop
-     *
-     * Kill is thread-safe.
-     */
-    void Kill() {
-      uint64_t increment = 1;
-      write(exitEvent.getfd(), &increment, sizeof(uint64_t));
+      res = epoll_ctl(loop.epollInstance.getfd(), EPOLL_CTL_ADD, loop.watchInstance.getfd(), &watchInstanceEvent);
+      if (res < 0) {
+        throw runtime_error(
+          format(
+            "Failed to initialize HTTP server ({}):\n{}",
+            "add watch instance to epoll instance", strerror(errno)
+          )
+        );
+      }
     }
 
-    
-  private:
-    // Core bsd socket (responsible for establishing connections)
-    internal::helper::FileDescriptor coreSocket;
-    // Epoll event instance (responsible for event infrastructure)
-    internal::helper::FileDescriptor epollInstance;
-    // Exit event descriptor - eventfd (used to exit the event loop)
-    internal::helper::FileDescriptor exitEvent;
-    
-    // Socket addr
-    struct sockaddr coreSockAddr;
-    // Socket flags
-    int sockFlags;
-    // Server configuration
-    ServerConfiguration config;
-    
-    // Defines a map in which each key, corresponding to an HTTP path (e.g. "/api/some", 
-    // maps to another map. This inner map associates HTTP methods (e.g., "GET") 
-    // with their respective handler functions.
-    unordered_map<string, unordered_map<string, function<Task<bool>(
-      Request&,
-      Body&,
-      Response&
-    )>>> routeMap;
-
     /**
-     * Initialize and start simplehttp event loop
+     * Start simplehttp event loop
      *
      *
      * This function blocks until:
-     * - Eventloop was shut down (core socket closed)
+     * - Eventloop was shut down (exit event signaled)
      * - Exception occured
      */
-    void StartEventLoop() {
+    void StartEventLoop(internal::LoopState &loop) {
+      // Awaitables of the functions resumed on this thread register their wakeups on this loop
+      internal::FunctionContext::loop = &loop;
+
+      // Loops with an io_uring instance are driven by completions instead
+      if (loop.uring) {
+        StartUringLoop(loop);
+        return;
+      }
+
       // Buffer with list of connection events
       // This is used by the epoll instance to insert the events on every loop
       struct epoll_event conEvents[config.maxEventsPerLoop];
 
-      // Map holding connection state
-      // Key is the filedescriptor number of the socket
-      // Value is a ConnectionState object which contains information about the connection
-      // including a FileDescriptor resource
-      //
-      // If the map is destructed (e.g. error is thrown),
-      // all sockets are closed automatically due to the RAII compatible FileDescriptor in the ConnectionState
-      unordered_map<int, internal::ConnectionState> conStateMap;
-
-      
       // Start main event loop
       while (1) {
         // Capture current time
-        auto now = chrono::system_clock::now();
+        auto now = chrono::steady_clock::now();
         // Erase all connections where timeout is reached
-        for (auto &con : conStateMap) {
-          if (con.second.expirationTime<now) conStateMap.erase(con.first);
-        }
+        ExpireConnections(loop, now);
+        // Resume all functions whose sleep or timeout is reached
+        ExpireWaits(loop, now);
 
         // Wait for any epoll event (includes core socket and connections)
-        // The -1 timeout means that it waits indefinitely until a event is reported
-        int n = epoll_wait(epollInstance.getfd(), conEvents, config.maxEventsPerLoop, -1);
+        // The timeout is derived from the next connection or wait timer,
+        // if no timer is set (-1) it waits indefinitely until a event is reported
+        int n = epoll_wait(
+          loop.epollInstance.getfd(),
+          conEvents,
+          config.maxEventsPerLoop,
+          NextTimeout(loop, now)
+        );
         if (n < 0) {
           throw runtime_error(
             format(
@@ -2300,21 +6903,41 @@ namespace SimpleHTTP {
             )
           );
         }
-        
+        // Refresh the cached Date header after waiting (formatted at most once per second)
+        internal::helper::DateCache::Refresh(chrono::system_clock::now());
+        if (loop.metrics) {
+          loop.metrics->wakeups.Add(1);
+          loop.metrics->events.Add(n);
+        }
+
+        // Set if the core socket reported incoming connections
+        bool acceptPending = false;
+
         // Handle events
         for (int i = 0; i < n; i++) {
           
           // If the event is from the exit signal
-          if (conEvents[i].data.fd == exitEvent.getfd()) {
+          if (conEvents[i].data.ptr == &exitEvent) {
             // If an exit signal is received, the eventloop is closed
             // Sockets etc. are RAII compatible, this means just returning is fine,
             // all filedescriptors will be closed and the kernel will handle the teardown process
             return;
           }
 
+          // If the event is from the wake queue
+          else if (conEvents[i].data.ptr == loop.wakeQueue.get()) {
+            // Resume the functions of the woken connections
+            ProcessWakeups(loop);
+          }
+
+          // If the event is from the watch instance
+          else if (conEvents[i].data.ptr == &loop.watchInstance) {
+            // Resume the functions whose filedescriptors are ready
+            ProcessWatches(loop);
+          }
           
           // If the event is from the core socket          
-          else if (conEvents[i].data.fd == coreSocket.getfd()) {
+          else if (conEvents[i].data.ptr == &loop.coreSockfd) {
             // Check if error occured, if yes fetch it and return
             // For simplicity reasons there is currently no http 500 response here
             // instead sockets are closed leading to hangup signal on the client
@@ -2322,7 +6945,7 @@ namespace SimpleHTTP {
               int err = 0;
               socklen_t errlen = sizeof(err);
               // Read error from sockopt
-              int res = getsockopt(conEvents[i].data.fd, SOL_SOCKET, SO_ERROR, (void *)&err, &errlen);
+              int res = getsockopt(loop.coreSockfd, SOL_SOCKET, SO_ERROR, (void *)&err, &errlen);
               // If getsockopt failed, return unknown error
               if (res < 0) {
                 throw runtime_error(
@@ -2342,103 +6965,558 @@ namespace SimpleHTTP {
               }
             }
 
-            // Initialize connection
-            // If connection was not established correctly, it is skipped
-            auto conState = InitializeConnection(conEvents[i]);
-            if (conState.has_value()) {
-              // Copied because conSocket is moved before map[] overloader
-              int conSockfd = conState.value().fd.getfd();
-              // Move the state to the conStateMap
-              // Local conState object is explicitly marked as rvalue so that it is moved,
-              // otherwise the contained FileDescriptor would be cleaned up immediately
-              conStateMap[conSockfd] = std::move(conState.value());
+            // Connections are accepted after all events of this iteration are handled,
+            // otherwise the slot of a connection closed in this iteration could be reused
+            // and receive the remaining events of the former connection
+            acceptPending = true;
+          }
+
+          
+          // If the event is from a connection
+          else {
+            // Resolve the slot registered with the event
+            auto &slot = *static_cast<internal::ConnectionSlab::Slot*>(conEvents[i].data.ptr);
+            // Skip events of connections that were closed in this iteration
+            if (!slot.open) continue;
+            // Handle edge triggered connection, if false is returned, connection is cleaned up
+            if (config.edgeTriggered) {
+              if (!DriveEdgeConnection(conEvents[i], slot.state.value())) {
+                // Release the slot, this will close the FileDescriptor which cleans up the socket.
+                loop.connections.Release(slot);
+              }
+              continue;
+            }
+            // Handle connection, if false is returned, connection is cleaned up
+            if (!HandleConnection(conEvents[i], slot.state.value())) {
+              // Release the slot, this will destruct the FileDescriptor which cleans up the socket.
+              loop.connections.Release(slot);
+              continue;
+            };
+
+            // Update epoll interest for the connection, if false is returned, connection is cleaned up
+            if (!UpdateEventInterest(loop.epollInstance, slot)) {
+              // Release the slot, this will destruct the FileDescriptor which cleans up the socket.
+              loop.connections.Release(slot);
+              continue;
+            };
+          }
+        }
+
+        if (acceptPending) {
+          // Initialize connection
+          // If connection was not established correctly, it is skipped
+          auto *conState = InitializeConnection(loop);
+          if (conState) {
+            // Register connection timer
+            loop.timerWheel.Insert(conState->fd.getfd(), conState->id, conState->expirationTime);
+          }
+        }
+
+        if (loop.metrics) loop.metrics->openConnections.Set(loop.connections.Size());
+      }
+    }
+
+
+    /**
+     * Operations submitted to the io_uring instance
+     *
+     * The operation is encoded into the user_data of the submission together with the
+     * connection filedescriptor and the generation of its slot:
+     * [ 4 bit operation | 28 bit filedescriptor | 32 bit slot generation ]
+     */
+    enum UringOperation : uint64_t {
+      URING_ACCEPT = 1,
+      URING_RECV = 2,
+      URING_SEND = 3,
+      URING_EXIT = 4,
+      URING_WAKE = 5,
+      URING_WATCH = 6,
+    };
+
+    /**
+     * Start simplehttp event loop on the io_uring backend
+     *
+     * Connections are accepted with a multishot accept operation. Connection sockets operate in
+     * completion mode, every recv / send requested by the state machine is submitted to the ring
+     * and all queued submissions are flushed with a single io_uring_enter() per iteration.
+     *
+     * This function blocks until:
+     * - Eventloop was shut down (exit event signaled)
+     * - Exception occured
+     */
+    void StartUringLoop(internal::LoopState &loop) {
+      auto &uring = *loop.uring;
+
+      // Arm accept and exit operations
+      SubmitUringAccept(loop);
+      struct io_uring_sqe *exitSqe = uring.GetSqe();
+      exitSqe->opcode = IORING_OP_POLL_ADD;
+      exitSqe->fd = exitEvent.getfd();
+      exitSqe->poll32_events = POLLIN;
+      exitSqe->user_data = URING_EXIT << 60;
+      SubmitUringWake(loop);
+      SubmitUringWatch(loop);
+
+      // Start main event loop
+      while (1) {
+        // Capture current time
+        auto now = chrono::steady_clock::now();
+        // Erase all connections where timeout is reached
+        ExpireConnections(loop, now);
+        // Resume all functions whose sleep or timeout is reached
+        ExpireWaits(loop, now);
+
+        // Submit all queued operations and wait for any completion
+        // The timeout is derived from the next connection or wait timer,
+        // if no timer is set (-1) it waits indefinitely until a completion is reported
+        int n = uring.Enter(1, NextTimeout(loop, now));
+        if (n < 0 && errno != ETIME && errno != EINTR) {
+          throw runtime_error(
+            format(
+              "Critical failure while running HTTP server ({}):\n{}",
+              "wait for completions", strerror(errno)
+            )
+          );
+        }
+        // Refresh the cached Date header after waiting (formatted at most once per second)
+        internal::helper::DateCache::Refresh(chrono::system_clock::now());
+
+        // Set if the exit signal is received
+        bool exit = false;
+        // Number of completions handled in this iteration
+        uint64_t completions = 0;
+        
+        // Handle completions
+        uring.ForEachCompletion([&](const struct io_uring_cqe &cqe) {
+          completions++;
+          uint64_t operation = cqe.user_data >> 60;
+          int conSockfd = (cqe.user_data >> 32) & 0x0FFFFFFF;
+          uint32_t conGeneration = cqe.user_data & 0xFFFFFFFF;
+          // Receive buffer selected by the kernel (if any)
+          optional<uint16_t> bufferId = nullopt;
+          if (cqe.flags & IORING_CQE_F_BUFFER) bufferId = cqe.flags >> IORING_CQE_BUFFER_SHIFT;
+
+          switch (operation) {
+          case URING_EXIT:
+            // If an exit signal is received, the eventloop is closed
+            // The io_uring instance cancels all pending operations and waits for them on destruction
+            exit = true;
+            return;
+          case URING_WAKE:
+            // Multishot poll is terminated by the kernel on errors, rearm it in this case
+            if (!(cqe.flags & IORING_CQE_F_MORE)) SubmitUringWake(loop);
+            // Resume the functions of the woken connections
+            ProcessWakeups(loop);
+            return;
+          case URING_WATCH:
+            // Multishot poll is terminated by the kernel on errors, rearm it in this case
+            if (!(cqe.flags & IORING_CQE_F_MORE)) SubmitUringWatch(loop);
+            // Resume the functions whose filedescriptors are ready
+            ProcessWatches(loop);
+            return;
+          case URING_ACCEPT: {
+            // Multishot accept is terminated by the kernel on errors, rearm it in this case
+            if (!(cqe.flags & IORING_CQE_F_MORE)) SubmitUringAccept(loop);
+            // Skip failed connection
+            if (cqe.res < 0) return;
+            
+            // Open the connection with a completion mode socket in its slot (reusing the state of the slot)
+            auto &slot = loop.connections.Open(
+              internal::helper::Socket(internal::helper::FileDescriptor(cqe.res), true)
+            );
+            auto &conState = slot.state.value();
+            conState.id = loop.nextConnectionId++;
+            conState.expirationTime = chrono::steady_clock::now() + config.connectionTimeout;
+            InitializeConnectionMetrics(loop, conState.metrics);
+            // Register connection timer
+            loop.timerWheel.Insert(cqe.res, conState.id, conState.expirationTime);
+            // Start processing the connection
+            if (!DriveUringConnection(loop, slot, EPOLLIN)) {
+              CloseConnection(loop, slot);
+            }
+            return;
+          }
+          default:
+            break;
+          }
+          
+          // Find ConnectionState object
+          if (!loop.connections.Find(conSockfd, conGeneration)) {
+            // Completion of an already closed connection, just hand the buffer back
+            if (bufferId.has_value()) uring.ProvideBuffer(bufferId.value());
+            return;
+          }
+          auto &slot = loop.connections.Get(conSockfd);
+          auto &state = slot.state.value();
+
+          // Release connections which were closed while the operation was in flight
+          if (state.fd.isClosing()) {
+            if (bufferId.has_value()) uring.ProvideBuffer(bufferId.value());
+            loop.connections.Release(slot);
+            return;
+          }
+          
+          uint32_t events = 0;
+          if (operation == URING_RECV) {
+            if (bufferId.has_value()) {
+              // The received data is processed in place, the buffer is handed back once the connection blocks
+              state.fd.DeliverRecv(uring.BufferData(bufferId.value()), cqe.res, bufferId.value());
+            } else if (cqe.res == -ENOBUFS || cqe.res == -EAGAIN || cqe.res == -EINTR) {
+              // No data received (e.g. all buffers in use), the recv is submitted again
+              state.fd.DeliverRecvNothing();
+            } else {
+              // Peer closed the connection (0) or the connection failed
+              state.fd.DeliverRecvError(-cqe.res);
+            }
+            events = EPOLLIN;
+          } else {
+            state.fd.DeliverSend(cqe.res);
+            events = EPOLLOUT;
+          }
+          
+          // Continue processing the connection, if false is returned, connection is cleaned up
+          if (!DriveUringConnection(loop, slot, events)) {
+            CloseConnection(loop, slot);
+          }
+        });
+
+        if (exit) return;
+        if (loop.metrics) {
+          loop.metrics->wakeups.Add(1);
+          loop.metrics->events.Add(completions);
+          loop.metrics->openConnections.Set(loop.connections.Size());
+        }
+      }
+    }
+
+    /**
+     * Queues the multishot accept operation on the loops core socket
+     */
+    void SubmitUringAccept(internal::LoopState &loop) {
+      struct io_uring_sqe *sqe = loop.uring->GetSqe();
+      sqe->opcode = IORING_OP_ACCEPT;
+      sqe->fd = loop.coreSockfd;
+      sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+      sqe->user_data = URING_ACCEPT << 60;
+    }
+
+    /**
+     * Queues the multishot poll operation on the loops wake eventfd
+     */
+    void SubmitUringWake(internal::LoopState &loop) {
+      struct io_uring_sqe *sqe = loop.uring->GetSqe();
+      sqe->opcode = IORING_OP_POLL_ADD;
+      sqe->fd = loop.wakeQueue->getfd();
+      sqe->poll32_events = POLLIN;
+      sqe->len = IORING_POLL_ADD_MULTI;
+      sqe->user_data = URING_WAKE << 60;
+    }
+
+    /**
+     * Queues the multishot poll operation on the loops watch instance
+     */
+    void SubmitUringWatch(internal::LoopState &loop) {
+      struct io_uring_sqe *sqe = loop.uring->GetSqe();
+      sqe->opcode = IORING_OP_POLL_ADD;
+      sqe->fd = loop.watchInstance.getfd();
+      sqe->poll32_events = POLLIN;
+      sqe->len = IORING_POLL_ADD_MULTI;
+      sqe->user_data = URING_WATCH << 60;
+    }
+
+    /**
+     * Processes the connection after a completion and queues the next operation
+     *
+     * The state machine is invoked with the synthetic readiness event (EPOLLIN / EPOLLOUT) matching
+     * the completion. Once it blocks, the recv / send operation it requested is queued.
+     *
+     * Received data is parsed in place in its provided buffer, which is handed back to the kernel
+     * once the connection blocks. Data that was not consumed by then (e.g. pipelined requests while
+     * responses are sent) is copied out, so that waiting connections do not hold provided buffers.
+     *
+     * Returns false to indicate that the connection should be closed (on tcp layer)
+     */
+    bool DriveUringConnection(internal::LoopState &loop, internal::ConnectionSlab::Slot &slot, uint32_t events) {
+      bool healthy = ProcessUringConnection(loop, slot, events);
+      // The data of closed connections is dropped
+      auto bufferId = slot.state.value().fd.ReleaseBuffer(!healthy);
+      if (bufferId.has_value()) loop.uring->ProvideBuffer(bufferId.value());
+      return healthy;
+    }
+
+    /**
+     * Runs the state machine of the connection until it blocks and queues the requested operation
+     *
+     * Returns false to indicate that the connection should be closed (on tcp layer)
+     */
+    bool ProcessUringConnection(internal::LoopState &loop, internal::ConnectionSlab::Slot &slot, uint32_t events) {
+      auto &uring = *loop.uring;
+      auto &state = slot.state.value();
+      // Encoded connection, appended to the operation
+      uint64_t conData = (uint64_t(state.fd.getfd() & 0x0FFFFFFF) << 32) | slot.generation;
+      
+      while (1) {
+        struct epoll_event event;
+        event.events = events;
+        event.data.ptr = &slot;
+        if (!HandleConnection(event, state)) return false;
+
+        // Determine the operation required to continue
+        auto operation = state.fd.RequestedOperation();
+        if (operation == internal::helper::Socket::NONE) {
+          // The state machine changed the stage without blocking on the socket
+          switch (state.stage) {
+          case internal::Stage::RES:
+            // Continue with sending the queued responses
+            events = EPOLLOUT;
+            continue;
+          case internal::Stage::REQ:
+          case internal::Stage::FUNC_BODY:
+          case internal::Stage::CLEANUP:
+            // Continue with already delivered data, otherwise receive new data
+            if (state.fd.HasDelivered()) {
+              events = EPOLLIN;
+              continue;
             }
+            operation = internal::helper::Socket::RECV;
+            break;
+          default:
+            return true;
           }
+        }
+
+        struct io_uring_sqe *sqe = uring.GetSqe();
+        sqe->fd = state.fd.getfd();
+        if (operation == internal::helper::Socket::RECV) {
+          // Let the kernel select a provided buffer once data is available
+          sqe->opcode = IORING_OP_RECV;
+          sqe->flags = IOSQE_BUFFER_SELECT;
+          sqe->buf_group = uring.getBufferGroup();
+          sqe->len = uring.getBufferSize();
+          sqe->user_data = (URING_RECV << 60) | conData;
+        } else {
+          sqe->opcode = IORING_OP_SENDMSG;
+          sqe->addr = (uint64_t)state.fd.SendRequest();
+          sqe->len = 1;
+          sqe->msg_flags = MSG_NOSIGNAL;
+          sqe->user_data = (URING_SEND << 60) | conData;
+        }
+        state.fd.Submitted();
+        return true;
+      }
+    }
+
+
+    /**
+     * Closes all connections whose expiration time is reached
+     *
+     * Only timers due until now are visited. Connections that were active since their timer was set
+     * (expiration time was pushed back) are rescheduled to their current expiration time.
+     * Connections whose function waits (FUNC_WAIT, e.g. long polling) are not idle, they are rescheduled
+     * until the wait exceeds the waitTimeout.
+     */
+    void ExpireConnections(internal::LoopState &loop, chrono::steady_clock::time_point now) {
+      loop.timerWheel.Advance(now, [&](const internal::helper::TimerWheel::Timer &timer) {
+        auto *state = loop.connections.Find(timer.fd);
+        // Skip timers of connections that were already closed
+        if (!state || state->id != timer.id) return;
+
+        if (state->stage==internal::Stage::FUNC_WAIT) {
+          // The wait is bounded by its deadline, the idle timeout starts again once the function is resumed
+          state->expirationTime = state->waitDeadline;
+        }
+        if (state->expirationTime > now) {
+          // Connection was active in the meantime, reschedule the timer
+          loop.timerWheel.Insert(timer.fd, timer.id, state->expirationTime);
+        } else {
+          CloseConnection(loop, loop.connections.Get(timer.fd));
+        }
+      });
+    }
+
+    /**
+     * Closes the connection and releases its slot
+     *
+     * If an io_uring operation is in flight, the socket is shut down instead.
+     * The slot is then released once the operation completed (see StartUringLoop).
+     */
+    void CloseConnection(internal::LoopState &loop, internal::ConnectionSlab::Slot &slot) {
+      if (slot.state.value().fd.InFlight()) {
+        // The kernel still references the connection buffers, shutdown forces the operation to complete
+        slot.state.value().fd.Shutdown();
+        return;
+      }
+      // Release the slot, this will destruct the FileDescriptor which cleans up the socket.
+      loop.connections.Release(slot);
+    }
 
-          
-          // If the event is from a connection
-          else {
-            // Find ConnectionState object
-            auto conStateIter = conStateMap.find(conEvents[i].data.fd);
-            if (conStateIter == conStateMap.end()) {
-              // If object is not found, try deleting it from epoll as it is
-              // from simplehttp considered as "unmanaged".
-              epoll_ctl(epollInstance.getfd(), EPOLL_CTL_DEL, conEvents[i].data.fd, nullptr);
-              continue;
-            }
-            // Handle connection, if false is returned, connection is cleaned up
-            if (!HandleConnection(conEvents[i], conStateIter->second)) {
-              // Erase from map, this will destruct the FileDescriptor which cleans up the socket.
-              conStateMap.erase(conStateIter);
-              continue;
-            };
+    /**
+     * Resumes the functions of all connections posted to the wake queue of the loop
+     *
+     * Entries of waits that no longer exist (e.g. the connection was closed or the wait timed out) are skipped.
+     */
+    void ProcessWakeups(internal::LoopState &loop) {
+      for (auto &entry : loop.wakeQueue->Take()) {
+        auto *state = loop.connections.Find(entry.fd);
+        if (!state || state->waitId != entry.id || state->wait != internal::WaitState::PENDING) continue;
+        state->wait = internal::WaitState::READY;
+        WakeConnection(loop, loop.connections.Get(entry.fd));
+      }
+    }
 
-            // Update epoll interest for the connection, if false is returned, connection is cleaned up
-            if (!UpdateEventInterest(epollInstance, conEvents[i], conStateIter->second.stage)) {
-              // Erase from map, this will destruct the FileDescriptor which cleans up the socket.
-              conStateMap.erase(conStateIter);
-              continue;
-            };
-          }
+    /**
+     * Resumes the functions whose awaited filedescriptors are ready
+     *
+     * Watches are registered oneshot by the awaitables of waiting functions, which unregister them
+     * before they are destroyed. A resumed function only destroys its own watch, therefore the other
+     * watches reported in the same batch remain valid.
+     */
+    void ProcessWatches(internal::LoopState &loop) {
+      // Maximum watches taken from the watch instance at once
+      constexpr int maxWatchEvents = 64;
+      struct epoll_event watchEvents[maxWatchEvents];
+      while (1) {
+        int n = epoll_wait(loop.watchInstance.getfd(), watchEvents, maxWatchEvents, 0);
+        for (int i = 0; i < n; i++) {
+          auto &watch = *static_cast<internal::FdWatch*>(watchEvents[i].data.ptr);
+          auto *state = loop.connections.Find(watch.connectionFd);
+          if (!state || state->waitId != watch.waitId || state->wait != internal::WaitState::PENDING) continue;
+          watch.events = watchEvents[i].events;
+          state->wait = internal::WaitState::READY;
+          WakeConnection(loop, loop.connections.Get(watch.connectionFd));
         }
+        // Continue while the batch was full (more watches may be ready)
+        if (n < maxWatchEvents) return;
       }
     }
 
+    /**
+     * Completes the waits whose timers are due (sleeps and timeouts of waiting functions)
+     *
+     * Timers of waits that no longer exist are skipped.
+     */
+    void ExpireWaits(internal::LoopState &loop, chrono::steady_clock::time_point now) {
+      loop.waitTimers.Advance(now, [&](const internal::helper::TimerWheel::Timer &timer) {
+        auto *state = loop.connections.Find(timer.fd);
+        if (!state || state->wait != internal::WaitState::PENDING) return;
+        if (timer.id == state->waitId) {
+          // Sleep completed
+          state->wait = internal::WaitState::READY;
+        } else if (timer.id == state->timeoutId) {
+          // Timeout expired before the event occured
+          state->wait = internal::WaitState::EXPIRED;
+        } else return;
+        WakeConnection(loop, loop.connections.Get(timer.fd));
+      });
+    }
+
+    /**
+     * Returns the time in milliseconds until the next timer of the loop is due
+     *
+     * Returns -1 if no timer is set (can be directly used as epoll_wait / io_uring timeout)
+     */
+    int NextTimeout(internal::LoopState &loop, chrono::steady_clock::time_point now) {
+      int connectionTimeout = loop.timerWheel.NextTimeout(now);
+      int waitTimeout = loop.waitTimers.NextTimeout(now);
+      if (connectionTimeout < 0) return waitTimeout;
+      if (waitTimeout < 0) return connectionTimeout;
+      return min(connectionTimeout, waitTimeout);
+    }
+
+    /**
+     * Processes a connection whose function is ready to be resumed (see ProcessWait)
+     *
+     * The state machine is invoked without readiness, so that the function is resumed
+     * and the responses it queued are sent.
+     */
+    void WakeConnection(internal::LoopState &loop, internal::ConnectionSlab::Slot &slot) {
+      auto &state = slot.state.value();
+      struct epoll_event event;
+      event.events = 0;
+      event.data.ptr = &slot;
+
+      bool healthy;
+      if (loop.uring) {
+        // If an operation is in flight, the function is resumed once it completed
+        if (state.fd.InFlight()) return;
+        healthy = DriveUringConnection(loop, slot, 0);
+      } else if (config.edgeTriggered) {
+        healthy = DriveEdgeConnection(event, state);
+      } else {
+        healthy = HandleConnection(event, state) && UpdateEventInterest(loop.epollInstance, slot);
+      }
+      // Close the connection if false was returned
+      if (!healthy) CloseConnection(loop, slot);
+    }
 
     /**
      * Initializes a tcp connection
      *
-     * Returns a valid connectionState if the connection is established
+     * The connection is opened in the slot of its socket, reusing the state of the former connection of the slot
+     *
+     * Returns the connectionState if the connection is established
      *
-     * Returns nullopt if the connection could not be established
+     * Returns nullptr if the connection could not be established
      */
-    optional<internal::ConnectionState> InitializeConnection(struct epoll_event &event) {
+    internal::ConnectionState* InitializeConnection(internal::LoopState &loop) {
 
       // Prepare accept() attributes
-      struct sockaddr conSockAddr = coreSockAddr;
+      struct sockaddr_storage conSockAddr = coreSockAddr;
       socklen_t conSockLen = sizeof(conSockAddr);
       // Accept connections if any (if no waiting connection, it will result will be -1 and is skipped)
       // Socket is immediately wrapped with a FileDescriptor, by this if any further action fails
       // (like e.g. epoll_ctl), the socket will be cleaned up correctly at the end of the scope
-      internal::helper::FileDescriptor conSocket(accept(coreSocket.getfd(), &conSockAddr, &conSockLen));
-      // On failure return nullopt
-      if (conSocket.getfd() < 1) return nullopt;
+      internal::helper::FileDescriptor conSocket(accept(loop.coreSockfd, (struct sockaddr *)&conSockAddr, &conSockLen));
+      // On failure return nullptr
+      if (conSocket.getfd() < 1) return nullptr;
 
       // Retrieve current socket flags
-      sockFlags = fcntl(conSocket.getfd(), F_GETFL, 0);
-      if (sockFlags < 0) return nullopt;
+      int sockFlags = fcntl(conSocket.getfd(), F_GETFL, 0);
+      if (sockFlags < 0) return nullptr;
 
       // Add nonblocking flag to the flags
       sockFlags = sockFlags | O_NONBLOCK;
 
       // Set updated flag
       int res = fcntl(conSocket.getfd(), F_SETFL, sockFlags);
-      if (res < 0) return nullopt;
+      if (res < 0) return nullptr;
       
       // Create conEvent with EPOLLIN interest
+      // Edge triggered connections are registered once for all events (see DriveEdgeConnection)
       struct epoll_event conEvent;
-      conEvent.events = EPOLLIN;
-      // Add custom fd to identify the connection
-      conEvent.data.fd = conSocket.getfd();
+      conEvent.events = config.edgeTriggered ? EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET : EPOLLIN;
+      // Add the slot of the fd to identify the connection
+      conEvent.data.ptr = &loop.connections.Get(conSocket.getfd());
       // Add connection to list of interest on epoll instance
-      res = epoll_ctl(epollInstance.getfd(), EPOLL_CTL_ADD, conSocket.getfd(), &conEvent);
+      res = epoll_ctl(loop.epollInstance.getfd(), EPOLL_CTL_ADD, conSocket.getfd(), &conEvent);
       if (res == 0) {
-        // Move the socket to the returned ConnectionState
-        return internal::ConnectionState{
-          // Move filedescriptor from conSocket
-          .fd = std::move(conSocket),
-          // Set stage to REQ
-          .stage = internal::Stage::REQ,
-          // Set expiration time
-          .expirationTime = chrono::system_clock::now() + config.connectionTimeout
-        };
-      } else return nullopt;
+        // Move the socket to the ConnectionState of its slot
+        auto &conState = loop.connections.Open(std::move(conSocket)).state.value();
+        // Assign unique connection id
+        conState.id = loop.nextConnectionId++;
+        // Set expiration time
+        conState.expirationTime = chrono::steady_clock::now() + config.connectionTimeout;
+        // Set registered event interest
+        conState.events = conEvent.events;
+        // Set metrics state
+        InitializeConnectionMetrics(loop, conState.metrics);
+        return &conState;
+      } else return nullptr;
     }
 
 
     /**
      * Handle ongoing connection based on the epoll_event reported and the associated ConnectionState
      *
+     * Input (requests / bodies) and output (queued responses) are handled independently:
+     * - on EPOLLOUT queued responses are sent first
+     * - on EPOLLIN (or if input was paused) requests are processed. If a request is completed
+     *   without blocking, the next (pipelined) request in the buffer is processed immediately.
+     *   If the queued responses exceed maxResponseQueueSize, input is paused until they are sent.
+     *   A function blocked on its streamed response (FUNC_RES) is resumed once the data was sent,
+     *   a function waiting on another event (FUNC_WAIT) once the event occured.
+     * - finally all responses queued in this iteration are sent at once
+     *
      * Returns true if the eventloop can process
      *
      * Returns false to indicate that the connection should be closed (on tcp layer)
@@ -2452,90 +7530,156 @@ namespace SimpleHTTP {
       }
 
       // Capture current time and add it to the connectionTimeout
-      state.expirationTime = chrono::system_clock::now() + config.connectionTimeout;
+      // The timer wheel is not touched, expired timers are rescheduled lazily (see ExpireConnections)
+      state.expirationTime = chrono::steady_clock::now() + config.connectionTimeout;
 
-      // Handle current stage
-      switch (state.stage) {
-      case internal::Stage::REQ:
-        // Only process if EPOLLIN event is reported
-        if (event.events & EPOLLIN)
+      // Send queued responses if the socket is writable
+      if (event.events & EPOLLOUT && !state.resQueue.empty()) {
+        if (!ProcessResponse(state)) return false;
+      }
+
+      // Process input if data is available, if input was paused or if the function waits on another event
+      bool processInput = event.events & EPOLLIN || state.inputPaused ||
+        state.stage==internal::Stage::FUNC_RES || state.stage==internal::Stage::FUNC_WAIT;
+      while (processInput) {
+        // Pause input until the queued responses are sent
+        if (state.resQueue.size() >= size_t(config.maxResponseQueueSize)) {
+          state.inputPaused = true;
+          break;
+        }
+        state.inputPaused = false;
+
+        // Handle current stage
+        internal::Stage previousStage = state.stage;
+        bool res = true;
+        switch (state.stage) {
+        case internal::Stage::REQ:
           // Continue processing request
           // If encountered critical error, just close connection (erase from map)
-          return ProcessRequest(state);
-        break;
-      case internal::Stage::FUNC_BODY:
-        // Only process if EPOLLIN event is reported
-        if (event.events & EPOLLIN)
+          res = ProcessRequest(state);
+          break;
+        case internal::Stage::FUNC_BODY:
           // Continue process body
           // If encountered critical error, just close connection
-          return ProcessBody(state);
-        break;
-      case internal::Stage::RES:
-        // Only process if EPOLLOUT event is reported
-        if (event.events & EPOLLOUT) {
-          // Continue sending response
-          // If encountered critical error or explicit close request (Connection: close)
-          return ProcessResponse(state);
-        }
-        break;
-      case internal::Stage::CLEANUP:
-        // Only process if EPOLLIN event is reported
-        if (event.events & EPOLLIN)
+          res = ProcessBody(state);
+          break;
+        case internal::Stage::FUNC_RES:
+          // Continue streaming the response
+          // If encountered critical error, just close connection
+          res = ProcessStream(state);
+          break;
+        case internal::Stage::FUNC_WAIT:
+          // Resume the function if its event occured
+          // If encountered critical error, just close connection
+          res = ProcessWait(state);
+          break;
+        case internal::Stage::CLEANUP:
           // Continue cleanup (draining the body)
-          // If encountered critical error or explicit close request (Connection: close)
-          return ProcessCleanup(state);
-        break;
-      default:
-        // Other stages are not invoked by epoll events
-        // but through other stages
-        break;
+          // If encountered critical error, just close connection
+          res = ProcessCleanup(state);
+          break;
+        default:
+          // Other stages are not invoked by events
+          // but through other stages
+          break;
+        }
+        if (!res) return false;
+
+        // Continue with the next request if the current one was completed without blocking
+        // (CLEANUP reached or finished), otherwise wait for the next event
+        bool progressed = state.stage!=previousStage &&
+          (state.stage==internal::Stage::CLEANUP || state.stage==internal::Stage::REQ);
+        if (!progressed) break;
       }
+
+      // Send responses queued in this iteration (coalesced into one send)
+      if (!state.resQueue.empty()) {
+        if (!ProcessResponse(state)) return false;
+      }
+
+      // Close connection once the final responses are sent
+      if (state.stage==internal::Stage::RES && state.resQueue.empty()) return false;
       return true;
     }
 
     /**
-     * Updates the epoll event interest for a connection based on the stage of the connection
+     * Handle edge triggered connection based on the epoll_event reported
+     *
+     * The reported readiness is added to the connection readiness, which is cleared once the socket blocks
+     * in that direction. As no further event is reported until then, the connection is processed
+     * until every direction required by its state blocked (or is not required anymore).
+     *
+     * Returns false to indicate that the connection should be closed (on tcp layer)
+     */
+    bool DriveEdgeConnection(struct epoll_event &event, internal::ConnectionState &state) {
+      // Peer hangup is handled as input, so that the state machine receives the end of the stream
+      if (event.events & (EPOLLIN | EPOLLRDHUP)) state.readiness |= EPOLLIN;
+      if (event.events & EPOLLOUT) state.readiness |= EPOLLOUT;
+
+      while (1) {
+        struct epoll_event readyEvent;
+        readyEvent.events = state.readiness | (event.events & (EPOLLERR | EPOLLHUP));
+        readyEvent.data = event.data;
+        if (!HandleConnection(readyEvent, state)) return false;
+        state.readiness &= ~state.fd.TakeBlockedEvents();
+
+        // Continue while a required direction did not block yet
+        bool inputRequired = !state.inputPaused && (
+          state.stage==internal::Stage::REQ ||
+          state.stage==internal::Stage::FUNC_BODY ||
+          state.stage==internal::Stage::CLEANUP
+        );
+        bool outputRequired = !state.resQueue.empty();
+        if ((inputRequired && state.readiness & EPOLLIN) || (outputRequired && state.readiness & EPOLLOUT)) continue;
+        return true;
+      }
+    }
+
+    /**
+     * Updates the epoll event interest for a connection based on the state of the connection
+     *
+     * EPOLLIN is set if the stage requires input (unless input is paused),
+     * EPOLLOUT is set if responses are queued.
      *
-     * Modifies the event interest list using epoll_ctl.
+     * Modifies the event interest list using epoll_ctl, if the interest changed.
      * This is crucial to prevent triggering events which are not needed.
-     * (e.g. EPOLLOUT event is almost always triggered, but only used while responding)
+     * (e.g. EPOLLOUT event is almost always triggered, but only used while responses are queued)
      *
      * Returns false if the connection should be closed
      */
     bool UpdateEventInterest(
       internal::helper::FileDescriptor &epollSocket,
-      struct epoll_event &event,
-      internal::Stage &stage) {
+      internal::ConnectionSlab::Slot &slot) {
 
-      // Switch stages based on their interest (EPOLLIN/EPOLLOUT)
-      switch (stage) {
+      auto &state = slot.state.value();
+      uint32_t events = 0;
+      // Switch stages based on their interest (EPOLLIN)
+      switch (state.stage) {
       case internal::Stage::REQ:
       case internal::Stage::FUNC_BODY:
       case internal::Stage::CLEANUP:
-        // If event listener is already set to EPOLLIN, skip the modification
-        if (event.events & EPOLLIN) return true;
-        // Set event to EPOLLIN
-        event.events = EPOLLIN;
-        break;
-      case internal::Stage::RES:
-        // If event listener is already set to EPOLLOUT, skip the modification
-        if (event.events & EPOLLOUT) return true;
-        // Set event to EPOLLOUT
-        event.events = EPOLLOUT;
+        if (!state.inputPaused) events |= EPOLLIN;
         break;
       default:
-        // If stage does not involve direct calls from event loop, skip the modification
-        return true;
+        break;
       }
+      if (!state.resQueue.empty()) events |= EPOLLOUT;
+
+      // If event listener is already set, skip the modification
+      if (events==state.events) return true;
 
       // Modify the updated epoll_event
-      int res = epoll_ctl(epollSocket.getfd(), EPOLL_CTL_MOD, event.data.fd, &event);
+      struct epoll_event event;
+      event.events = events;
+      event.data.ptr = &slot;
+      int res = epoll_ctl(epollSocket.getfd(), EPOLL_CTL_MOD, state.fd.getfd(), &event);
       if (res<0) {
         // When the main-loop runs with a misconfigured event (e.g. EPOLLOUT if EPOLLIN is expected)
         // this will lead to performance starvation immediately, to prevent this, the connection is closed
         // without further handling etc.
         return false;
       } else {
+        state.events = events;
         return true;
       }
     }
@@ -2543,39 +7687,55 @@ namespace SimpleHTTP {
     /**
      * Process request based on connection state
      *
+     * Data already in the request buffer (e.g. pipelined requests) is parsed before receiving new data.
+     *
      * Returns false if the connection should be closed
      */
     bool ProcessRequest(internal::ConnectionState &state) {
       while (1) {
-        // We take the socket buffersize to read everything at once (if available)
-        char buffer[config.sockBufferSize+1];
-        int n = recv(state.fd.getfd(), buffer, config.sockBufferSize, 0);
-        if (n < 1) {
-          if (errno == EAGAIN || errno == EWOULDBLOCK) {
-            // Skip if no data is available to read
-            return true;
-          } else {
-            // Exit and close connection on error
-            return false;
-          }
+        // Data delivered by the completion backend (parsed in place, see DriveUringConnection)
+        string_view delivered = state.fd.Delivered();
+        // Record the time of the first byte of the request
+        if (state.metrics.loop && (!state.reqBuffer.empty() || !delivered.empty()) &&
+            state.metrics.requestStart==chrono::steady_clock::time_point{}) {
+          state.metrics.requestStart = chrono::steady_clock::now();
         }
-        // Append string end
-        buffer[n] = '\0';
-        // Append buffer str to state buffer
-        state.reqBuffer += buffer;
-
         // Parse current buffer
         try {
-          // Deserialize request
-          bool res = deserializeRequest(state.reqBuffer, *state.request);
-          // Check if serialized part before cursor exceeds maxHeaderSize.
-          // This check, performed post-serialization, ensures body parts in the buffer
-          // don't affect the count, as deserializeRequest won't move the cursor beyond header size.
-          if (state.reqBuffer.sizeBeforeCursor()>config.maxHeaderSize) {
-            throw runtime_error("Header size exceeds defined maximum size");
+          // Deserialize request (this also enforces the maxHeaderSize)
+          bool res = !state.reqBuffer.empty() && internal::deserializeRequest(state.reqBuffer, *state.request, config.maxHeaderSize);
+          if (!res && state.reqBuffer.empty() && !delivered.empty()) {
+            // If the delivered data holds the full head, it is parsed without copying it to the reqBuffer
+            size_t headSize = internal::deserializeRequest(delivered, *state.request, config.maxHeaderSize);
+            state.fd.Consume(headSize);
+            res = headSize > 0;
           }
-          // If request is not fully deserialized; continue fetching data
+          // If request is not fully deserialized; fetch more data
           if (!res) {
+            if (!delivered.empty()) {
+              // Append the delivered data to the incomplete head
+              state.reqBuffer.insert(delivered.data(), delivered.data()+delivered.size());
+              state.fd.Consume(delivered.size());
+              continue;
+            }
+            // We take the socket buffersize to read everything at once (if available)
+            unsigned char* buffer = internal::helper::ScratchBuffer(config.sockBufferSize);
+            int n = state.fd.Recv(buffer, config.sockBufferSize);
+            if (n == 0) {
+              // Connection was closed by peer
+              return false;
+            }
+            if (n < 1) {
+              if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                // Skip if no data is available to read
+                return true;
+              } else {
+                // Exit and close connection on error
+                return false;
+              }
+            }
+            // Append received data to state buffer
+            state.reqBuffer.insert(buffer, buffer+n);
             continue;
           }
         } catch (exception &e) {
@@ -2584,11 +7744,12 @@ namespace SimpleHTTP {
             .setStatusReason("Bad Request")
             .setContentType("text/plain")
             .setBody(string(e.what())+"\n");
-          state.stage = internal::Stage::RES;
-          return true;
+          // The request cannot be recovered, the connection is closed after the response
+          return QueueResponse(state, true);
         }
 
         // If the request (header) is fully deserialized
+        if (state.metrics.loop) state.metrics.headParsed = chrono::steady_clock::now();
 
         // Analyze transfer encoding
         // Currently only chunked is supported,
@@ -2605,8 +7766,8 @@ namespace SimpleHTTP {
                 .setStatusReason("Not Implemented")
                 .setContentType("text/plain")
                 .setBody("Transfer-Encoding "+encoding+" is not supported\n");
-              state.stage = internal::Stage::RES;
-              return true;
+              // The body cannot be drained, the connection is closed after the response
+              return QueueResponse(state, true);
             }
           }
         }
@@ -2630,13 +7791,13 @@ namespace SimpleHTTP {
         if (isChunked)
           // Create body object and move the rest of the reqBuffer to the body readBuffer.
           // ChunkedBody will interpret data chunked
-          state.body = make_unique<internal::ChunkedBodyImpl>(
-            &state.fd, config.sockBufferSize, std::move(state.reqBuffer)
+          state.body = state.arena->New<internal::ChunkedBodyImpl>(
+            &state.fd, config.sockBufferSize, std::move(state.reqBuffer), config.maxChunkedBodySize
           );
         else
           // Create body object and move the rest of the reqBuffer to the body readBuffer.
           // FixedBody will interpret data with a fixed length
-          state.body = make_unique<internal::FixedBodyImpl>(
+          state.body = state.arena->New<internal::FixedBodyImpl>(
             &state.fd, config.sockBufferSize, bodySize, std::move(state.reqBuffer)
           );
           
@@ -2645,140 +7806,6 @@ namespace SimpleHTTP {
       }
     }
 
-    /**
-     * Deserializes buffer into request
-     *
-     * This function works no matter where the buffer cursor is,
-     * it parses based on the content of the request members.
-     * The function will parse the full buffer into the request.
-     *
-     * Returns true if the full header is deserialized
-     * Returns false if it needs more data to fully deserialize
-     * Parsing errors will lead to an exception
-     */
-    bool deserializeRequest(internal::helper::Buffer &buffer, internal::RequestInternal &request) {
-      string identifier = "";
-      optional<char> c;
-
-      // If method is empty, parse it
-      if (request.getMethod().empty()) {
-        while (1) {
-          if (!(c = buffer.next()).has_value()) {
-            // Rollback buffer as not enough data is provided to parse the method
-            buffer.rollback();
-            return false;
-          }
-          // Read until space
-          if (c.value()==' ') {
-            // Set method and exit loop
-            request.setMethod(identifier);
-            // Commit buffer as the identifier was fully parsed
-            buffer.commit();
-            break;
-          }
-          identifier += c.value();
-        }
-      }
-      // If path is empty, parse it
-      if (request.getPath().empty()) {
-        identifier = "";
-        while (1) {
-          if (!(c = buffer.next()).has_value()) {
-            // Rollback buffer as not enough data is provided to parse the path
-            buffer.rollback();
-            return false;
-          }
-          // Read until space
-          if (c.value()==' ') {
-            // Set path and exit loop
-            request.setPath(identifier);
-            // Commit buffer as the identifier was fully parsed
-            buffer.commit();
-            break;
-          }
-          identifier += c.value();
-        }
-      }
-      // If version is empty, parse it
-      if (request.getVersion().empty()) {
-        identifier = "";
-        while (1) {
-          if (!(c = buffer.next()).has_value()) {
-            // Rollback buffer as not enough data is provided to parse the version
-            buffer.rollback();
-            return false;
-          }
-          // Skip carriage return as termination is based on newline
-          if (c.value()=='\r') continue;
-          // Read until newline
-          if (c.value()=='\n') {
-            // Set version and exit loop
-            request.setVersion(identifier);
-            // Commit buffer as the identifier was fully parsed
-            buffer.commit();
-            break;
-          }
-          identifier += c.value();
-        }
-      }
-
-      // Parse headers
-      identifier = "";
-      while (1) {
-        if (!(c = buffer.next()).has_value()) {
-          // Rollback buffer as not enough data is provided
-          buffer.rollback();
-          return false;
-        }
-        // Skip carriage return as termination is based on newline
-        if (c.value()=='\r') continue;
-        // If newline is read, this indicates the end of the header
-        if (c.value()=='\n') {
-          // Commit buffer and exit deserialization
-          buffer.commit();
-          return true;
-        }
-
-        // Read until key value delimiter
-        if (c.value()==':') {
-          if (!(c = buffer.next()).has_value()) {
-            buffer.rollback();
-            return false;
-          }
-          // Expect ' ' after ':'
-          if (c.value()!=' ') {
-            throw runtime_error(
-              "Expected space (' ') character after colon (':'). Got " + to_string(c.value())
-            );
-          }
-          
-          // Read value
-          string value = "";
-          while (1) {
-            if (!(c = buffer.next()).has_value()) {
-              buffer.rollback();
-              return false;
-            }
-
-            // Skip carriage return as termination is based on newline
-            if (c.value()=='\r') continue;
-            // If newline is read, this indicates the end of this header
-            if (c.value()=='\n') {
-              // Set header
-              request.setHeader(identifier, value);
-              // Reset identifier
-              identifier = "";
-              // Commit and exit loop
-              buffer.commit();
-              break;
-            }
-            value += c.value();
-          }
-        } else
-          identifier += c.value();
-      }
-    }
-
     /**
      * Initialize user defined function (coroutine)
      *
@@ -2787,32 +7814,40 @@ namespace SimpleHTTP {
      * Returns false if the connection should be closed
      */
     bool InitializeFunction(internal::ConnectionState &state) {
-      // Find route
-      auto routeIter = routeMap.find(state.request->getPath());
-      if (routeIter == routeMap.end()) {
+      // Find route (captured path parameters are stored on the request)
+      auto route = routeTree.Find(state.request->getPathView(), state.request->getPathParams());
+      if (!route) {
         (*state.response)
           .setStatusCode(404)
           .setStatusReason("Not Found")
           .setContentType("text/plain")
           .setBody("The requested resource "+state.request->getPath()+" was not found on this server\n");
-        state.stage = internal::RES;
-        return true;
+        return QueueResponse(state);
       }
       // Find type / method on the route
-      auto handlerIter = routeIter->second.find(state.request->getMethod());
-      if (handlerIter == routeIter->second.end()) {
+      auto handlerIter = route->find(state.request->getMethod());
+      if (handlerIter == route->end()) {
         (*state.response)
           .setStatusCode(405)
           .setStatusReason("Method Not Allowed")
           .setContentType("text/plain")
           .setBody("The method '"+state.request->getMethod()+"' is not allowed for the requested resource\n");
-        state.stage = internal::RES;
-        return true;
+        return QueueResponse(state);
       }
 
+      // Record metrics for the route
+      state.metrics.route = handlerIter->second.metricsIndex;
+
+      // Attach connection, so that the function can stream the response
+      state.response->attachConnection(&state.fd, &state.resQueue, config.maxResponseQueueSize);
+
       // Create function handle
       // Coroutine is immediately suspended due to the promise which uses suspend_always as initial_suspend
-      state.funcHandle = handlerIter->second(*state.request, *state.body, *state.response);
+      // The coroutine frame is allocated on the arena of the connection
+      {
+        internal::helper::Arena::Scope arenaScope(state.arena.get());
+        state.funcHandle = handlerIter->second.func(*state.request, *state.body, *state.response);
+      }
 
       // Directly start processing coroutine
       return ProcessFunction(state);
@@ -2827,23 +7862,35 @@ namespace SimpleHTTP {
       // Resume function execution
       // Unhandled exceptions of the function are NOT catched
       // If an exception is thrown in the user defined function it is thrown to the caller of Serve()
+      // Coroutines created by the function are allocated on the arena of the connection
+      internal::helper::Arena::Scope arenaScope(state.arena.get());
+      // Awaitables suspending the function on other events register the wakeup on this connection
+      internal::FunctionContext::Scope contextScope(&state);
       auto res = state.funcHandle.resume();
 
       if (res.has_value()) {
         // If has value, the function returned
         if (res.value()) {
-          // If returned successful set stage to response
-          state.stage = internal::Stage::RES;
-          return true;
+          // If returned successful queue the response
+          return QueueResponse(state);
         } else {
           // If false is returned, the TCP connection is closed after the response.
           // This can be beneficial when a large unread body is provided by the client,
           // avoiding the need to drain the body and potentially increasing performance.
           // Set connection header to close, this will close the tcp socket
           state.request->setHeader("connection", "close");
-          state.stage = internal::Stage::RES;
-          return true;
+          return QueueResponse(state);
         }
+      } else if (state.wait==internal::WaitState::PENDING) {
+        // If no value was provided and the function waits on another event, it is resumed once the event occured
+        state.stage = internal::Stage::FUNC_WAIT;
+        state.waitDeadline = chrono::steady_clock::now() + config.waitTimeout;
+        return true;
+      } else if (state.response->hasWriteRequest()) {
+        // If no value was provided and a write request is pending, the function blocks on the socket
+        // The request was already processed by the awaitable, therefore it continues on the next event
+        state.stage = internal::Stage::FUNC_RES;
+        return true;
       } else {
         // If no value was provided, the function blocks
         state.stage = internal::Stage::FUNC_BODY;
@@ -2864,6 +7911,16 @@ namespace SimpleHTTP {
           // If the request processor returns true, coroutine can be resumed
           state.stage = internal::Stage::FUNC_PROC;
           return ProcessFunction(state);
+        } else if (state.body->isSpliceBlocked()) {
+          // If writing the body to the filedescriptor blocks, the function waits until it is writable
+          // The loop continues moving the body once the watch reported the readiness (see ProcessWait)
+          auto *loop = internal::FunctionContext::loop;
+          state.body->watchSpliceTarget(loop->watchInstance.getfd(), state.fd.getfd(), loop->nextWaitId);
+          state.wait = internal::WaitState::PENDING;
+          state.waitId = loop->nextWaitId++;
+          state.stage = internal::Stage::FUNC_WAIT;
+          state.waitDeadline = chrono::steady_clock::now() + config.waitTimeout;
+          return true;
         } else {
           // If the request processor returns false it needs to read more data
           // In order to do this, the stage remains FUNC_BODY and is processed in the next event loop
@@ -2871,95 +7928,130 @@ namespace SimpleHTTP {
         }
       } catch (exception &e) {
         // Exception occured on reading body
+        // If the head was already sent, no error response can be sent
+        if (state.response->isStreaming()) return false;
         (*state.response)
           .setStatusCode(400)
           .setStatusReason("Bad Request")
           .setContentType("text/plain")
           .setBody("Invalid body encoding. "+string(e.what())+"\n");
-        state.stage = internal::Stage::RES;
-        return true;
+        // The body cannot be drained, the connection is closed after the response
+        return QueueResponse(state, true);
       }
     }
 
     /**
-     * Process response based on connection state
+     * Process response write request which blocks the user defined function
      *
      * Returns false if the connection should be closed
      */
-    bool ProcessResponse(internal::ConnectionState &state) {
-      if (state.resBuffer.empty()) {
-        // Set date header to now
-        state.response->setDate(chrono::system_clock::now());
-        // Serialize response
-        serializeResponse(*state.response, state.resBuffer);
-      }
-      while(1) {
-        int n = send(
-          state.fd.getfd(),
-          state.resBuffer.cstrAfterCursor(),
-          state.resBuffer.sizeAfterCursor(), 0
-        );
-        if (n < 1) {
-          if (errno == EAGAIN || errno == EWOULDBLOCK) {
-            // Skip if no data is available to read
-            return true;
-          } else {
-            // Exit and close connection on error
-            return false;
-          }
-        }
-        // Increment res buffer by the read bytes
-        state.resBuffer.increment(n);
-        // Check if all data is sent, if yes the operation is finished
-        // 'cause sizeAfterCursor includes the cursor, 1 means everything is processed
-        if (state.resBuffer.sizeAfterCursor() <= 1) {
-          if (state.request->getHeader("connection")=="close") {
-            // If connection header is set to "close". Explicitly close the connection
-            return false;
-          } else {
-            // If connection is set to keep-alive, drain the body (if not already done).
-            state.stage = internal::Stage::CLEANUP;
-            return ProcessCleanup(state);
-          }
+    bool ProcessStream(internal::ConnectionState &state) {
+      try {
+        // Handle pending request
+        if (state.response->processRequest()) {
+          // If the request processor returns true, coroutine can be resumed
+          state.stage = internal::Stage::FUNC_PROC;
+          return ProcessFunction(state);
+        } else {
+          // If the request processor returns false the socket blocks
+          // In order to continue, the stage remains FUNC_RES and is processed in the next event loop
+          return true;
         }
+      } catch (exception &_) {
+        // Exception occured while sending the response
+        // Close underlying connection
+        return false;
       }
     }
 
     /**
-     * Serializes response into buffer
+     * Process function waiting on an event outside of the connection
      *
-     * Unlike the deserialization function, this will serialize the full response into the buffer
-     * at once.
+     * Returns false if the connection should be closed
      */
-    void serializeResponse(internal::ResponseInternal &response, internal::helper::Buffer &buffer) {
-      // Initialize buffer with status line 
-      buffer =
-        format(
-          "{} {} {}\r\n",
-          response.getVersion(),
-          response.getStatusCode(),
-          response.getStatusReason()
-        );
+    bool ProcessWait(internal::ConnectionState &state) {
+      // If the event did not occur yet, the stage remains FUNC_WAIT
+      if (state.wait==internal::WaitState::PENDING) return true;
+      // The wait is consumed, only its outcome is kept for the awaitable (see withTimeout())
+      state.waitExpired = state.wait==internal::WaitState::EXPIRED;
+      state.wait = internal::WaitState::NONE;
+      state.waitId = 0;
+      if (state.body && state.body->unwatchSpliceTarget()) {
+        // The function waited on the filedescriptor of its body splice, continue moving the body
+        state.stage = internal::Stage::FUNC_BODY;
+        return ProcessBody(state);
+      }
+      state.stage = internal::Stage::FUNC_PROC;
+      return ProcessFunction(state);
+    }
 
-      // Iterate over all headers and append them
-      for (auto &header : response.getHeaders()) {
-        // Skip empty headers
-        if (header.second.empty()) {
-          continue;
+    /**
+     * Queues the response of the current request
+     *
+     * The response is serialized and appended to the response queue, which is sent by the event loop
+     * (see HandleConnection). This allows responses of pipelined requests to be coalesced.
+     *
+     * Afterwards the stage is set to CLEANUP to drain the body and to continue with the next request.
+     * If close is set (or the connection header is set to "close"), the stage is set to RES instead,
+     * which closes the connection once all queued responses are sent.
+     *
+     * Returns false if the connection should be closed
+     */
+    bool QueueResponse(internal::ConnectionState &state, bool close=false) {
+      // Close the connection instead of draining a large unread body
+      if (!close && state.body) {
+        optional<size_t> remaining = state.body->remainingSize();
+        if (remaining.has_value() && remaining.value() > size_t(config.maxDrainSize)) {
+          close = true;
+          if (!state.response->isStreaming()) state.response->setHeader("Connection", "close");
         }
-        // Append header to the buffer
-        buffer += format(
-          "{}: {}\r\n",
-          header.first,
-          header.second
-        );
+      }
+      if (state.response->isStreaming()) {
+        // If the head was already queued, terminate the streamed body
+        state.response->finishStream();
+      } else {
+        // Serialize response (the Date header is taken from the cache of the loop)
+        internal::serializeResponse(*state.response, state.resQueue);
       }
 
-      // Append body to the buffer
-      buffer += format(
-        "\r\n{}",
-        response.getBody()
-      );
+      if (close || state.request->getHeader("connection")=="close") {
+        // If connection header is set to "close". Explicitly close the connection after the response
+        state.stage = internal::Stage::RES;
+        if (state.metrics.loop) RecordResponse(state, true);
+      } else {
+        if (state.metrics.loop) RecordResponse(state, false);
+        // If connection is set to keep-alive, drain the body (if not already done).
+        state.stage = internal::Stage::CLEANUP;
+      }
+      return true;
+    }
+
+    /**
+     * Sends queued responses
+     *
+     * The queued data segments are sent with a single scatter-gather call per iteration,
+     * file segments are sent from the page cache (see helper::SendQueued()).
+     * Sent data is consumed from the response queue.
+     *
+     * Returns false if the connection should be closed
+     */
+    bool ProcessResponse(internal::ConnectionState &state) {
+      while (!state.resQueue.empty()) {
+        ssize_t n = internal::helper::SendQueued(state.fd, state.resQueue, config.maxResponseQueueSize);
+        if (n < 1) {
+          if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            // Skip if the socket blocks
+            return true;
+          } else {
+            // Exit and close connection on error
+            return false;
+          }
+        }
+        // Consume sent data from the res queue
+        state.resQueue.consume(n);
+        if (state.metrics.loop) RecordSentResponses(state);
+      }
+      return true;
     }
 
     /**
@@ -2977,22 +8069,28 @@ namespace SimpleHTTP {
         // Continue draining body
         // If draining the body overfetches data from the socket
         // this data is stored to the overfetchBuffer
-        // and moved to the new ConnectionStates reqBuffer
-        auto overfetchBuffer = state.body->drainBody();
+        // and becomes the reqBuffer of the next request
+        auto overfetchBuffer = state.body->drainBody(config.maxDrainSize);
         if (overfetchBuffer.has_value()) {
-          // If body is fully cleared,
-          // reset connection state by creating a new object and moving the fd
-          // The overfetched buffer is moved to the reqBuffer
-          state = internal::ConnectionState{
-            // Move filedescriptor from old filedescriptor
-            .fd = std::move(state.fd),
-            // Set stage to REQ
-            .stage = internal::Stage::REQ,
-            // Add overfetched buffer
-            .reqBuffer = overfetchBuffer.value(),
-            // Set expiration time
-            .expirationTime = chrono::system_clock::now() + config.connectionTimeout
-          };
+          // If body is fully cleared, record the received bytes of the request
+          // (overfetched data belongs to the next request)
+          uint64_t requestEnd = state.fd.ReceivedBytes() - overfetchBuffer.value().size();
+          if (state.metrics.loop) {
+            state.metrics.loop->Route(state.metrics.route).bytesIn.Add(requestEnd - state.metrics.requestOffset);
+          }
+          state.metrics.NextRequest(requestEnd);
+          // Destroy the objects of the request and reset their arena for the next request
+          state.ResetRequest();
+          // Reset the connection state in place, the socket, the queued responses which are not sent yet,
+          // the metrics and the registered event interest are kept for the next request
+          state.stage = internal::Stage::REQ;
+          // The overfetched buffer (e.g. pipelined requests) becomes the reqBuffer
+          swap(state.reqBuffer, overfetchBuffer.value());
+          // Create the objects of the next request on the reset arena
+          state.CreateRequest();
+          state.wait = internal::WaitState::NONE;
+          // Set expiration time
+          state.expirationTime = chrono::steady_clock::now() + config.connectionTimeout;
           return true;
         } else {
           // If body is not fully cleared,
@@ -3000,10 +8098,200 @@ namespace SimpleHTTP {
           return true;
         }
       } catch (exception &_) {
-        // Exception occured while draining body
-        // Close underlying connection
-        return false;
+        // Exception occured while draining body (e.g. the drain limit was exceeded)
+        // Close underlying connection once the queued responses are sent
+        state.stage = internal::Stage::RES;
+        return true;
+      }
+    }
+
+    /**
+     * Initializes the (cleared) metrics state of a newly accepted connection
+     */
+    void InitializeConnectionMetrics(internal::LoopState &loop, internal::ConnectionMetrics &metrics) {
+      if (!loop.metrics) return;
+      loop.metrics->acceptedConnections.Add(1);
+      metrics.loop = loop.metrics;
+      metrics.accepted = chrono::steady_clock::now();
+    }
+
+    /**
+     * Records the metrics of the queued response
+     *
+     * If closing is set, no further data is processed on the connection,
+     * therefore all data received for the request is recorded.
+     */
+    void RecordResponse(internal::ConnectionState &state, bool closing) {
+      auto &metrics = state.metrics;
+      auto &route = metrics.loop->Route(metrics.route);
+      auto now = chrono::steady_clock::now();
+
+      // Count request by its status class
+      uint statusClass = clamp(state.response->getStatusCode()/100, 1u, 5u);
+      route.requests[statusClass-1].Add(1);
+
+      // Record latencies (unless the request failed before its first byte / head was processed)
+      if (metrics.requestStart != chrono::steady_clock::time_point{}) {
+        if (metrics.accepted != chrono::steady_clock::time_point{}) {
+          route.firstByte.Record(metrics.requestStart - metrics.accepted);
+          metrics.accepted = {};
+        }
+        if (metrics.headParsed != chrono::steady_clock::time_point{}) {
+          route.parse.Record(metrics.headParsed - metrics.requestStart);
+          route.handler.Record(now - metrics.headParsed);
+        }
+      }
+
+      // The response ends after all data currently sent and queued
+      uint64_t end = state.fd.SentBytes() + state.resQueue.size();
+      route.bytesOut.Add(end - metrics.queuedEnd);
+      metrics.queuedEnd = end;
+      metrics.sends.push_back({end, metrics.route, now});
+
+      if (closing) route.bytesIn.Add(state.fd.ReceivedBytes() - metrics.requestOffset);
+    }
+
+    /**
+     * Records the send latency of all responses which are fully sent
+     */
+    void RecordSentResponses(internal::ConnectionState &state) {
+      auto &metrics = state.metrics;
+      uint64_t sent = state.fd.SentBytes();
+      if (metrics.sendsDone == metrics.sends.size() || metrics.sends[metrics.sendsDone].end > sent) return;
+
+      auto now = chrono::steady_clock::now();
+      while (metrics.sendsDone < metrics.sends.size() && metrics.sends[metrics.sendsDone].end <= sent) {
+        auto &pending = metrics.sends[metrics.sendsDone++];
+        metrics.loop->Route(pending.route).send.Record(now - pending.queued);
+      }
+      // Clear the list once all responses are sent (keeps the capacity)
+      if (metrics.sendsDone == metrics.sends.size()) {
+        metrics.sends.clear();
+        metrics.sendsDone = 0;
+      }
+    }
+
+    /**
+     * Serializes the metrics of all loops in the Prometheus text exposition format
+     */
+    string SerializeMetrics() {
+      using internal::helper::LatencyHistogram;
+      string out;
+
+      // Sums up a counter of all loops
+      auto sumLoops = [&](auto counter) {
+        uint64_t sum = 0;
+        for (auto &loop : loopMetrics) sum += counter(*loop).Get();
+        return sum;
+      };
+      // Sums up a counter of the route on all loops
+      auto sumRoutes = [&](size_t index, auto counter) {
+        uint64_t sum = 0;
+        for (auto &loop : loopMetrics) {
+          if (index < loop->routeCount) sum += counter(loop->routes[index]).Get();
+        }
+        return sum;
+      };
+      // Escapes a label value
+      auto escape = [](const string &value) {
+        string escaped;
+        for (char c : value) {
+          if (c=='\\' || c=='"') escaped += '\\';
+          if (c=='\n') escaped += "\\n";
+          else escaped += c;
+        }
+        return escaped;
+      };
+      // Returns the labels of the route followed by a comma (unmatched requests have no route labels)
+      auto routeLabelsOf = [&](size_t index) -> string {
+        if (index==0) return "";
+        return format("method=\"{}\",route=\"{}\",", escape(routeLabels[index].first), escape(routeLabels[index].second));
+      };
+      // Appends the help and type line of a metric
+      auto appendHead = [&](string_view name, string_view type, string_view help) {
+        out += format("# HELP {} {}\n# TYPE {} {}\n", name, help, name, type);
+      };
+
+      appendHead("simplehttp_requests_total", "counter", "Handled requests by route, method and status class.");
+      for (size_t i = 0; i < routeLabels.size(); i++) {
+        for (size_t statusClass = 0; statusClass < 5; statusClass++) {
+          uint64_t count = sumRoutes(i, [&](auto &route) -> auto& { return route.requests[statusClass]; });
+          if (count==0) continue;
+          out += format("simplehttp_requests_total{{{}code=\"{}xx\"}} {}\n", routeLabelsOf(i), statusClass+1, count);
+        }
       }
+
+      // Counters per route
+      auto appendRouteCounter = [&](string_view name, string_view help, auto counter) {
+        appendHead(name, "counter", help);
+        for (size_t i = 0; i < routeLabels.size(); i++) {
+          uint64_t count = sumRoutes(i, counter);
+          if (count==0) continue;
+          string labels = routeLabelsOf(i);
+          if (!labels.empty()) labels.pop_back();
+          out += format("{}{{{}}} {}\n", name, labels, count);
+        }
+      };
+      appendRouteCounter("simplehttp_received_bytes_total", "Received bytes (request head and body) by route and method.",
+        [](auto &route) -> auto& { return route.bytesIn; });
+      appendRouteCounter("simplehttp_sent_bytes_total", "Sent bytes (response head and body) by route and method.",
+        [](auto &route) -> auto& { return route.bytesOut; });
+
+      // Latency histograms per route
+      auto appendRouteHistogram = [&](string_view name, string_view help, auto histogram) {
+        appendHead(name, "histogram", help);
+        for (size_t i = 0; i < routeLabels.size(); i++) {
+          // Sum up buckets of all loops
+          uint64_t buckets[LatencyHistogram::bucketCount] = {};
+          uint64_t sum = 0;
+          for (auto &loop : loopMetrics) {
+            if (i >= loop->routeCount) continue;
+            auto &loopHistogram = histogram(loop->routes[i]);
+            for (size_t b = 0; b < LatencyHistogram::bucketCount; b++) buckets[b] += loopHistogram.Count(b);
+            sum += loopHistogram.Sum();
+          }
+          uint64_t count = 0;
+          for (auto bucket : buckets) count += bucket;
+          if (count==0) continue;
+
+          string labels = routeLabelsOf(i);
+          // Buckets are cumulative in the exposition format
+          uint64_t cumulative = 0;
+          for (size_t b = 0; b < LatencyHistogram::bucketCount; b++) {
+            cumulative += buckets[b];
+            string bound = b < size(LatencyHistogram::bounds)
+              ? format("{}", double(LatencyHistogram::bounds[b]) / 1e9)
+              : "+Inf";
+            out += format("{}_bucket{{{}le=\"{}\"}} {}\n", name, labels, bound, cumulative);
+          }
+          if (!labels.empty()) labels.pop_back();
+          out += format("{}_sum{{{}}} {}\n", name, labels, double(sum) / 1e9);
+          out += format("{}_count{{{}}} {}\n", name, labels, count);
+        }
+      };
+      appendRouteHistogram("simplehttp_first_byte_seconds",
+        "Time from accepting the connection until the first byte of its first request.",
+        [](auto &route) -> auto& { return route.firstByte; });
+      appendRouteHistogram("simplehttp_parse_seconds",
+        "Time from the first byte of the request until its head is parsed.",
+        [](auto &route) -> auto& { return route.parse; });
+      appendRouteHistogram("simplehttp_handler_seconds",
+        "Time from the parsed head until the response is queued.",
+        [](auto &route) -> auto& { return route.handler; });
+      appendRouteHistogram("simplehttp_send_seconds",
+        "Time from queueing the response until it is fully sent.",
+        [](auto &route) -> auto& { return route.send; });
+
+      // Loop metrics
+      appendHead("simplehttp_open_connections", "gauge", "Currently open connections.");
+      out += format("simplehttp_open_connections {}\n", sumLoops([](auto &loop) -> auto& { return loop.openConnections; }));
+      appendHead("simplehttp_accepted_connections_total", "counter", "Accepted connections.");
+      out += format("simplehttp_accepted_connections_total {}\n", sumLoops([](auto &loop) -> auto& { return loop.acceptedConnections; }));
+      appendHead("simplehttp_loop_wakeups_total", "counter", "Wakeups of the event loops (epoll_wait / io_uring_enter).");
+      out += format("simplehttp_loop_wakeups_total {}\n", sumLoops([](auto &loop) -> auto& { return loop.wakeups; }));
+      appendHead("simplehttp_loop_events_total", "counter", "Events handled by the event loops (epoll events / completions).");
+      out += format("simplehttp_loop_events_total {}\n", sumLoops([](auto &loop) -> auto& { return loop.events; }));
+      return out;
     }
   };
 } // namespace SimpleHTTP
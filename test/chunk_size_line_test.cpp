@@ -0,0 +1,239 @@
+#include <iostream>
+#include <string>
+#include <thread>
+#include <future>
+#include <vector>
+
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+
+#include "src/simplehttp.hpp"
+
+using namespace std;
+
+using namespace SimpleHTTP;
+
+// Attempts to connect to the server with exponential backoff.
+// Returns the socket on success, or -1 on failure.
+int tryConnect(const string& host, int port, int maxRetries, int maxDelaySeconds) {
+  int retries = 0;
+  int delaySeconds = 1; // Initial delay is 1 sec
+
+  struct sockaddr_in addr = {};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  inet_pton(AF_INET, host.c_str(), &addr.sin_addr);
+
+  // Try until max retries are reached
+  while (retries < maxRetries) {
+    int sock = socket(AF_INET, SOCK_STREAM, 0);
+    if (sock < 0) return -1;
+    // Check if the operation was successful
+    if (connect(sock, (struct sockaddr*)&addr, sizeof(addr)) == 0) return sock;
+    close(sock);
+    // If not successful, wait for the exponential backoff delay
+    this_thread::sleep_for(std::chrono::seconds(delaySeconds));
+
+    // Update retries and increment delay
+    retries++;
+    delaySeconds *= 2;
+    // If max delay is reached, cap the delay
+    if (delaySeconds > maxDelaySeconds)
+      delaySeconds = maxDelaySeconds;
+  }
+  // If all retries are exhausted, return failure
+  cerr << "Connection failed after " << maxRetries << " retries\n";
+  return -1;
+}
+
+// Sends all data to the socket
+bool sendAll(int sock, const string& data) {
+  size_t sent = 0;
+  while (sent < data.size()) {
+    ssize_t n = send(sock, data.data()+sent, data.size()-sent, MSG_NOSIGNAL);
+    if (n < 1) return false;
+    sent += n;
+  }
+  return true;
+}
+
+// Reads a single response from the socket and returns its status code and body.
+// Responses are expected to contain a content-length header.
+bool readResponse(int sock, int& statusCode, string& body) {
+  string pending;
+  // Read until the head is complete
+  size_t headEnd;
+  while ((headEnd = pending.find("\r\n\r\n")) == string::npos) {
+    char buffer[4096];
+    ssize_t n = recv(sock, buffer, sizeof(buffer), 0);
+    if (n < 1) return false;
+    pending.append(buffer, n);
+  }
+  string head = pending.substr(0, headEnd);
+  statusCode = stoi(head.substr(head.find(' ')+1, 3));
+
+  // Extract content length
+  size_t contentLength = 0;
+  size_t lengthPos = head.find("Content-Length: ");
+  if (lengthPos != string::npos) {
+    contentLength = stoul(head.substr(lengthPos+16));
+  }
+
+  // Read until the body is complete
+  while (pending.size() < headEnd+4+contentLength) {
+    char buffer[4096];
+    ssize_t n = recv(sock, buffer, sizeof(buffer), 0);
+    if (n < 1) return false;
+    pending.append(buffer, n);
+  }
+  body = pending.substr(headEnd+4, contentLength);
+  return true;
+}
+
+// Encodes the data as one chunk with the size line (e.g. "1000" or "1000;name=value")
+string encodeChunk(const string& sizeLine, const string& data) {
+  return sizeLine + "\r\n" + data + "\r\n";
+}
+
+// Sends the chunked body to the echo route and verifies the response.
+// If expectedBody is nullopt only the status code is checked.
+bool performChunkedTest(const string& host, int port, const string& name, const string& encodedBody,
+                        int expectedCode, const optional<string>& expectedBody) {
+  bool testPassed = false; // Flag to indicate if the test passed or failed.
+
+  int sock = tryConnect(host, port, 1, 1);
+  if (sock < 0) {
+    cerr << "Failed connecting to test server" << endl;
+    return false;
+  }
+
+  string request =
+    "POST /echo HTTP/1.1\r\nHost: localhost\r\nTransfer-Encoding: chunked\r\n\r\n" + encodedBody;
+  int statusCode = 0;
+  string body;
+  // Invalid bodies may close the connection before everything was sent, therefore the send result is ignored
+  sendAll(sock, request);
+  if (!readResponse(sock, statusCode, body)) {
+    cerr << "Test failed for " << name << ": no response" << endl;
+  } else if (statusCode != expectedCode || (expectedBody && body != *expectedBody)) {
+    cerr << "Test failed for " << name << endl;
+    cerr << "Expected response: " << expectedCode << " with " << (expectedBody ? expectedBody->size() : 0)
+         << " bytes but got: " << statusCode << " with " << body.size() << " bytes" << endl;
+  } else {
+    testPassed = true;
+  }
+
+  close(sock);
+  return testPassed;
+}
+
+// Runs all tests against a server running on the event backend.
+bool performBackendTests(EventBackend backend) {
+  // Test server port
+  int port = 8080;
+  // Test server host
+  string host = "127.0.0.1";
+  // Flag to indicate if all tests passed.
+  bool allTestsPassed = true;
+
+  // Create test server
+  Server server(host, port, {
+    // Buffer is smaller then the chunks, so that size lines are split over multiple reads
+    .sockBufferSize = 64,
+    // Bodies larger then two 64KiB chunks are rejected
+    .maxChunkedBodySize = 0x20000,
+    .eventBackend = backend,
+  });
+
+  // This route returns the decoded body.
+  server.Route("POST", "/echo", [](Request &req, Body &body, Response &res) -> Task<bool> {
+    auto data = co_await body.readAll();
+    res.setStatusCode(200).setBody(string(data.begin(), data.end()));
+    co_return true;
+  });
+
+  // Start server in a seperate thread
+  cout << "Starting local test server on " << host << ":" << port << endl;
+  future<void> serverFut = async(launch::async, [&server]() {
+    server.Serve();
+  });
+
+  // Try to connect to the test server (5 retries, 10s maximum delay)
+  int sock = tryConnect(host, port, 5, 10);
+  if (sock < 0) {
+    cerr << "Failed connecting to test server" << endl;
+    server.Kill();
+    serverFut.get();
+    return false;
+  }
+  close(sock);
+
+  string data4k(0x1000, 'a');
+  string data64k(0xFFFF, 'b');
+  string data65k(0x10000, 'c');
+
+  // Chunk sizes with four or more hex digits
+  allTestsPassed &= performChunkedTest(host, port, "4 digits", encodeChunk("1000", data4k) + "0\r\n\r\n",
+                                       200, data4k);
+  allTestsPassed &= performChunkedTest(host, port, "uppercase", encodeChunk("FFFF", data64k) + "0\r\n\r\n",
+                                       200, data64k);
+  allTestsPassed &= performChunkedTest(host, port, "lowercase", encodeChunk("ffff", data64k) + "0\r\n\r\n",
+                                       200, data64k);
+  allTestsPassed &= performChunkedTest(host, port, "5 digits", encodeChunk("10000", data65k) + "0\r\n\r\n",
+                                       200, data65k);
+  allTestsPassed &= performChunkedTest(host, port, "leading zeros",
+                                       encodeChunk("0000000000001000", data4k) + "0\r\n\r\n", 200, data4k);
+  allTestsPassed &= performChunkedTest(host, port, "extension",
+                                       encodeChunk("1000;name=value", data4k) + "0\r\n\r\n", 200, data4k);
+  allTestsPassed &= performChunkedTest(host, port, "multiple chunks",
+                                       encodeChunk("1000", data4k) + encodeChunk("10000", data65k) + "0\r\n\r\n",
+                                       200, data4k + data65k);
+
+  // Invalid size lines
+  allTestsPassed &= performChunkedTest(host, port, "not hex", encodeChunk("zz", "") + "0\r\n\r\n",
+                                       400, nullopt);
+  allTestsPassed &= performChunkedTest(host, port, "empty size", encodeChunk("", "") + "0\r\n\r\n",
+                                       400, nullopt);
+  allTestsPassed &= performChunkedTest(host, port, "line too long",
+                                       encodeChunk("1;" + string(100, 'x'), "a") + "0\r\n\r\n", 400, nullopt);
+
+  // Chunk sizes exceeding the maximum body size
+  allTestsPassed &= performChunkedTest(host, port, "maximum body size",
+                                       encodeChunk("10000", data65k) + encodeChunk("10000", data65k) + "0\r\n\r\n",
+                                       200, data65k + data65k);
+  allTestsPassed &= performChunkedTest(host, port, "chunk above limit", encodeChunk("20001", "") + "0\r\n\r\n",
+                                       400, nullopt);
+  allTestsPassed &= performChunkedTest(host, port, "body above limit",
+                                       encodeChunk("10000", data65k) + encodeChunk("10000", data65k) +
+                                       encodeChunk("1", "d") + "0\r\n\r\n", 400, nullopt);
+  allTestsPassed &= performChunkedTest(host, port, "size_t maximum",
+                                       encodeChunk("1", "a") + encodeChunk("FFFFFFFFFFFFFFFF", "") + "0\r\n\r\n",
+                                       400, nullopt);
+  allTestsPassed &= performChunkedTest(host, port, "size_t overflow",
+                                       encodeChunk("10000000000000001", "") + "0\r\n\r\n", 400, nullopt);
+
+  // Kill test server
+  server.Kill();
+
+  // Wait for the server to exit
+  serverFut.get();
+  return allTestsPassed;
+}
+
+int main(void) {
+  // Flag to indicate if all tests passed.
+  bool allTestsPassed = true;
+
+  allTestsPassed &= performBackendTests(EventBackend::EPOLL);
+  allTestsPassed &= performBackendTests(EventBackend::IO_URING);
+
+  if(allTestsPassed) {
+    cout << "All tests passed." << endl;
+    return 0;
+  } else {
+    cout << "One or more tests failed." << endl;
+    return 1;
+  }
+}
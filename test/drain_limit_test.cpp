@@ -0,0 +1,263 @@
+#include <iostream>
+#include <string>
+#include <thread>
+#include <future>
+#include <filesystem>
+#include <cstring>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+
+#include "src/simplehttp.hpp"
+
+using namespace std;
+
+using namespace SimpleHTTP;
+
+// Opens a connection to the tcp server (if path is empty) or to the unix socket server.
+// Retries with exponential backoff, returns the socket on success, or -1 on failure.
+int tryConnect(const string& host, int port, const string& path, int maxRetries, int maxDelaySeconds) {
+  int retries = 0;
+  int delaySeconds = 1; // Initial delay is 1 sec
+
+  // Try until max retries are reached
+  while (retries < maxRetries) {
+    int sock;
+    int res;
+    if (path.empty()) {
+      struct sockaddr_in addr = {};
+      addr.sin_family = AF_INET;
+      addr.sin_port = htons(port);
+      inet_pton(AF_INET, host.c_str(), &addr.sin_addr);
+      sock = socket(AF_INET, SOCK_STREAM, 0);
+      if (sock < 0) return -1;
+      res = connect(sock, (struct sockaddr*)&addr, sizeof(addr));
+    } else {
+      struct sockaddr_un addr = {};
+      addr.sun_family = AF_UNIX;
+      strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path)-1);
+      sock = socket(AF_UNIX, SOCK_STREAM, 0);
+      if (sock < 0) return -1;
+      res = connect(sock, (struct sockaddr*)&addr, sizeof(addr));
+    }
+    // Check if the operation was successful
+    if (res == 0) return sock;
+    close(sock);
+    // If not successful, wait for the exponential backoff delay
+    this_thread::sleep_for(std::chrono::seconds(delaySeconds));
+
+    // Update retries and increment delay
+    retries++;
+    delaySeconds *= 2;
+    // If max delay is reached, cap the delay
+    if (delaySeconds > maxDelaySeconds)
+      delaySeconds = maxDelaySeconds;
+  }
+  // If all retries are exhausted, return failure
+  cerr << "Connection failed after " << maxRetries << " retries\n";
+  return -1;
+}
+
+// Sends all data to the socket
+bool sendAll(int sock, const string& data) {
+  size_t sent = 0;
+  while (sent < data.size()) {
+    ssize_t n = send(sock, data.data()+sent, data.size()-sent, MSG_NOSIGNAL);
+    if (n < 1) return false;
+    sent += n;
+  }
+  return true;
+}
+
+// Reads a single response from the socket and returns its head and body.
+// Responses are expected to contain a content-length header. Data of following responses
+// remains in the pending buffer.
+bool readResponse(int sock, string& pending, string& head, string& body) {
+  // Read until the head is complete
+  size_t headEnd;
+  while ((headEnd = pending.find("\r\n\r\n")) == string::npos) {
+    char buffer[4096];
+    ssize_t n = recv(sock, buffer, sizeof(buffer), 0);
+    if (n < 1) return false;
+    pending.append(buffer, n);
+  }
+  head = pending.substr(0, headEnd);
+
+  // Extract content length
+  size_t contentLength = 0;
+  size_t lengthPos = head.find("Content-Length: ");
+  if (lengthPos != string::npos) {
+    contentLength = stoul(head.substr(lengthPos+16));
+  }
+
+  // Read until the body is complete
+  while (pending.size() < headEnd+4+contentLength) {
+    char buffer[4096];
+    ssize_t n = recv(sock, buffer, sizeof(buffer), 0);
+    if (n < 1) return false;
+    pending.append(buffer, n);
+  }
+  body = pending.substr(headEnd+4, contentLength);
+  pending.erase(0, headEnd+4+contentLength);
+  return true;
+}
+
+// Returns true if the server closes the connection (without sending further data)
+// A reset is accepted as well, as closing a socket with unread data sends a reset instead of a FIN
+bool waitClosed(int sock) {
+  struct timeval timeout = {5, 0};
+  setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+  char buffer[64];
+  ssize_t n = recv(sock, buffer, sizeof(buffer), 0);
+  return n == 0 || (n < 0 && errno == ECONNRESET);
+}
+
+// Sends the request with an unread body followed by a request to /echo_id.
+// If the body exceeds the drain limit, the connection must be closed after the first response,
+// otherwise the body is drained and the second response is received on the same connection.
+bool performTest(const string& host, int port, const string& path, const string& request, bool expectClose) {
+  bool testPassed = true; // Flag to indicate if the test passed or failed.
+
+  int sock = tryConnect(host, port, path, 1, 1);
+  if (sock < 0) {
+    cerr << "Failed connecting to test server" << endl;
+    return false;
+  }
+
+  string requests = request + "GET /echo_id HTTP/1.1\r\nHost: localhost\r\nId: next\r\n\r\n";
+  // Sending may fail if the server closes the connection before the full body is sent
+  sendAll(sock, requests);
+
+  string pending; // Buffer to store received data of following responses
+  string head;
+  string body;
+  if (!readResponse(sock, pending, head, body) || head.substr(0, 12) != "HTTP/1.1 200" || body != "ignored") {
+    cerr << "Test failed for the request with unread body: " << head.substr(0, 12) << endl;
+    testPassed = false;
+  } else if (expectClose) {
+    if (head.find("Connection: close") == string::npos && request.find("chunked") == string::npos) {
+      cerr << "Test failed, expected \"Connection: close\" in the response" << endl;
+      testPassed = false;
+    }
+    if (!waitClosed(sock)) {
+      cerr << "Test failed, expected the connection to be closed" << endl;
+      testPassed = false;
+    }
+  } else {
+    if (!readResponse(sock, pending, head, body) || body != "next") {
+      cerr << "Test failed for the request following the drained body" << endl;
+      testPassed = false;
+    }
+  }
+
+  close(sock);
+  return testPassed;
+}
+
+// Encodes the body with transfer encoding "chunked" using chunks of the given size.
+string encodeChunked(const string& body, size_t chunkSize) {
+  string encoded;
+  for (size_t offset = 0; offset < body.size(); offset += chunkSize) {
+    string chunk = body.substr(offset, chunkSize);
+    char sizeLine[32];
+    snprintf(sizeLine, sizeof(sizeLine), "%zx\r\n", chunk.size());
+    encoded += sizeLine + chunk + "\r\n";
+  }
+  return encoded + "0\r\n\r\n";
+}
+
+// Runs all tests against the server listening on the tcp port (if path is empty) or the unix socket.
+bool performServerTests(const string& host, int port, const string& path) {
+  // Flag to indicate if all tests passed.
+  bool allTestsPassed = true;
+
+  // Create test server
+  ServerConfiguration config = {
+    // Buffer is smaller then the bodies, to have multiple event loop iterations
+    .sockBufferSize = 700,
+    // Bodies larger then 100000 bytes are not drained
+    .maxDrainSize = 100000,
+  };
+  unique_ptr<Server> server = path.empty()
+    ? make_unique<Server>(host, port, config)
+    : make_unique<Server>(path, config);
+
+  // Define routes
+
+  // This route ignores the body, so that it is drained after the response.
+  server->Route("POST", "/ignore_body", [](Request &req, Body &body, Response &res) -> Task<bool> {
+    res.setStatusCode(200).setBody("ignored");
+    co_return true;
+  });
+
+  // This route echoes the "id" header to verify the order of the responses.
+  server->Route("GET", "/echo_id", [](Request &req, Body &body, Response &res) -> Task<bool> {
+    auto idHeader = req.getHeader("id");
+    res.setStatusCode(200).setBody(idHeader ? *idHeader : "");
+    co_return true;
+  });
+
+  // Start server in a seperate thread
+  cout << "Starting local test server on " << (path.empty() ? host + ":" + to_string(port) : path) << endl;
+  future<void> serverFut = async(launch::async, [&server]() {
+    server->Serve();
+  });
+
+  // Try to connect to the test server (5 retries, 10s maximum delay)
+  int sock = tryConnect(host, port, path, 5, 10);
+  if (sock < 0) {
+    cerr << "Failed connecting to test server" << endl;
+    server->Kill();
+    return false;
+  }
+  close(sock);
+
+  // Test fixed bodies below and above the drain limit
+  string smallBody(50000, 'S');
+  string largeBody(200000, 'L');
+  allTestsPassed &= performTest(host, port, path,
+    "POST /ignore_body HTTP/1.1\r\nHost: localhost\r\nContent-Length: 50000\r\n\r\n" + smallBody, false);
+  allTestsPassed &= performTest(host, port, path,
+    "POST /ignore_body HTTP/1.1\r\nHost: localhost\r\nContent-Length: 200000\r\n\r\n" + largeBody, true);
+
+  // Test a huge announced body, the connection is closed without waiting for the body
+  allTestsPassed &= performTest(host, port, path,
+    "POST /ignore_body HTTP/1.1\r\nHost: localhost\r\nContent-Length: 100000000\r\n\r\n", true);
+
+  // Test chunked bodies below and above the drain limit (with chunks larger then the socket buffer)
+  allTestsPassed &= performTest(host, port, path,
+    "POST /ignore_body HTTP/1.1\r\nHost: localhost\r\nTransfer-Encoding: chunked\r\n\r\n" + encodeChunked(smallBody, 16384), false);
+  allTestsPassed &= performTest(host, port, path,
+    "POST /ignore_body HTTP/1.1\r\nHost: localhost\r\nTransfer-Encoding: chunked\r\n\r\n" + encodeChunked(largeBody, 16384), true);
+
+  // Kill test server
+  server->Kill();
+
+  // Wait for the server to exit
+  serverFut.get();
+  return allTestsPassed;
+}
+
+int main(void) {
+  // Flag to indicate if all tests passed.
+  bool allTestsPassed = true;
+
+  // Tcp sockets discard the drained data with MSG_TRUNC
+  allTestsPassed &= performServerTests("127.0.0.1", 8080, "");
+
+  // Unix sockets do not support MSG_TRUNC, the data is received into a scratch buffer
+  filesystem::path path = filesystem::temp_directory_path() / "simplehttp_drain_limit_test.sock";
+  allTestsPassed &= performServerTests("", 0, path.string());
+  filesystem::remove(path);
+
+  if(allTestsPassed) {
+    cout << "All tests passed." << endl;
+    return 0;
+  } else {
+    cout << "One or more tests failed." << endl;
+    return 1;
+  }
+}
@@ -0,0 +1,204 @@
+#include <iostream>
+#include <string>
+#include <thread>
+#include <future>
+
+#include "curl/curl.h"
+#include "src/simplehttp.hpp"
+
+using namespace std;
+
+using namespace SimpleHTTP;
+
+// Attempts to connect to the server with exponential backoff.
+// Returns CURLE_OK on success, or the CURL error code on failure.
+CURLcode tryConnect(CURL* curl, int maxRetries, int maxDelaySeconds) {
+  int retries = 0;
+  int delaySeconds = 1; // Initial delay is 1 sec
+  CURLcode res; 
+
+  // Check if curl handle is valid
+  if (!curl) return CURLE_FAILED_INIT;
+
+  // Try until max retries are reached
+  while (retries < maxRetries) {
+    res = curl_easy_perform(curl);
+    // Check if the operation was successful
+    if (res == CURLE_OK) return res;
+    // If not successful, wait for the exponential backoff delay
+    this_thread::sleep_for(chrono::seconds(delaySeconds));
+
+    // Update retries and increment delay
+    retries++;
+    delaySeconds *= 2;
+    // If max delay is reached, cap the delay
+    if (delaySeconds > maxDelaySeconds)
+      delaySeconds = maxDelaySeconds;
+  }
+  // If all retries are exhausted, return the last error code
+  cerr << "Connection failed after " << maxRetries << " retries\n";
+  return res;
+}
+
+// Callback function for curl fetch writing data to userp
+size_t curlWriteCallback(void *contents, size_t size, size_t nmemb, string *userp) {
+  userp->append((char*)contents, size * nmemb);
+  return size * nmemb;
+}
+
+// Callback function for curl fetch discarding data
+size_t curlDiscardCallback(void *buffer, size_t size, size_t nmemb, void *userp) {
+  return size * nmemb; // Indicate success but don't write the data
+}
+
+// Performs a GET request and stores the response body in readBuffer.
+// Returns the HTTP response code, or -1 on failure.
+long performGet(CURL *curl, const string& url, string& readBuffer) {
+  long response_code; // Variable to store the HTTP response code.
+
+  // Reset the state of the curl session to its default state.
+  curl_easy_reset(curl);
+  // Set the URL for the CURL request.
+  curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+  // Set the function to handle writing the data received in response.
+  curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, curlWriteCallback);
+  // Set the variable where the response data will be stored.
+  curl_easy_setopt(curl, CURLOPT_WRITEDATA, &readBuffer);
+  // Enable TCP keep-alive on the CURL handle to reuse the connection.
+  curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+
+  CURLcode res = curl_easy_perform(curl);
+  if (res != CURLE_OK) {
+    // Output the CURL error.
+    cerr << "CURL error: " << curl_easy_strerror(res) << endl;
+    return -1;
+  }
+  // Retrieve the HTTP response code.
+  curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response_code);
+  return response_code;
+}
+
+// Checks that the metrics contain a line starting with the expected prefix.
+bool expectMetric(const string& metrics, const string& expectedPrefix) {
+  if (metrics.find("\n"+expectedPrefix) == string::npos) {
+    cerr << "Test failed, metrics do not contain: " << expectedPrefix << endl;
+    return false;
+  }
+  return true;
+}
+
+
+int main(void) {
+  // Test server port
+  int port = 8080;
+  // Test server host
+  string host = "127.0.0.1";
+  // Base URL for the test server.
+  string baseUrl = "http://"+host+":"+to_string(port);
+  // Flag to indicate if all tests passed.
+  bool allTestsPassed = true;
+
+  // Create test server with metrics enabled
+  Server server(host, port, {
+    .metricsPath = "/metrics",
+  });
+
+  // Define routes
+
+  // This route returns a static body.
+  server.Route("GET", "/hello", [](Request &req, Body &_, Response &res) -> Task<bool> {
+    res.setStatusCode(200).setBody("Hello World");
+    co_return true;
+  });
+
+  // This route echoes the body, metrics are recorded for the route pattern instead of the path.
+  server.Route("POST", "/users/:id", [](Request &req, Body &body, Response &res) -> Task<bool> {
+    auto data = co_await body.readAll();
+    res.setStatusCode(201).setBody(string(data.begin(), data.end()));
+    co_return true;
+  });
+
+  
+  // Start server in a seperate thread
+  cout << "Starting local test server on " << host << ":" << port << endl;
+  future<void> serverFut = async(launch::async, [&server]() {
+    server.Serve();
+  });
+
+  // Initialize CURL session.
+  CURL *curl = curl_easy_init();
+  if (!curl) {
+    // Report failure if CURL session wasn't successfully initialized.
+    cerr << "Failed to initialize CURL" << endl;
+    server.Kill();
+    return 1; 
+  }
+
+  // Use hello url to try connection
+  string helloUrl = baseUrl + "/hello";
+  curl_easy_setopt(curl, CURLOPT_URL, helloUrl.c_str());
+  curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, curlDiscardCallback);
+
+  // Try to connect to the test server (5 retries, 10s maximum delay)
+  CURLcode res = tryConnect(curl, 5, 10);
+  if (res != CURLE_OK) {
+    cerr << "Failed connecting to test server: " << curl_easy_strerror(res) << endl;
+    server.Kill();
+    return 1;
+  }
+
+  // Perform requests recorded in the metrics
+  string readBuffer;
+  allTestsPassed &= performGet(curl, helloUrl, readBuffer) == 200;
+  allTestsPassed &= performGet(curl, baseUrl + "/unknown", readBuffer) == 404;
+
+  curl_easy_reset(curl);
+  curl_easy_setopt(curl, CURLOPT_URL, (baseUrl + "/users/42").c_str());
+  curl_easy_setopt(curl, CURLOPT_POSTFIELDS, "some body");
+  curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, curlDiscardCallback);
+  allTestsPassed &= curl_easy_perform(curl) == CURLE_OK;
+
+  // Fetch metrics
+  string metrics;
+  if (performGet(curl, baseUrl + "/metrics", metrics) != 200) {
+    cerr << "Failed fetching metrics" << endl;
+    allTestsPassed = false;
+  }
+  
+  // Test request counters by route, method and status class
+  allTestsPassed &= expectMetric(metrics, "simplehttp_requests_total{method=\"GET\",route=\"/hello\",code=\"2xx\"} 2\n");
+  allTestsPassed &= expectMetric(metrics, "simplehttp_requests_total{method=\"POST\",route=\"/users/:id\",code=\"2xx\"} 1\n");
+  allTestsPassed &= expectMetric(metrics, "simplehttp_requests_total{code=\"4xx\"} 1\n");
+
+  // Test byte counters
+  allTestsPassed &= expectMetric(metrics, "simplehttp_received_bytes_total{method=\"POST\",route=\"/users/:id\"} ");
+  allTestsPassed &= expectMetric(metrics, "simplehttp_sent_bytes_total{method=\"GET\",route=\"/hello\"} ");
+
+  // Test latency histograms
+  allTestsPassed &= expectMetric(metrics, "simplehttp_first_byte_seconds_count{method=\"GET\",route=\"/hello\"} 1\n");
+  allTestsPassed &= expectMetric(metrics, "simplehttp_parse_seconds_count{method=\"GET\",route=\"/hello\"} 2\n");
+  allTestsPassed &= expectMetric(metrics, "simplehttp_handler_seconds_bucket{method=\"GET\",route=\"/hello\",le=\"+Inf\"} 2\n");
+  allTestsPassed &= expectMetric(metrics, "simplehttp_send_seconds_count{method=\"POST\",route=\"/users/:id\"} 1\n");
+
+  // Test loop metrics
+  allTestsPassed &= expectMetric(metrics, "simplehttp_open_connections 1\n");
+  allTestsPassed &= expectMetric(metrics, "simplehttp_accepted_connections_total 1\n");
+
+  // Cleanup curl session
+  curl_easy_cleanup(curl);
+
+  // Kill test server
+  server.Kill();
+
+  // Wait for the server to exit
+  serverFut.get();
+
+  if(allTestsPassed) {
+    cout << "All tests passed." << endl;
+    return 0; // Indicates success
+  } else {
+    cout << "One or more tests failed." << endl;
+    cout << metrics << endl;
+    return 1; // Indicates failure
+  }
+}
@@ -0,0 +1,285 @@
+#include <iostream>
+#include <string>
+#include <thread>
+#include <future>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <cstring>
+
+#include "curl/curl.h"
+#include "src/simplehttp.hpp"
+
+using namespace std;
+
+using namespace SimpleHTTP;
+
+// Attempts to connect to the server with exponential backoff.
+// Returns CURLE_OK on success, or the CURL error code on failure.
+CURLcode tryConnect(CURL* curl, int maxRetries, int maxDelaySeconds) {
+  int retries = 0;
+  int delaySeconds = 1; // Initial delay is 1 sec
+  CURLcode res;
+
+  // Check if curl handle is valid
+  if (!curl) return CURLE_FAILED_INIT;
+
+  // Try until max retries are reached
+  while (retries < maxRetries) {
+    res = curl_easy_perform(curl);
+    // Check if the operation was successful
+    if (res == CURLE_OK) return res;
+    // If not successful, wait for the exponential backoff delay
+    this_thread::sleep_for(std::chrono::seconds(delaySeconds));
+
+    // Update retries and increment delay
+    retries++;
+    delaySeconds *= 2;
+    // If max delay is reached, cap the delay
+    if (delaySeconds > maxDelaySeconds)
+      delaySeconds = maxDelaySeconds;
+  }
+  // If all retries are exhausted, return the last error code
+  cerr << "Connection failed after " << maxRetries << " retries\n";
+  return res;
+}
+
+// Callback function for curl fetch
+size_t curlWriteCallback(void *contents, size_t size, size_t nmemb, string *userp) {
+  userp->append((char*)contents, size * nmemb);
+  return size * nmemb;
+}
+
+// Callback function for curl fetch discarding data
+size_t curlDiscardCallback(void *buffer, size_t size, size_t nmemb, void *userp) {
+  return size * nmemb; // Indicate success but don't write the data
+}
+
+// Stream of the request body sent by curl
+struct UploadStream {
+  const string* data;
+  size_t offset;
+};
+
+// Callback function for curl to read the body (every call is sent as one chunk if the body is chunked)
+size_t curlReadCallback(char *ptr, size_t size, size_t nmemb, UploadStream *stream) {
+  size_t n = min(size * nmemb, stream->data->size() - stream->offset);
+  memcpy(ptr, stream->data->data() + stream->offset, n);
+  stream->offset += n;
+  return n;
+}
+
+// Generate a string from a pattern by repeating it
+string generateStringFromPattern(const string& pattern, int count) {
+  string result;
+  for (string::size_type i = 0; i < count / pattern.size(); i++)
+    result += pattern;
+  // Get remainder from module and add it to the strings front
+  int remainder = count % pattern.size();
+  if (remainder > 0)
+    result += pattern.substr(0, remainder);
+  return result;
+}
+
+// Uploads the body (chunked or with content-length) and checks the status code and body of the response.
+bool performTestWithBody(CURL *curl, const string& url, const string& body, bool chunked,
+                         long expectedCode, const string& expectedBody) {
+  CURLcode res; // Variable to store the result of the CURL operation.
+  string readBuffer; // String to store the response data.
+  long response_code; // Variable to store the HTTP response code.
+  struct curl_slist *headers = NULL; // Initialize a list for custom headers.
+  bool testPassed = false; // Flag to indicate if the test passed or failed.
+  UploadStream stream = {&body, 0}; // Stream of the body sent by curl.
+
+  // SimpleHTTP currently does not support Expect header, therefore it is set to ""
+  headers = curl_slist_append(headers, "Expect:");
+  if (chunked) headers = curl_slist_append(headers, "Transfer-Encoding: chunked");
+
+  // Reset the state of the curl session to its default state.
+  curl_easy_reset(curl);
+  // Set the URL for the CURL request.
+  curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+  // Set the custom headers for the CURL request.
+  curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+  // Enable TCP keep-alive on the CURL handle to reuse the connection.
+  curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+  // Enable the POST method for the request.
+  curl_easy_setopt(curl, CURLOPT_POST, 1L);
+  // Send the body with the read callback
+  curl_easy_setopt(curl, CURLOPT_READFUNCTION, curlReadCallback);
+  curl_easy_setopt(curl, CURLOPT_READDATA, &stream);
+  if (!chunked) curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE_LARGE, curl_off_t(body.size()));
+  // Set the function to handle writing the data received in response.
+  curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, curlWriteCallback);
+  // Set the variable where the response data will be stored.
+  curl_easy_setopt(curl, CURLOPT_WRITEDATA, &readBuffer);
+
+  // Perform the CURL request and store the result in 'res'
+  res = curl_easy_perform(curl);
+  if(res == CURLE_OK) {
+    // Retrieve the HTTP response code.
+    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response_code);
+    if(response_code == expectedCode && readBuffer == expectedBody) {
+      testPassed = true; // Set the test result to passed if conditions are met.
+    } else {
+      cerr << "Test failed for URL: " << url << (chunked ? " (chunked)" : "") << endl;
+      cerr << "Expected response: " << expectedCode << " with " << expectedBody.size() << " bytes but got: "
+           << response_code << " with " << readBuffer.size() << " bytes" << endl;
+    }
+  } else {
+    // Output the CURL error.
+    cerr << "CURL error: " << curl_easy_strerror(res) << endl;
+  }
+
+  curl_slist_free_all(headers); // Clean up headers after each request.
+
+  return testPassed;
+}
+
+// Reads the full body with multiple reads inside of a nested task.
+Task<string> readBody(Body &body) {
+  string data;
+  while (1) {
+    auto chunk = co_await body.read(100);
+    if (chunk.empty()) break;
+    data.append(chunk.begin(), chunk.end());
+  }
+  co_return data;
+}
+
+// Counts down recursively, every level awaits the next one.
+Task<int> countDown(int n) {
+  if (n == 0) co_return 0;
+  co_return 1 + co_await countDown(n - 1);
+}
+
+// Sleeps inside of a nested task without return value.
+Task<void> pause(string &log) {
+  co_await sleepFor(chrono::milliseconds(50));
+  log += "slept";
+}
+
+// Returns a move-only value from a nested task.
+Task<unique_ptr<string>> makeUnique() {
+  co_return make_unique<string>("unique");
+}
+
+// Throws inside of a nested task.
+Task<int> fail() {
+  throw runtime_error("nested failure");
+  co_return 0;
+}
+
+// Runs all tests against a server running on the event backend.
+bool performBackendTests(EventBackend backend, bool edgeTriggered) {
+  // Test server port
+  int port = 8080;
+  // Test server host
+  string host = "127.0.0.1";
+  // Base URL for the test server.
+  string baseUrl = "http://"+host+":"+to_string(port);
+  // Flag to indicate if all tests passed.
+  bool allTestsPassed = true;
+
+  // Create test server
+  Server server(host, port, {
+    // Buffer is smaller then the body, to suspend the nested task multiple times
+    .sockBufferSize = 700,
+    .eventBackend = backend,
+    .edgeTriggered = edgeTriggered,
+  });
+
+  // Define routes
+
+  // This route reads the body inside of a nested task and returns it.
+  server.Route("POST", "/nested_body", [](Request &req, Body &body, Response &res) -> Task<bool> {
+    string data = co_await readBody(body);
+    res.setStatusCode(200).setBody(data);
+    co_return true;
+  });
+
+  // This route awaits nested tasks with and without (move-only) return values.
+  server.Route("POST", "/nested_tasks", [](Request &req, Body &body, Response &res) -> Task<bool> {
+    string log;
+    co_await pause(log);
+    auto unique = co_await makeUnique();
+    int depth = co_await countDown(1000);
+    res.setStatusCode(200).setBody(log + "," + *unique + "," + to_string(depth));
+    co_return true;
+  });
+
+  // This route catches the exception of a nested task.
+  server.Route("POST", "/nested_throw", [](Request &req, Body &body, Response &res) -> Task<bool> {
+    try {
+      co_await fail();
+      res.setStatusCode(200);
+    } catch (exception &e) {
+      res.setStatusCode(500).setBody(e.what());
+    }
+    co_return true;
+  });
+
+  // Start server in a seperate thread
+  cout << "Starting local test server on " << host << ":" << port << endl;
+  future<void> serverFut = async(launch::async, [&server]() {
+    server.Serve();
+  });
+
+  // Initialize CURL session.
+  CURL *curl = curl_easy_init();
+  if (!curl) {
+    // Report failure if CURL session wasn't successfully initialized.
+    cerr << "Failed to initialize CURL." << endl;
+    server.Kill();
+    return false;
+  }
+
+  // Use base url to try connection
+  curl_easy_setopt(curl, CURLOPT_URL, baseUrl.c_str());
+  curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, curlDiscardCallback);
+
+  // Try to connect to the test server (5 retries, 10s maximum delay)
+  CURLcode res = tryConnect(curl, 5, 10);
+  if (res != CURLE_OK) {
+    cerr << "Failed connecting to test server: " << curl_easy_strerror(res) << endl;
+    server.Kill();
+    return false;
+  }
+
+  // Body larger then the socket buffer
+  string largeBody = generateStringFromPattern("NestedTasks!", 5000);
+
+  for (bool chunked : {false, true}) {
+    allTestsPassed &= performTestWithBody(curl, baseUrl + "/nested_body", largeBody, chunked, 200, largeBody);
+    allTestsPassed &= performTestWithBody(curl, baseUrl + "/nested_body", "", chunked, 200, "");
+  }
+  allTestsPassed &= performTestWithBody(curl, baseUrl + "/nested_tasks", "", false, 200, "slept,unique,1000");
+  allTestsPassed &= performTestWithBody(curl, baseUrl + "/nested_throw", "", false, 500, "nested failure");
+
+  // Cleanup curl session
+  curl_easy_cleanup(curl);
+
+  // Kill test server
+  server.Kill();
+
+  // Wait for the server to exit
+  serverFut.get();
+  return allTestsPassed;
+}
+
+int main(void) {
+  // Flag to indicate if all tests passed.
+  bool allTestsPassed = true;
+
+  allTestsPassed &= performBackendTests(EventBackend::EPOLL, false);
+  allTestsPassed &= performBackendTests(EventBackend::EPOLL, true);
+  allTestsPassed &= performBackendTests(EventBackend::IO_URING, false);
+
+  if(allTestsPassed) {
+    cout << "All tests passed." << endl;
+    return 0;
+  } else {
+    cout << "One or more tests failed." << endl;
+    return 1;
+  }
+}
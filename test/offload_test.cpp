@@ -0,0 +1,237 @@
+#include <iostream>
+#include <string>
+#include <thread>
+#include <future>
+#include <chrono>
+#include <stdexcept>
+
+#include "curl/curl.h"
+#include "src/simplehttp.hpp"
+
+using namespace std;
+
+using namespace SimpleHTTP;
+
+// Attempts to connect to the server with exponential backoff.
+// Returns CURLE_OK on success, or the CURL error code on failure.
+CURLcode tryConnect(CURL* curl, int maxRetries, int maxDelaySeconds) {
+  int retries = 0;
+  int delaySeconds = 1; // Initial delay is 1 sec
+  CURLcode res;
+
+  // Check if curl handle is valid
+  if (!curl) return CURLE_FAILED_INIT;
+
+  // Try until max retries are reached
+  while (retries < maxRetries) {
+    res = curl_easy_perform(curl);
+    // Check if the operation was successful
+    if (res == CURLE_OK) return res;
+    // If not successful, wait for the exponential backoff delay
+    this_thread::sleep_for(std::chrono::seconds(delaySeconds));
+
+    // Update retries and increment delay
+    retries++;
+    delaySeconds *= 2;
+    // If max delay is reached, cap the delay
+    if (delaySeconds > maxDelaySeconds)
+      delaySeconds = maxDelaySeconds;
+  }
+  // If all retries are exhausted, return the last error code
+  cerr << "Connection failed after " << maxRetries << " retries\n";
+  return res;
+}
+
+// Callback function for curl fetch
+size_t curlWriteCallback(void *contents, size_t size, size_t nmemb, string *userp) {
+  userp->append((char*)contents, size * nmemb);
+  return size * nmemb;
+}
+
+// Callback function for curl fetch discarding data
+size_t curlDiscardCallback(void *buffer, size_t size, size_t nmemb, void *userp) {
+  return size * nmemb; // Indicate success but don't write the data
+}
+
+// Performs a GET request with a new curl session and checks the status code and body.
+// If timeoutMs is not 0, the request is aborted after the timeout (no response is expected).
+bool performTest(const string& url, long expectedCode, const string& expectedBody, long timeoutMs = 0) {
+  CURLcode res; // Variable to store the result of the CURL operation.
+  string readBuffer; // String to store the response data.
+  long response_code; // Variable to store the HTTP response code.
+  bool testPassed = false; // Flag to indicate if the test passed or failed.
+
+  // Every test uses its own session, so that tests can run in parallel
+  CURL *curl = curl_easy_init();
+  if (!curl) {
+    cerr << "Failed to initialize CURL." << endl;
+    return false;
+  }
+  // Set the URL for the CURL request.
+  curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+  // Abort the request after the timeout
+  if (timeoutMs != 0) curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS, timeoutMs);
+  // Set the function to handle writing the data received in response.
+  curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, curlWriteCallback);
+  // Set the variable where the response data will be stored.
+  curl_easy_setopt(curl, CURLOPT_WRITEDATA, &readBuffer);
+
+  // Perform the CURL request and store the result in 'res'.
+  res = curl_easy_perform(curl);
+  if (timeoutMs != 0) {
+    testPassed = res == CURLE_OPERATION_TIMEDOUT;
+    if (!testPassed) cerr << "Test failed for URL: " << url << ", expected the request to time out" << endl;
+  } else if(res == CURLE_OK) {
+    // Retrieve the HTTP response code.
+    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response_code);
+    if(response_code == expectedCode && readBuffer == expectedBody) {
+      testPassed = true; // Set the test result to passed if conditions are met.
+    } else {
+      cerr << "Test failed for URL: " << url << endl;
+      cerr << "Expected response: " << expectedCode << " with " << expectedBody
+           << " but got: " << response_code << " with " << readBuffer << endl;
+    }
+  } else {
+    // Output the CURL error.
+    cerr << "CURL error: " << curl_easy_strerror(res) << endl;
+  }
+
+  curl_easy_cleanup(curl);
+  return testPassed;
+}
+
+// Runs all tests against a server running on the event backend.
+bool performBackendTests(ThreadPool& pool, EventBackend backend, bool edgeTriggered) {
+  // Test server port
+  int port = 8080;
+  // Test server host
+  string host = "127.0.0.1";
+  // Base URL for the test server.
+  string baseUrl = "http://"+host+":"+to_string(port);
+  // Flag to indicate if all tests passed.
+  bool allTestsPassed = true;
+
+  // Create test server
+  Server server(host, port, {
+    .eventBackend = backend,
+    .edgeTriggered = edgeTriggered,
+  });
+
+  // Define routes
+
+  // This route offloads a slow computation and returns its result.
+  server.Route("GET", "/compute", [&pool](Request &req, Body &body, Response &res) -> Task<bool> {
+    int result = co_await offload(pool, []() {
+      this_thread::sleep_for(chrono::milliseconds(500));
+      return 42;
+    });
+    res.setStatusCode(200).setBody(to_string(result));
+    co_return true;
+  });
+
+  // This route offloads multiple jobs without result one after another.
+  server.Route("GET", "/steps", [&pool](Request &req, Body &body, Response &res) -> Task<bool> {
+    string steps;
+    for (int i = 0; i < 3; i++) {
+      co_await offload(pool, []() { this_thread::sleep_for(chrono::milliseconds(10)); });
+      steps += to_string(i);
+    }
+    res.setStatusCode(200).setBody(steps);
+    co_return true;
+  });
+
+  // This route offloads a job which throws, the exception is rethrown inside of the function.
+  server.Route("GET", "/throw", [&pool](Request &req, Body &body, Response &res) -> Task<bool> {
+    try {
+      co_await offload(pool, []() -> string { throw runtime_error("offloaded failure"); });
+      res.setStatusCode(200);
+    } catch (exception &e) {
+      res.setStatusCode(500).setBody(e.what());
+    }
+    co_return true;
+  });
+
+  // This route answers immediately.
+  server.Route("GET", "/fast", [](Request &req, Body &body, Response &res) -> Task<bool> {
+    res.setStatusCode(200).setBody("fast");
+    co_return true;
+  });
+
+  // Start server in a seperate thread
+  cout << "Starting local test server on " << host << ":" << port << endl;
+  future<void> serverFut = async(launch::async, [&server]() {
+    server.Serve();
+  });
+
+  // Initialize CURL session.
+  CURL *curl = curl_easy_init();
+  if (!curl) {
+    // Report failure if CURL session wasn't successfully initialized.
+    cerr << "Failed to initialize CURL." << endl;
+    server.Kill();
+    return false;
+  }
+
+  // Use base url to try connection
+  curl_easy_setopt(curl, CURLOPT_URL, baseUrl.c_str());
+  curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, curlDiscardCallback);
+
+  // Try to connect to the test server (5 retries, 10s maximum delay)
+  CURLcode res = tryConnect(curl, 5, 10);
+  curl_easy_cleanup(curl);
+  if (res != CURLE_OK) {
+    cerr << "Failed connecting to test server: " << curl_easy_strerror(res) << endl;
+    server.Kill();
+    return false;
+  }
+
+  // Test that the loop answers other requests while the computation runs on the pool
+  future<bool> computeFut = async(launch::async, [&baseUrl]() {
+    return performTest(baseUrl + "/compute", 200, "42");
+  });
+  this_thread::sleep_for(chrono::milliseconds(100));
+  auto start = chrono::steady_clock::now();
+  allTestsPassed &= performTest(baseUrl + "/fast", 200, "fast");
+  auto elapsed = chrono::steady_clock::now() - start;
+  if (elapsed > chrono::milliseconds(250)) {
+    cerr << "Test failed, request took " << chrono::duration_cast<chrono::milliseconds>(elapsed).count()
+         << "ms while a computation was offloaded" << endl;
+    allTestsPassed = false;
+  }
+  allTestsPassed &= computeFut.get();
+
+  // Test multiple offloaded jobs in one function and exceptions thrown by jobs
+  allTestsPassed &= performTest(baseUrl + "/steps", 200, "012");
+  allTestsPassed &= performTest(baseUrl + "/throw", 500, "offloaded failure");
+
+  // Test a connection which is closed by the client while the computation runs
+  allTestsPassed &= performTest(baseUrl + "/compute", 0, "", 100);
+  this_thread::sleep_for(chrono::milliseconds(500));
+  allTestsPassed &= performTest(baseUrl + "/fast", 200, "fast");
+
+  // Kill test server
+  server.Kill();
+
+  // Wait for the server to exit
+  serverFut.get();
+  return allTestsPassed;
+}
+
+int main(void) {
+  // Pool executing the offloaded work of all servers
+  ThreadPool pool(2);
+  // Flag to indicate if all tests passed.
+  bool allTestsPassed = true;
+
+  allTestsPassed &= performBackendTests(pool, EventBackend::EPOLL, false);
+  allTestsPassed &= performBackendTests(pool, EventBackend::EPOLL, true);
+  allTestsPassed &= performBackendTests(pool, EventBackend::IO_URING, false);
+
+  if(allTestsPassed) {
+    cout << "All tests passed." << endl;
+    return 0;
+  } else {
+    cout << "One or more tests failed." << endl;
+    return 1;
+  }
+}
@@ -0,0 +1,243 @@
+#include <iostream>
+#include <string>
+#include <thread>
+#include <future>
+#include <chrono>
+
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+
+#include "src/simplehttp.hpp"
+
+using namespace std;
+
+using namespace SimpleHTTP;
+
+// Attempts to connect to the server with exponential backoff.
+// Returns the socket on success, or -1 on failure.
+int tryConnect(const string& host, int port, int maxRetries, int maxDelaySeconds) {
+  int retries = 0;
+  int delaySeconds = 1; // Initial delay is 1 sec
+
+  struct sockaddr_in addr = {};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  inet_pton(AF_INET, host.c_str(), &addr.sin_addr);
+
+  // Try until max retries are reached
+  while (retries < maxRetries) {
+    int sock = socket(AF_INET, SOCK_STREAM, 0);
+    if (sock < 0) return -1;
+    // Check if the operation was successful
+    if (connect(sock, (struct sockaddr*)&addr, sizeof(addr)) == 0) return sock;
+    close(sock);
+    // If not successful, wait for the exponential backoff delay
+    this_thread::sleep_for(std::chrono::seconds(delaySeconds));
+
+    // Update retries and increment delay
+    retries++;
+    delaySeconds *= 2;
+    // If max delay is reached, cap the delay
+    if (delaySeconds > maxDelaySeconds)
+      delaySeconds = maxDelaySeconds;
+  }
+  // If all retries are exhausted, return failure
+  cerr << "Connection failed after " << maxRetries << " retries\n";
+  return -1;
+}
+
+// Sends all data to the socket
+bool sendAll(int sock, const string& data) {
+  size_t sent = 0;
+  while (sent < data.size()) {
+    ssize_t n = send(sock, data.data()+sent, data.size()-sent, MSG_NOSIGNAL);
+    if (n < 1) return false;
+    sent += n;
+  }
+  return true;
+}
+
+// Reads a single response from the socket and returns its status code and body.
+// Responses are expected to contain a content-length header.
+bool readResponse(int sock, int& statusCode, string& body) {
+  string pending;
+  // Read until the head is complete
+  size_t headEnd;
+  while ((headEnd = pending.find("\r\n\r\n")) == string::npos) {
+    char buffer[4096];
+    ssize_t n = recv(sock, buffer, sizeof(buffer), 0);
+    if (n < 1) return false;
+    pending.append(buffer, n);
+  }
+  string head = pending.substr(0, headEnd);
+  statusCode = stoi(head.substr(head.find(' ')+1, 3));
+
+  // Extract content length
+  size_t contentLength = 0;
+  size_t lengthPos = head.find("Content-Length: ");
+  if (lengthPos != string::npos) {
+    contentLength = stoul(head.substr(lengthPos+16));
+  }
+
+  // Read until the body is complete
+  while (pending.size() < headEnd+4+contentLength) {
+    char buffer[4096];
+    ssize_t n = recv(sock, buffer, sizeof(buffer), 0);
+    if (n < 1) return false;
+    pending.append(buffer, n);
+  }
+  body = pending.substr(headEnd+4, contentLength);
+  return true;
+}
+
+// Waits until the server closed the connection (responses sent before are skipped).
+// Returns false if the connection is still open after the timeout.
+bool waitClosed(int sock, int timeoutMs) {
+  struct timeval tv = {};
+  tv.tv_sec = timeoutMs / 1000;
+  tv.tv_usec = (timeoutMs % 1000) * 1000;
+  setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+  while (1) {
+    char buffer[4096];
+    ssize_t n = recv(sock, buffer, sizeof(buffer), 0);
+    if (n == 0) return true;
+    if (n < 0) return errno == ECONNRESET;
+  }
+}
+
+// Sends the data, closes the sending side of the connection (EOF)
+// and verifies that the server closes the connection.
+// If ping is set, a request is completed first, so that the EOF is received on a kept alive connection.
+bool performPeerCloseTest(const string& host, int port, const string& name, const string& data, bool ping) {
+  bool testPassed = false; // Flag to indicate if the test passed or failed.
+
+  int sock = tryConnect(host, port, 1, 1);
+  if (sock < 0) {
+    cerr << "Failed connecting to test server" << endl;
+    return false;
+  }
+
+  int statusCode = 0;
+  string body;
+  if (ping && (!sendAll(sock, "GET /ping HTTP/1.1\r\nHost: localhost\r\n\r\n") ||
+               !readResponse(sock, statusCode, body) || statusCode != 200)) {
+    cerr << "Test failed for " << name << ": ping failed" << endl;
+  } else if (!sendAll(sock, data) || shutdown(sock, SHUT_WR) != 0) {
+    cerr << "Test failed for " << name << ": sending failed" << endl;
+  } else if (!waitClosed(sock, 2000)) {
+    cerr << "Test failed for " << name << ": connection was not closed after the peer closed it" << endl;
+  } else {
+    testPassed = true;
+  }
+
+  close(sock);
+  return testPassed;
+}
+
+// Verifies that the server still answers requests (e.g. it does not spin on a half closed connection).
+bool performPingTest(const string& host, int port) {
+  int sock = tryConnect(host, port, 1, 1);
+  if (sock < 0) {
+    cerr << "Failed connecting to test server" << endl;
+    return false;
+  }
+  int statusCode = 0;
+  string body;
+  auto start = chrono::steady_clock::now();
+  bool testPassed = sendAll(sock, "GET /ping HTTP/1.1\r\nHost: localhost\r\n\r\n") &&
+    readResponse(sock, statusCode, body) && statusCode == 200 && body == "pong" &&
+    chrono::steady_clock::now() - start < chrono::milliseconds(500);
+  if (!testPassed) cerr << "Test failed for ping after peer close" << endl;
+  close(sock);
+  return testPassed;
+}
+
+// Runs all tests against a server running on the event backend.
+bool performBackendTests(EventBackend backend, bool edgeTriggered) {
+  // Test server port
+  int port = 8080;
+  // Test server host
+  string host = "127.0.0.1";
+  // Flag to indicate if all tests passed.
+  bool allTestsPassed = true;
+
+  // Create test server
+  Server server(host, port, {
+    .eventBackend = backend,
+    .edgeTriggered = edgeTriggered,
+  });
+
+  // This route answers immediately.
+  server.Route("GET", "/ping", [](Request &, Body &, Response &res) -> Task<bool> {
+    res.setStatusCode(200).setBody("pong");
+    co_return true;
+  });
+
+  // This route returns the body.
+  server.Route("POST", "/echo", [](Request &, Body &body, Response &res) -> Task<bool> {
+    auto data = co_await body.readAll();
+    res.setStatusCode(200).setBody(string(data.begin(), data.end()));
+    co_return true;
+  });
+
+  // Start server in a seperate thread
+  cout << "Starting local test server on " << host << ":" << port << endl;
+  future<void> serverFut = async(launch::async, [&server]() {
+    server.Serve();
+  });
+
+  // Try to connect to the test server (5 retries, 10s maximum delay)
+  int sock = tryConnect(host, port, 5, 10);
+  if (sock < 0) {
+    cerr << "Failed connecting to test server" << endl;
+    server.Kill();
+    serverFut.get();
+    return false;
+  }
+  close(sock);
+
+  // EOF while the request head is received
+  allTestsPassed &= performPeerCloseTest(host, port, "empty request", "", false);
+  allTestsPassed &= performPeerCloseTest(host, port, "partial head", "GET /ping HTTP/1.1\r\nHo", false);
+  allTestsPassed &= performPeerCloseTest(host, port, "partial head after request",
+                                         "GET /ping HTTP/1.1\r\nHo", true);
+  allTestsPassed &= performPeerCloseTest(host, port, "idle after request", "", true);
+
+  // EOF while the body is received
+  allTestsPassed &= performPeerCloseTest(host, port, "partial fixed body",
+                                         "POST /echo HTTP/1.1\r\nHost: localhost\r\nContent-Length: 100\r\n\r\nabc",
+                                         true);
+  allTestsPassed &= performPeerCloseTest(host, port, "partial chunked body",
+                                         "POST /echo HTTP/1.1\r\nHost: localhost\r\n"
+                                         "Transfer-Encoding: chunked\r\n\r\n10\r\nabc", true);
+
+  // The loop must not be busy with the closed connections
+  allTestsPassed &= performPingTest(host, port);
+
+  // Kill test server
+  server.Kill();
+
+  // Wait for the server to exit
+  serverFut.get();
+  return allTestsPassed;
+}
+
+int main(void) {
+  // Flag to indicate if all tests passed.
+  bool allTestsPassed = true;
+
+  allTestsPassed &= performBackendTests(EventBackend::EPOLL, false);
+  allTestsPassed &= performBackendTests(EventBackend::EPOLL, true);
+  allTestsPassed &= performBackendTests(EventBackend::IO_URING, false);
+
+  if(allTestsPassed) {
+    cout << "All tests passed." << endl;
+    return 0;
+  } else {
+    cout << "One or more tests failed." << endl;
+    return 1;
+  }
+}
@@ -0,0 +1,249 @@
+#include <iostream>
+#include <string>
+#include <thread>
+#include <future>
+
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+
+#include "src/simplehttp.hpp"
+
+using namespace std;
+
+using namespace SimpleHTTP;
+
+// Attempts to connect to the server with exponential backoff.
+// Returns the socket on success, or -1 on failure.
+int tryConnect(const string& host, int port, int maxRetries, int maxDelaySeconds) {
+  int retries = 0;
+  int delaySeconds = 1; // Initial delay is 1 sec
+
+  struct sockaddr_in addr = {};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  inet_pton(AF_INET, host.c_str(), &addr.sin_addr);
+
+  // Try until max retries are reached
+  while (retries < maxRetries) {
+    int sock = socket(AF_INET, SOCK_STREAM, 0);
+    if (sock < 0) return -1;
+    // Check if the operation was successful
+    if (connect(sock, (struct sockaddr*)&addr, sizeof(addr)) == 0) return sock;
+    close(sock);
+    // If not successful, wait for the exponential backoff delay
+    this_thread::sleep_for(std::chrono::seconds(delaySeconds));
+
+    // Update retries and increment delay
+    retries++;
+    delaySeconds *= 2;
+    // If max delay is reached, cap the delay
+    if (delaySeconds > maxDelaySeconds)
+      delaySeconds = maxDelaySeconds;
+  }
+  // If all retries are exhausted, return failure
+  cerr << "Connection failed after " << maxRetries << " retries\n";
+  return -1;
+}
+
+// Sends all data to the socket
+bool sendAll(int sock, const string& data) {
+  size_t sent = 0;
+  while (sent < data.size()) {
+    ssize_t n = send(sock, data.data()+sent, data.size()-sent, 0);
+    if (n < 1) return false;
+    sent += n;
+  }
+  return true;
+}
+
+// Reads a single response from the socket and returns its status code and body.
+// Responses are expected to contain a content-length header. Data of following responses
+// remains in the pending buffer.
+bool readResponse(int sock, string& pending, int& statusCode, string& body) {
+  // Read until the head is complete
+  size_t headEnd;
+  while ((headEnd = pending.find("\r\n\r\n")) == string::npos) {
+    char buffer[4096];
+    ssize_t n = recv(sock, buffer, sizeof(buffer), 0);
+    if (n < 1) return false;
+    pending.append(buffer, n);
+  }
+  string head = pending.substr(0, headEnd);
+  statusCode = stoi(head.substr(head.find(' ')+1, 3));
+
+  // Extract content length
+  size_t contentLength = 0;
+  size_t lengthPos = head.find("Content-Length: ");
+  if (lengthPos != string::npos) {
+    contentLength = stoul(head.substr(lengthPos+16));
+  }
+
+  // Read until the body is complete
+  while (pending.size() < headEnd+4+contentLength) {
+    char buffer[4096];
+    ssize_t n = recv(sock, buffer, sizeof(buffer), 0);
+    if (n < 1) return false;
+    pending.append(buffer, n);
+  }
+  body = pending.substr(headEnd+4, contentLength);
+  pending.erase(0, headEnd+4+contentLength);
+  return true;
+}
+
+// Sends all requests at once and verifies that the responses arrive in order
+bool performPipelinedTest(const string& host, int port, const string& requests, const vector<pair<int, string>>& expected) {
+  bool testPassed = true; // Flag to indicate if the test passed or failed.
+
+  int sock = tryConnect(host, port, 1, 1);
+  if (sock < 0) {
+    cerr << "Failed connecting to test server" << endl;
+    return false;
+  }
+
+  // Write all requests without waiting for responses
+  if (!sendAll(sock, requests)) {
+    cerr << "Failed sending pipelined requests" << endl;
+    close(sock);
+    return false;
+  }
+
+  string pending; // Buffer to store received data of following responses
+  for (size_t i = 0; i < expected.size(); i++) {
+    int statusCode;
+    string body;
+    if (!readResponse(sock, pending, statusCode, body)) {
+      cerr << "Failed reading response " << i << endl;
+      testPassed = false;
+      break;
+    }
+    if (statusCode != expected[i].first || body != expected[i].second) {
+      cerr << "Test failed for response " << i << endl;
+      cerr << "Expected response: " << expected[i].first << " " << expected[i].second
+           << " but got: " << statusCode << " " << body << endl;
+      testPassed = false;
+    }
+  }
+
+  close(sock);
+  return testPassed;
+}
+
+// Runs all tests against a server running on the event backend with the socket buffer size.
+bool performBackendTests(EventBackend backend, int sockBufferSize) {
+  // Test server port
+  int port = 8080;
+  // Test server host
+  string host = "127.0.0.1";
+  // Flag to indicate if all tests passed.
+  bool allTestsPassed = true;
+
+  // Create test server
+  Server server(host, port, {
+    .sockBufferSize = sockBufferSize,
+    .eventBackend = backend,
+  });
+
+  // Define routes
+
+  // This route echoes the "id" header to verify the order of the responses.
+  server.Route("GET", "/echo_id", [](Request &req, Body &body, Response &res) -> Task<bool> {
+    auto idHeader = req.getHeader("id");
+    res.setStatusCode(200).setBody(idHeader ? *idHeader : "");
+    co_return true;
+  });
+
+  // This route returns the body to verify that bodies of pipelined requests are separated.
+  server.Route("POST", "/echo_body", [](Request &req, Body &body, Response &res) -> Task<bool> {
+    auto data = co_await body.readAll();
+    res.setStatusCode(200).setBody(string(data.begin(), data.end()));
+    co_return true;
+  });
+
+  // This route ignores the body, so that it must be drained before the next request is processed.
+  server.Route("POST", "/ignore_body", [](Request &req, Body &body, Response &res) -> Task<bool> {
+    res.setStatusCode(200).setBody("ignored");
+    co_return true;
+  });
+
+  // Start server in a seperate thread
+  cout << "Starting local test server on " << host << ":" << port << endl;
+  future<void> serverFut = async(launch::async, [&server]() {
+    server.Serve();
+  });
+
+  // Try to connect to the test server (5 retries, 10s maximum delay)
+  int sock = tryConnect(host, port, 5, 10);
+  if (sock < 0) {
+    cerr << "Failed connecting to test server" << endl;
+    server.Kill();
+    serverFut.get();
+    return false;
+  }
+  close(sock);
+
+  // Test pipelined requests without body
+  string requests;
+  vector<pair<int, string>> expected;
+  for (int i = 0; i < 20; i++) {
+    requests += "GET /echo_id HTTP/1.1\r\nHost: localhost\r\nId: " + to_string(i) + "\r\n\r\n";
+    expected.push_back({200, to_string(i)});
+  }
+  allTestsPassed &= performPipelinedTest(host, port, requests, expected);
+
+  // Test pipelined requests with fixed and chunked bodies (read and drained)
+  requests =
+    "POST /echo_body HTTP/1.1\r\nHost: localhost\r\nContent-Length: 11\r\n\r\nfixed body!"
+    "POST /ignore_body HTTP/1.1\r\nHost: localhost\r\nContent-Length: 13\r\n\r\ndrained body!"
+    "POST /echo_body HTTP/1.1\r\nHost: localhost\r\nTransfer-Encoding: chunked\r\n\r\n"
+    "7\r\nchunked\r\n5\r\n body\r\n0\r\n\r\n"
+    "POST /ignore_body HTTP/1.1\r\nHost: localhost\r\nTransfer-Encoding: chunked\r\n\r\n"
+    "7\r\ndrained\r\n0\r\nTrailer: ignored\r\n\r\n"
+    "GET /echo_id HTTP/1.1\r\nHost: localhost\r\nId: last\r\n\r\n"
+    "GET /unknown HTTP/1.1\r\nHost: localhost\r\n\r\n";
+  expected = {
+    {200, "fixed body!"},
+    {200, "ignored"},
+    {200, "chunked body"},
+    {200, "ignored"},
+    {200, "last"},
+    {404, "The requested resource /unknown was not found on this server\n"},
+  };
+  allTestsPassed &= performPipelinedTest(host, port, requests, expected);
+
+  // Test that requests after "Connection: close" are not processed
+  requests =
+    "GET /echo_id HTTP/1.1\r\nHost: localhost\r\nId: first\r\nConnection: close\r\n\r\n"
+    "GET /echo_id HTTP/1.1\r\nHost: localhost\r\nId: second\r\n\r\n";
+  expected = {
+    {200, "first"},
+  };
+  allTestsPassed &= performPipelinedTest(host, port, requests, expected);
+
+  // Kill test server
+  server.Kill();
+
+  // Wait for the server to exit
+  serverFut.get();
+  return allTestsPassed;
+}
+
+int main(void) {
+  // Flag to indicate if all tests passed.
+  bool allTestsPassed = true;
+
+  // Buffer is smaller then the pipelined requests, to split them over multiple reads
+  allTestsPassed &= performBackendTests(EventBackend::EPOLL, 64);
+  allTestsPassed &= performBackendTests(EventBackend::IO_URING, 64);
+  // Buffer holds multiple pipelined requests, which are parsed in place in one provided buffer
+  allTestsPassed &= performBackendTests(EventBackend::IO_URING, 4096);
+
+  if(allTestsPassed) {
+    cout << "All tests passed." << endl;
+    return 0;
+  } else {
+    cout << "One or more tests failed." << endl;
+    return 1;
+  }
+}
@@ -187,6 +187,28 @@ int main(void) {
     co_return true;
   });
 
+  // This route tests the server's ability to read the body from a POST request into a caller-provided buffer.
+  // Similar to the readloop route, it performs a bitwise operation (shifting bits) on the body based on a
+  // "bitshift" header value after combining the reads to form the complete transformed body.
+  // It uses the body.readInto(buffer) function with a buffer larger then the socket buffer size.
+  server.Route("POST", "/process_body_readinto", [](Request &req, Body &body, Response &res) -> Task<bool> {
+    auto bitShiftHeader = req.getHeader("bitshift");
+    int bitShift = bitShiftHeader ? stoi(*bitShiftHeader) : 0; // Default to no shift if header is missing
+  
+    string dataStr;
+    std::byte buffer[1000];
+    while (true) {
+      size_t n = co_await body.readInto(buffer); // Read into the buffer
+      if (n == 0) break; // Exit loop if no more data
+      dataStr.append((char*)buffer, n);
+    }
+
+    res.setStatusCode(200).setBody(
+      applyBitShift(dataStr, bitShift)
+    );
+    co_return true;
+  });
+
   // Start server in a seperate thread
   cout << "Starting local test server on " << host << ":" << port << endl;
   future<void> serverFut = async(launch::async, [&server]() {
@@ -241,6 +263,20 @@ int main(void) {
     "", shift, ""
   );
 
+  // Test with correct body and header for fixed transfer to /process_body_readinto
+  allTestsPassed &= performTestWithBody(
+    curl,
+    baseUrl + "/process_body_readinto",
+    inputBody, shift, expectedTransformedBody
+  );
+
+  // Test with a 0 length body for fixed transfer to /process_body_readinto
+  allTestsPassed &= performTestWithBody(
+    curl,
+    baseUrl + "/process_body_readinto",
+    "", shift, ""
+  );
+
   // Cleanup curl session
   curl_easy_cleanup(curl);
 
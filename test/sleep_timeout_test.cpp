@@ -0,0 +1,294 @@
+#include <iostream>
+#include <string>
+#include <thread>
+#include <future>
+#include <chrono>
+
+#include "curl/curl.h"
+#include "src/simplehttp.hpp"
+
+using namespace std;
+
+using namespace SimpleHTTP;
+
+// Attempts to connect to the server with exponential backoff.
+// Returns CURLE_OK on success, or the CURL error code on failure.
+CURLcode tryConnect(CURL* curl, int maxRetries, int maxDelaySeconds) {
+  int retries = 0;
+  int delaySeconds = 1; // Initial delay is 1 sec
+  CURLcode res;
+
+  // Check if curl handle is valid
+  if (!curl) return CURLE_FAILED_INIT;
+
+  // Try until max retries are reached
+  while (retries < maxRetries) {
+    res = curl_easy_perform(curl);
+    // Check if the operation was successful
+    if (res == CURLE_OK) return res;
+    // If not successful, wait for the exponential backoff delay
+    this_thread::sleep_for(std::chrono::seconds(delaySeconds));
+
+    // Update retries and increment delay
+    retries++;
+    delaySeconds *= 2;
+    // If max delay is reached, cap the delay
+    if (delaySeconds > maxDelaySeconds)
+      delaySeconds = maxDelaySeconds;
+  }
+  // If all retries are exhausted, return the last error code
+  cerr << "Connection failed after " << maxRetries << " retries\n";
+  return res;
+}
+
+// Callback function for curl fetch
+size_t curlWriteCallback(void *contents, size_t size, size_t nmemb, string *userp) {
+  userp->append((char*)contents, size * nmemb);
+  return size * nmemb;
+}
+
+// Callback function for curl fetch discarding data
+size_t curlDiscardCallback(void *buffer, size_t size, size_t nmemb, void *userp) {
+  return size * nmemb; // Indicate success but don't write the data
+}
+
+// Performs a GET request with a new curl session and checks the status code and body.
+// If timeoutMs is not 0, the request is aborted after the timeout (no response is expected).
+bool performTest(const string& url, long expectedCode, const string& expectedBody, long timeoutMs = 0) {
+  CURLcode res; // Variable to store the result of the CURL operation.
+  string readBuffer; // String to store the response data.
+  long response_code; // Variable to store the HTTP response code.
+  bool testPassed = false; // Flag to indicate if the test passed or failed.
+
+  // Every test uses its own session, so that tests can run in parallel
+  CURL *curl = curl_easy_init();
+  if (!curl) {
+    cerr << "Failed to initialize CURL." << endl;
+    return false;
+  }
+  // Set the URL for the CURL request.
+  curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+  // Abort the request after the timeout
+  if (timeoutMs != 0) curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS, timeoutMs);
+  // Set the function to handle writing the data received in response.
+  curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, curlWriteCallback);
+  // Set the variable where the response data will be stored.
+  curl_easy_setopt(curl, CURLOPT_WRITEDATA, &readBuffer);
+
+  // Perform the CURL request and store the result in 'res'.
+  res = curl_easy_perform(curl);
+  if (timeoutMs != 0) {
+    testPassed = res == CURLE_OPERATION_TIMEDOUT;
+    if (!testPassed) cerr << "Test failed for URL: " << url << ", expected the request to time out" << endl;
+  } else if(res == CURLE_OK) {
+    // Retrieve the HTTP response code.
+    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response_code);
+    if(response_code == expectedCode && readBuffer == expectedBody) {
+      testPassed = true; // Set the test result to passed if conditions are met.
+    } else {
+      cerr << "Test failed for URL: " << url << endl;
+      cerr << "Expected response: " << expectedCode << " with " << expectedBody
+           << " but got: " << response_code << " with " << readBuffer << endl;
+    }
+  } else {
+    // Output the CURL error.
+    cerr << "CURL error: " << curl_easy_strerror(res) << endl;
+  }
+
+  curl_easy_cleanup(curl);
+  return testPassed;
+}
+
+// Performs a GET request which is expected to be closed by the server without response
+// within maxMs (e.g. because the wait of the function exceeded the wait timeout).
+bool performClosedTest(const string& url, long maxMs) {
+  CURL *curl = curl_easy_init();
+  if (!curl) {
+    cerr << "Failed to initialize CURL." << endl;
+    return false;
+  }
+  auto start = chrono::steady_clock::now();
+  curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+  // Abort the request if it was not closed by the server
+  curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS, 3 * maxMs);
+  curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, curlDiscardCallback);
+  CURLcode res = curl_easy_perform(curl);
+  curl_easy_cleanup(curl);
+  long elapsed = chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - start).count();
+  if (res != CURLE_GOT_NOTHING || elapsed > maxMs) {
+    cerr << "Test failed for URL: " << url << ", expected the connection to be closed within " << maxMs
+         << "ms but got: " << curl_easy_strerror(res) << " after " << elapsed << "ms" << endl;
+    return false;
+  }
+  return true;
+}
+
+// Returns the milliseconds passed since start
+long elapsedMs(chrono::steady_clock::time_point start) {
+  return chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - start).count();
+}
+
+// Runs all tests against a server running on the event backend.
+bool performBackendTests(ThreadPool& pool, EventBackend backend, bool edgeTriggered) {
+  // Test server port
+  int port = 8080;
+  // Test server host
+  string host = "127.0.0.1";
+  // Base URL for the test server.
+  string baseUrl = "http://"+host+":"+to_string(port);
+  // Flag to indicate if all tests passed.
+  bool allTestsPassed = true;
+
+  // Create test server
+  Server server(host, port, {
+    // Timeout is shorter then the long poll, waiting functions must not be closed as idle
+    .connectionTimeout = chrono::seconds(1),
+    // Waits are still bounded, functions waiting longer are closed
+    .waitTimeout = chrono::seconds(3),
+    .eventBackend = backend,
+    .edgeTriggered = edgeTriggered,
+  });
+
+  // Define routes
+
+  // This route sleeps and verifies that the sleep is not shorter then requested.
+  server.Route("GET", "/sleep", [](Request &req, Body &body, Response &res) -> Task<bool> {
+    auto start = chrono::steady_clock::now();
+    co_await sleepFor(chrono::milliseconds(300));
+    res.setStatusCode(elapsedMs(start) >= 300 ? 200 : 500).setBody("slept");
+    co_return true;
+  });
+
+  // This route sleeps longer then the connection timeout (long polling).
+  server.Route("GET", "/long_poll", [](Request &req, Body &body, Response &res) -> Task<bool> {
+    co_await sleepFor(chrono::milliseconds(2500));
+    res.setStatusCode(200).setBody("polled");
+    co_return true;
+  });
+
+  // This route sleeps longer then the wait timeout, the connection must be closed.
+  server.Route("GET", "/sleep_forever", [](Request &req, Body &body, Response &res) -> Task<bool> {
+    co_await sleepFor(chrono::seconds(60));
+    res.setStatusCode(200).setBody("slept");
+    co_return true;
+  });
+
+  // This route limits a sleep which takes longer then the timeout.
+  server.Route("GET", "/sleep_expired", [](Request &req, Body &body, Response &res) -> Task<bool> {
+    auto start = chrono::steady_clock::now();
+    bool completed = co_await withTimeout(sleepFor(chrono::seconds(5)), chrono::milliseconds(100));
+    res.setStatusCode(!completed && elapsedMs(start) < 1000 ? 200 : 500).setBody("expired");
+    co_return true;
+  });
+
+  // This route limits offloaded work which completes before the timeout.
+  server.Route("GET", "/offload_completed", [&pool](Request &req, Body &body, Response &res) -> Task<bool> {
+    auto result = co_await withTimeout(offload(pool, []() { return 7; }), chrono::seconds(5));
+    res.setStatusCode(200).setBody(result ? to_string(result.value()) : "expired");
+    co_return true;
+  });
+
+  // This route limits offloaded work which takes longer then the timeout.
+  // The late wakeup of the abandoned work must not end the following sleep.
+  server.Route("GET", "/offload_expired", [&pool](Request &req, Body &body, Response &res) -> Task<bool> {
+    auto result = co_await withTimeout(offload(pool, []() {
+      this_thread::sleep_for(chrono::milliseconds(200));
+      return 1;
+    }), chrono::milliseconds(50));
+    auto start = chrono::steady_clock::now();
+    co_await sleepFor(chrono::milliseconds(400));
+    bool slept = elapsedMs(start) >= 400;
+    res.setStatusCode(200).setBody(string(result ? "completed" : "expired") + (slept ? ",slept" : ""));
+    co_return true;
+  });
+
+  // This route answers immediately.
+  server.Route("GET", "/fast", [](Request &req, Body &body, Response &res) -> Task<bool> {
+    res.setStatusCode(200).setBody("fast");
+    co_return true;
+  });
+
+  // Start server in a seperate thread
+  cout << "Starting local test server on " << host << ":" << port << endl;
+  future<void> serverFut = async(launch::async, [&server]() {
+    server.Serve();
+  });
+
+  // Initialize CURL session.
+  CURL *curl = curl_easy_init();
+  if (!curl) {
+    // Report failure if CURL session wasn't successfully initialized.
+    cerr << "Failed to initialize CURL." << endl;
+    server.Kill();
+    return false;
+  }
+
+  // Use base url to try connection
+  curl_easy_setopt(curl, CURLOPT_URL, baseUrl.c_str());
+  curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, curlDiscardCallback);
+
+  // Try to connect to the test server (5 retries, 10s maximum delay)
+  CURLcode res = tryConnect(curl, 5, 10);
+  curl_easy_cleanup(curl);
+  if (res != CURLE_OK) {
+    cerr << "Failed connecting to test server: " << curl_easy_strerror(res) << endl;
+    server.Kill();
+    return false;
+  }
+
+  // Test that the loop answers other requests while functions sleep
+  future<bool> sleepFut = async(launch::async, [&baseUrl]() {
+    return performTest(baseUrl + "/sleep", 200, "slept");
+  });
+  future<bool> longPollFut = async(launch::async, [&baseUrl]() {
+    return performTest(baseUrl + "/long_poll", 200, "polled");
+  });
+  this_thread::sleep_for(chrono::milliseconds(100));
+  auto start = chrono::steady_clock::now();
+  allTestsPassed &= performTest(baseUrl + "/fast", 200, "fast");
+  if (elapsedMs(start) > 150) {
+    cerr << "Test failed, request took " << elapsedMs(start) << "ms while functions were sleeping" << endl;
+    allTestsPassed = false;
+  }
+  allTestsPassed &= sleepFut.get();
+  allTestsPassed &= longPollFut.get();
+
+  // Test timeouts of sleeps and offloaded work
+  allTestsPassed &= performTest(baseUrl + "/sleep_expired", 200, "expired");
+  allTestsPassed &= performTest(baseUrl + "/offload_completed", 200, "7");
+  allTestsPassed &= performTest(baseUrl + "/offload_expired", 200, "expired,slept");
+
+  // Test a function which waits longer then the wait timeout
+  allTestsPassed &= performClosedTest(baseUrl + "/sleep_forever", 5000);
+
+  // Test a connection which is closed by the client while the function sleeps
+  allTestsPassed &= performTest(baseUrl + "/sleep", 0, "", 100);
+  this_thread::sleep_for(chrono::milliseconds(300));
+  allTestsPassed &= performTest(baseUrl + "/fast", 200, "fast");
+
+  // Kill test server
+  server.Kill();
+
+  // Wait for the server to exit
+  serverFut.get();
+  return allTestsPassed;
+}
+
+int main(void) {
+  // Pool executing the offloaded work of all servers
+  ThreadPool pool(2);
+  // Flag to indicate if all tests passed.
+  bool allTestsPassed = true;
+
+  allTestsPassed &= performBackendTests(pool, EventBackend::EPOLL, false);
+  allTestsPassed &= performBackendTests(pool, EventBackend::EPOLL, true);
+  allTestsPassed &= performBackendTests(pool, EventBackend::IO_URING, false);
+
+  if(allTestsPassed) {
+    cout << "All tests passed." << endl;
+    return 0;
+  } else {
+    cout << "One or more tests failed." << endl;
+    return 1;
+  }
+}
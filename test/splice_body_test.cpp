@@ -0,0 +1,436 @@
+#include <iostream>
+#include <string>
+#include <thread>
+#include <future>
+#include <fstream>
+#include <sstream>
+#include <filesystem>
+#include <cstring>
+#include <atomic>
+#include <chrono>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include "curl/curl.h"
+#include "src/simplehttp.hpp"
+
+using namespace std;
+
+using namespace SimpleHTTP;
+
+// Attempts to connect to the server with exponential backoff.
+// Returns CURLE_OK on success, or the CURL error code on failure.
+CURLcode tryConnect(CURL* curl, int maxRetries, int maxDelaySeconds) {
+  int retries = 0;
+  int delaySeconds = 1; // Initial delay is 1 sec
+  CURLcode res;
+
+  // Check if curl handle is valid
+  if (!curl) return CURLE_FAILED_INIT;
+
+  // Try until max retries are reached
+  while (retries < maxRetries) {
+    res = curl_easy_perform(curl);
+    // Check if the operation was successful
+    if (res == CURLE_OK) return res;
+    // If not successful, wait for the exponential backoff delay
+    this_thread::sleep_for(std::chrono::seconds(delaySeconds));
+
+    // Update retries and increment delay
+    retries++;
+    delaySeconds *= 2;
+    // If max delay is reached, cap the delay
+    if (delaySeconds > maxDelaySeconds)
+      delaySeconds = maxDelaySeconds;
+  }
+  // If all retries are exhausted, return the last error code
+  cerr << "Connection failed after " << maxRetries << " retries\n";
+  return res;
+}
+
+// Callback function for curl fetch
+size_t curlWriteCallback(void *contents, size_t size, size_t nmemb, string *userp) {
+  userp->append((char*)contents, size * nmemb);
+  return size * nmemb;
+}
+
+// Callback function for curl fetch discarding data
+size_t curlDiscardCallback(void *buffer, size_t size, size_t nmemb, void *userp) {
+  return size * nmemb; // Indicate success but don't write the data
+}
+
+// Stream of the request body sent by curl
+struct UploadStream {
+  const string* data;
+  size_t offset;
+};
+
+// Callback function for curl to read the body (every call is sent as one chunk if the body is chunked)
+size_t curlReadCallback(char *ptr, size_t size, size_t nmemb, UploadStream *stream) {
+  size_t n = min(size * nmemb, stream->data->size() - stream->offset);
+  memcpy(ptr, stream->data->data() + stream->offset, n);
+  stream->offset += n;
+  return n;
+}
+
+// Reads the content of the file
+string readFile(const filesystem::path& path) {
+  ifstream file(path, ios::binary);
+  stringstream content;
+  content << file.rdbuf();
+  return content.str();
+}
+
+// Generate a string from a pattern by repeating it
+string generateStringFromPattern(const string& pattern, int count) {
+  string result;
+  for (string::size_type i = 0; i < count / pattern.size(); i++)
+    result += pattern;
+  // Get remainder from module and add it to the strings front
+  int remainder = count % pattern.size();
+  if (remainder > 0)
+    result += pattern.substr(0, remainder);
+  return result;
+}
+
+// Uploads the body (chunked or with content-length) and checks that the response equals the body.
+bool performTestWithBody(CURL *curl, const string& url, const string& body, bool chunked) {
+  CURLcode res; // Variable to store the result of the CURL operation.
+  string readBuffer; // String to store the response data.
+  long response_code; // Variable to store the HTTP response code.
+  struct curl_slist *headers = NULL; // Initialize a list for custom headers.
+  bool testPassed = false; // Flag to indicate if the test passed or failed.
+  UploadStream stream = {&body, 0}; // Stream of the body sent by curl.
+
+  // SimpleHTTP currently does not support Expect header, therefore it is set to ""
+  headers = curl_slist_append(headers, "Expect:");
+  if (chunked) headers = curl_slist_append(headers, "Transfer-Encoding: chunked");
+
+  // Reset the state of the curl session to its default state.
+  curl_easy_reset(curl);
+  // Set the URL for the CURL request.
+  curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+  // Set the custom headers for the CURL request.
+  curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+  // Enable TCP keep-alive on the CURL handle to reuse the connection.
+  curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+  // Enable the POST method for the request.
+  curl_easy_setopt(curl, CURLOPT_POST, 1L);
+  // Send the body with the read callback
+  curl_easy_setopt(curl, CURLOPT_READFUNCTION, curlReadCallback);
+  curl_easy_setopt(curl, CURLOPT_READDATA, &stream);
+  if (!chunked) curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE_LARGE, curl_off_t(body.size()));
+  // Set the function to handle writing the data received in response.
+  curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, curlWriteCallback);
+  // Set the variable where the response data will be stored.
+  curl_easy_setopt(curl, CURLOPT_WRITEDATA, &readBuffer);
+
+  // Perform the CURL request and store the result in 'res'
+  res = curl_easy_perform(curl);
+  if(res == CURLE_OK) {
+    // Retrieve the HTTP response code.
+    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response_code);
+    if(response_code == 200 && readBuffer == body) {
+      testPassed = true; // Set the test result to passed if conditions are met.
+    } else {
+      cerr << "Test failed for URL: " << url << (chunked ? " (chunked)" : "") << endl;
+      cerr << "Expected response: 200 with " << body.size() << " bytes but got: "
+           << response_code << " with " << readBuffer.size() << " bytes" << endl;
+    }
+  } else {
+    // Output the CURL error.
+    cerr << "CURL error: " << curl_easy_strerror(res) << endl;
+  }
+
+  curl_slist_free_all(headers); // Clean up headers after each request.
+
+  return testPassed;
+}
+
+// Sends a GET request on a new connection and checks that the response equals the expected body.
+bool performGetTest(const string& url, const string& expectedBody) {
+  string readBuffer; // String to store the response data.
+  long response_code = 0; // Variable to store the HTTP response code.
+  bool testPassed = false; // Flag to indicate if the test passed or failed.
+
+  CURL *curl = curl_easy_init();
+  if (!curl) return false;
+  curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+  curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, curlWriteCallback);
+  curl_easy_setopt(curl, CURLOPT_WRITEDATA, &readBuffer);
+  // The request fails if the event loop does not serve it in time
+  curl_easy_setopt(curl, CURLOPT_TIMEOUT, 5L);
+
+  CURLcode res = curl_easy_perform(curl);
+  if(res == CURLE_OK) {
+    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response_code);
+    if(response_code == 200 && readBuffer == expectedBody) {
+      testPassed = true;
+    } else {
+      cerr << "Test failed for URL: " << url << endl;
+      cerr << "Expected response: 200 with " << expectedBody
+           << " but got: " << response_code << " with " << readBuffer << endl;
+    }
+  } else {
+    cerr << "CURL error for URL " << url << ": " << curl_easy_strerror(res) << endl;
+  }
+
+  curl_easy_cleanup(curl);
+  return testPassed;
+}
+
+// Uploads the body into a pipe with a slow reader and checks that another connection
+// is served by the same event loop while the splice waits until the pipe is writable.
+bool performPipeTest(const string& baseUrl, const string& body, bool chunked, atomic<bool>& spliceStarted) {
+  spliceStarted = false;
+  future<bool> upload = async(launch::async, [&]() {
+    CURL *curl = curl_easy_init();
+    if (!curl) return false;
+    bool passed = performTestWithBody(curl, baseUrl + "/splice_pipe", body, chunked);
+    curl_easy_cleanup(curl);
+    return passed;
+  });
+
+  // Wait until the function started splicing into the pipe
+  auto deadline = chrono::steady_clock::now() + chrono::seconds(10);
+  while (!spliceStarted && chrono::steady_clock::now() < deadline) {
+    this_thread::sleep_for(chrono::milliseconds(1));
+  }
+  bool testPassed = spliceStarted.load();
+  if (!testPassed) cerr << "Splice into pipe did not start" << endl;
+
+  // The pipe reader starts reading once this request was served
+  testPassed &= performGetTest(baseUrl + "/ping", "pong");
+  testPassed &= upload.get();
+  return testPassed;
+}
+
+// Sends a chunked body with the chunk delimiters split over multiple packets
+// and checks that the spliced body equals the data.
+bool performSplitDelimiterTest(const string& host, int port, const vector<string>& chunks) {
+  struct sockaddr_in addr = {};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  inet_pton(AF_INET, host.c_str(), &addr.sin_addr);
+  int sock = socket(AF_INET, SOCK_STREAM, 0);
+  if (sock < 0 || connect(sock, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+    cerr << "Failed connecting to test server" << endl;
+    if (sock >= 0) close(sock);
+    return false;
+  }
+  // Sends the data as separate packet
+  auto sendPacket = [sock](const string& data) {
+    send(sock, data.data(), data.size(), MSG_NOSIGNAL);
+    this_thread::sleep_for(chrono::milliseconds(10));
+  };
+
+  sendPacket("POST /splice HTTP/1.1\r\nHost: localhost\r\nTransfer-Encoding: chunked\r\nConnection: close\r\n\r\n");
+  string body;
+  for (const string& chunk : chunks) {
+    char sizeLine[32];
+    snprintf(sizeLine, sizeof(sizeLine), "%zx;ext=1\r\n", chunk.size());
+    string line = sizeLine;
+    // Split the size line and the CRLF after the data
+    sendPacket(line.substr(0, 1));
+    sendPacket(line.substr(1));
+    sendPacket(chunk + "\r");
+    sendPacket("\n");
+    body += chunk;
+  }
+  sendPacket("0\r\n");
+  sendPacket("\r\n");
+
+  // Read the response until the connection is closed
+  string response;
+  char buffer[4096];
+  ssize_t n;
+  while ((n = recv(sock, buffer, sizeof(buffer), 0)) > 0) response.append(buffer, n);
+  close(sock);
+
+  bool testPassed = response.starts_with("HTTP/1.1 200") &&
+    response.size() >= body.size() && response.compare(response.size()-body.size(), body.size(), body) == 0;
+  if (!testPassed) {
+    cerr << "Test failed for chunked body with split delimiters" << endl;
+    cerr << "Expected response: 200 with " << body.size() << " bytes but got: " << response.substr(0, 12) << endl;
+  }
+  return testPassed;
+}
+
+// Runs all tests against a server running on the event backend.
+bool performBackendTests(EventBackend backend, const filesystem::path& directory) {
+  // Test server port
+  int port = 8080;
+  // Test server host
+  string host = "127.0.0.1";
+  // Base URL for the test server.
+  string baseUrl = "http://"+host+":"+to_string(port);
+  // Flag to indicate if all tests passed.
+  bool allTestsPassed = true;
+
+  // Create test server
+  Server server(host, port, {
+    // Buffer is smaller then the full data block, to have multiple event loop iterations
+    .sockBufferSize = 700,
+    .eventBackend = backend,
+  });
+
+  // Define routes
+
+  // This route moves the full body into a file with body.spliceTo() and returns the file content.
+  server.Route("POST", "/splice", [&directory](Request &req, Body &body, Response &res) -> Task<bool> {
+    filesystem::path path = directory / "splice.bin";
+    int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+      res.setStatusCode(500);
+      co_return false;
+    }
+    while (co_await body.spliceTo(fd, SIZE_MAX) > 0);
+    close(fd);
+    res.setStatusCode(200).setBody(readFile(path));
+    co_return true;
+  });
+
+  // This route reads the start of the body into memory and moves the rest into a file in small steps.
+  // Every step must not move more then the requested amount.
+  server.Route("POST", "/splice_steps", [&directory](Request &req, Body &body, Response &res) -> Task<bool> {
+    filesystem::path path = directory / "splice_steps.bin";
+    int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+      res.setStatusCode(500);
+      co_return false;
+    }
+    auto head = co_await body.read(100);
+    string content(head.begin(), head.end());
+    size_t n;
+    bool stepsValid = true;
+    while ((n = co_await body.spliceTo(fd, 5000)) > 0) {
+      stepsValid &= n <= 5000;
+    }
+    close(fd);
+    content += readFile(path);
+    res.setStatusCode(stepsValid ? 200 : 500).setBody(content);
+    co_return true;
+  });
+
+  // Set once the function splices into the pipe
+  atomic<bool> spliceStarted = false;
+  // Set once the ping was served
+  atomic<bool> pingServed = false;
+
+  // This route moves the full body into a non-blocking pipe, which is read by a slow reader on another thread.
+  // The reader starts after the ping was served, so that the splice blocks until the pipe is writable again.
+  server.Route("POST", "/splice_pipe", [&](Request &req, Body &body, Response &res) -> Task<bool> {
+    int fds[2];
+    if (pipe2(fds, O_NONBLOCK | O_CLOEXEC) < 0) {
+      res.setStatusCode(500);
+      co_return true;
+    }
+    // Only the write end is non-blocking
+    fcntl(fds[0], F_SETFL, fcntl(fds[0], F_GETFL, 0) & ~O_NONBLOCK);
+    future<string> reader = async(launch::async, [&pingServed, fd = fds[0]]() {
+      auto deadline = chrono::steady_clock::now() + chrono::seconds(10);
+      while (!pingServed && chrono::steady_clock::now() < deadline) {
+        this_thread::sleep_for(chrono::milliseconds(1));
+      }
+      string content;
+      char buffer[16384];
+      ssize_t n;
+      while ((n = read(fd, buffer, sizeof(buffer))) > 0) {
+        content.append(buffer, n);
+        this_thread::sleep_for(chrono::microseconds(200));
+      }
+      close(fd);
+      return content;
+    });
+    spliceStarted = true;
+    while (co_await body.spliceTo(fds[1], SIZE_MAX) > 0);
+    close(fds[1]);
+    string content = reader.get();
+    pingServed = false;
+    res.setStatusCode(200).setBody(content);
+    co_return true;
+  });
+
+  // This route is requested on another connection while the splice into the pipe waits.
+  server.Route("GET", "/ping", [&pingServed](Request &req, Body &body, Response &res) -> Task<bool> {
+    pingServed = true;
+    res.setStatusCode(200).setBody("pong");
+    co_return true;
+  });
+
+  // Start server in a seperate thread
+  cout << "Starting local test server on " << host << ":" << port << endl;
+  future<void> serverFut = async(launch::async, [&server]() {
+    server.Serve();
+  });
+
+  // Initialize CURL session.
+  CURL *curl = curl_easy_init();
+  if (!curl) {
+    // Report failure if CURL session wasn't successfully initialized.
+    cerr << "Failed to initialize CURL." << endl;
+    server.Kill();
+    return false;
+  }
+
+  // Use base url to try connection
+  curl_easy_setopt(curl, CURLOPT_URL, baseUrl.c_str());
+  curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, curlDiscardCallback);
+
+  // Try to connect to the test server (5 retries, 10s maximum delay)
+  CURLcode res = tryConnect(curl, 5, 10);
+  if (res != CURLE_OK) {
+    cerr << "Failed connecting to test server: " << curl_easy_strerror(res) << endl;
+    server.Kill();
+    return false;
+  }
+
+  // Bodies larger then the socket buffer (the large body is sent in chunks of curls upload buffer size)
+  string smallBody = generateStringFromPattern("SuperMegakuul!", 2500);
+  string largeBody = generateStringFromPattern("SpliceMeToDisk!", 4 << 20);
+
+  for (bool chunked : {false, true}) {
+    allTestsPassed &= performTestWithBody(curl, baseUrl + "/splice", smallBody, chunked);
+    allTestsPassed &= performTestWithBody(curl, baseUrl + "/splice", largeBody, chunked);
+    allTestsPassed &= performTestWithBody(curl, baseUrl + "/splice", "", chunked);
+    allTestsPassed &= performTestWithBody(curl, baseUrl + "/splice_steps", smallBody, chunked);
+    allTestsPassed &= performTestWithBody(curl, baseUrl + "/splice_steps", largeBody, chunked);
+    allTestsPassed &= performPipeTest(baseUrl, largeBody, chunked, spliceStarted);
+  }
+  allTestsPassed &= performSplitDelimiterTest(host, port, {smallBody, "x", largeBody.substr(0, 70000)});
+
+  // Cleanup curl session
+  curl_easy_cleanup(curl);
+
+  // Kill test server
+  server.Kill();
+
+  // Wait for the server to exit
+  serverFut.get();
+  return allTestsPassed;
+}
+
+int main(void) {
+  // Directory holding the written files
+  filesystem::path directory = filesystem::temp_directory_path() / "simplehttp_splice_test";
+  filesystem::create_directories(directory);
+  // Flag to indicate if all tests passed.
+  bool allTestsPassed = true;
+
+  allTestsPassed &= performBackendTests(EventBackend::EPOLL, directory);
+  allTestsPassed &= performBackendTests(EventBackend::IO_URING, directory);
+
+  filesystem::remove_all(directory);
+
+  if(allTestsPassed) {
+    cout << "All tests passed." << endl;
+    return 0;
+  } else {
+    cout << "One or more tests failed." << endl;
+    return 1;
+  }
+}
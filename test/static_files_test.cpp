@@ -0,0 +1,248 @@
+#include <iostream>
+#include <string>
+#include <thread>
+#include <future>
+#include <fstream>
+#include <filesystem>
+
+#include "curl/curl.h"
+#include "src/simplehttp.hpp"
+
+using namespace std;
+
+using namespace SimpleHTTP;
+
+// Attempts to connect to the server with exponential backoff.
+// Returns CURLE_OK on success, or the CURL error code on failure.
+CURLcode tryConnect(CURL* curl, int maxRetries, int maxDelaySeconds) {
+  int retries = 0;
+  int delaySeconds = 1; // Initial delay is 1 sec
+  CURLcode res;
+
+  // Check if curl handle is valid
+  if (!curl) return CURLE_FAILED_INIT;
+
+  // Try until max retries are reached
+  while (retries < maxRetries) {
+    res = curl_easy_perform(curl);
+    // Check if the operation was successful
+    if (res == CURLE_OK) return res;
+    // If not successful, wait for the exponential backoff delay
+    this_thread::sleep_for(std::chrono::seconds(delaySeconds));
+
+    // Update retries and increment delay
+    retries++;
+    delaySeconds *= 2;
+    // If max delay is reached, cap the delay
+    if (delaySeconds > maxDelaySeconds)
+      delaySeconds = maxDelaySeconds;
+  }
+  // If all retries are exhausted, return the last error code
+  cerr << "Connection failed after " << maxRetries << " retries\n";
+  return res;
+}
+
+// Callback function for curl fetch
+size_t curlWriteCallback(void *contents, size_t size, size_t nmemb, string *userp) {
+  userp->append((char*)contents, size * nmemb);
+  return size * nmemb;
+}
+
+// Callback function for curl fetch discarding data
+size_t curlDiscardCallback(void *buffer, size_t size, size_t nmemb, void *userp) {
+  return size * nmemb; // Indicate success but don't write the data
+}
+
+// Writes the content to the file
+void writeFile(const filesystem::path& path, const string& content) {
+  filesystem::create_directories(path.parent_path());
+  ofstream file(path, ios::binary | ios::trunc);
+  file << content;
+}
+
+// Generate a string from a pattern by repeating it
+string generateStringFromPattern(const string& pattern, int count) {
+  string result;
+  for (string::size_type i = 0; i < count / pattern.size(); i++)
+    result += pattern;
+  // Get remainder from module and add it to the strings front
+  int remainder = count % pattern.size();
+  if (remainder > 0)
+    result += pattern.substr(0, remainder);
+  return result;
+}
+
+// Performs a GET request and checks the status code, body and (if not empty) the Content-Type.
+// If modifiedSince is not 0, the request is sent with an If-Modified-Since header.
+bool performTest(CURL *curl, const string& url, long expectedCode, const string& expectedBody,
+                 const string& expectedContentType, time_t modifiedSince = 0) {
+  CURLcode res; // Variable to store the result of the CURL operation.
+  string readBuffer; // String to store the response data.
+  long response_code; // Variable to store the HTTP response code.
+  bool testPassed = false; // Flag to indicate if the test passed or failed.
+
+  // Reset the state of the curl session to its default state.
+  curl_easy_reset(curl);
+  // Set the URL for the CURL request.
+  curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+  // Send the path without normalizing dot segments
+  curl_easy_setopt(curl, CURLOPT_PATH_AS_IS, 1L);
+  // Enable TCP keep-alive on the CURL handle to reuse the connection.
+  curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+  if (modifiedSince != 0) {
+    // Send If-Modified-Since header
+    curl_easy_setopt(curl, CURLOPT_TIMECONDITION, CURL_TIMECOND_IFMODSINCE);
+    curl_easy_setopt(curl, CURLOPT_TIMEVALUE, long(modifiedSince));
+  }
+  // Set the function to handle writing the data received in response.
+  curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, curlWriteCallback);
+  // Set the variable where the response data will be stored.
+  curl_easy_setopt(curl, CURLOPT_WRITEDATA, &readBuffer);
+
+  // Perform the CURL request and store the result in 'res'.
+  res = curl_easy_perform(curl);
+  if(res == CURLE_OK) {
+    // Retrieve the HTTP response code and content type.
+    char *contentType = nullptr;
+    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response_code);
+    curl_easy_getinfo(curl, CURLINFO_CONTENT_TYPE, &contentType);
+    if(response_code == expectedCode && readBuffer == expectedBody &&
+       (expectedContentType.empty() || (contentType && expectedContentType == contentType))) {
+      testPassed = true; // Set the test result to passed if conditions are met.
+    } else {
+      cerr << "Test failed for URL: " << url << endl;
+      cerr << "Expected response: " << expectedCode << " with " << expectedBody.size() << " bytes ("
+           << expectedContentType << ") but got: " << response_code << " with " << readBuffer.size()
+           << " bytes (" << (contentType ? contentType : "") << ")" << endl;
+    }
+  } else {
+    cerr << "CURL error: " << curl_easy_strerror(res) << endl;
+  }
+
+  return testPassed;
+}
+
+// Runs all tests against a server running on the event backend.
+bool performBackendTests(EventBackend backend, const filesystem::path& directory) {
+  // Test server port
+  int port = 8080;
+  // Test server host
+  string host = "127.0.0.1";
+  // Base URL for the test server.
+  string baseUrl = "http://"+host+":"+to_string(port);
+  // Flag to indicate if all tests passed.
+  bool allTestsPassed = true;
+
+  // Create test files
+  string text = "static text file\n";
+  string large = generateStringFromPattern("LargeStaticFile!", 8 << 20);
+  string index = "<html>index</html>";
+  writeFile(directory / "text.txt", text);
+  writeFile(directory / "large.bin", large);
+  writeFile(directory / "sub" / "index.html", index);
+  writeFile(directory.parent_path() / "secret.txt", "secret");
+
+  // Create test server
+  Server server(host, port, {
+    .eventBackend = backend,
+  });
+
+  // Serve the directory below /static
+  server.Static("/static", directory.string());
+
+  // This route tests sending a range of a file.
+  server.Route("GET", "/range", [&directory](Request &req, Body &body, Response &res) -> Task<bool> {
+    if (!res.sendFile((directory / "large.bin").string(), 16, 32)) {
+      res.setStatusCode(500);
+    }
+    co_return true;
+  });
+
+  // Start server in a seperate thread
+  cout << "Starting local test server on " << host << ":" << port << endl;
+  future<void> serverFut = async(launch::async, [&server]() {
+    server.Serve();
+  });
+
+  // Initialize CURL session.
+  CURL *curl = curl_easy_init();
+  if (!curl) {
+    // Report failure if CURL session wasn't successfully initialized.
+    cerr << "Failed to initialize CURL." << endl;
+    server.Kill();
+    return false;
+  }
+
+  // Use base url to try connection
+  curl_easy_setopt(curl, CURLOPT_URL, baseUrl.c_str());
+  curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, curlDiscardCallback);
+
+  // Try to connect to the test server (5 retries, 10s maximum delay)
+  CURLcode res = tryConnect(curl, 5, 10);
+  if (res != CURLE_OK) {
+    cerr << "Failed connecting to test server: " << curl_easy_strerror(res) << endl;
+    server.Kill();
+    return false;
+  }
+
+  // Test small and large files (the large file is sent in multiple sendfile calls)
+  allTestsPassed &= performTest(curl, baseUrl + "/static/text.txt", 200, text, "text/plain; charset=utf-8");
+  allTestsPassed &= performTest(curl, baseUrl + "/static/large.bin", 200, large, "application/octet-stream");
+  allTestsPassed &= performTest(curl, baseUrl + "/static/text.txt", 200, text, "text/plain; charset=utf-8");
+
+  // Test index of a directory
+  allTestsPassed &= performTest(curl, baseUrl + "/static/sub/", 200, index, "text/html; charset=utf-8");
+
+  // Test a range of a file
+  allTestsPassed &= performTest(curl, baseUrl + "/range", 200, large.substr(16, 32), "");
+
+  // Test missing files, directories and paths outside of the directory
+  string notFound = "The requested resource /static/missing.txt was not found on this server\n";
+  allTestsPassed &= performTest(curl, baseUrl + "/static/missing.txt", 404, notFound, "");
+  notFound = "The requested resource /static/sub was not found on this server\n";
+  allTestsPassed &= performTest(curl, baseUrl + "/static/sub", 404, notFound, "");
+  notFound = "The requested resource /static/../secret.txt was not found on this server\n";
+  allTestsPassed &= performTest(curl, baseUrl + "/static/../secret.txt", 404, notFound, "");
+
+  // Test conditional requests
+  auto lastWrite = filesystem::last_write_time(directory / "text.txt");
+  time_t modified = chrono::system_clock::to_time_t(chrono::file_clock::to_sys(lastWrite));
+  allTestsPassed &= performTest(curl, baseUrl + "/static/text.txt", 304, "", "", modified);
+  allTestsPassed &= performTest(curl, baseUrl + "/static/text.txt", 200, text, "", modified - 10);
+
+  // Test that modified files are reopened (cached files are revalidated after one second)
+  text = "modified static text file\n";
+  writeFile(directory / "text.txt", text);
+  this_thread::sleep_for(chrono::milliseconds(1100));
+  allTestsPassed &= performTest(curl, baseUrl + "/static/text.txt", 200, text, "");
+
+  // Cleanup curl session
+  curl_easy_cleanup(curl);
+
+  // Kill test server
+  server.Kill();
+
+  // Wait for the server to exit
+  serverFut.get();
+  return allTestsPassed;
+}
+
+int main(void) {
+  // Directory holding the served files
+  filesystem::path directory = filesystem::temp_directory_path() / "simplehttp_static_test" / "public";
+  // Flag to indicate if all tests passed.
+  bool allTestsPassed = true;
+
+  allTestsPassed &= performBackendTests(EventBackend::EPOLL, directory);
+  allTestsPassed &= performBackendTests(EventBackend::IO_URING, directory);
+
+  filesystem::remove_all(directory.parent_path());
+
+  if(allTestsPassed) {
+    cout << "All tests passed." << endl;
+    return 0;
+  } else {
+    cout << "One or more tests failed." << endl;
+    return 1;
+  }
+}
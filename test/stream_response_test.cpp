@@ -0,0 +1,194 @@
+#include <iostream>
+#include <string>
+#include <thread>
+#include <future>
+
+#include "curl/curl.h"
+#include "src/simplehttp.hpp"
+
+using namespace std;
+
+using namespace SimpleHTTP;
+
+// Attempts to connect to the server with exponential backoff.
+// Returns CURLE_OK on success, or the CURL error code on failure.
+CURLcode tryConnect(CURL* curl, int maxRetries, int maxDelaySeconds) {
+  int retries = 0;
+  int delaySeconds = 1; // Initial delay is 1 sec
+  CURLcode res; 
+
+  // Check if curl handle is valid
+  if (!curl) return CURLE_FAILED_INIT;
+
+  // Try until max retries are reached
+  while (retries < maxRetries) {
+    res = curl_easy_perform(curl);
+    // Check if the operation was successful
+    if (res == CURLE_OK) return res;
+    // If not successful, wait for the exponential backoff delay
+    this_thread::sleep_for(std::chrono::seconds(delaySeconds));
+
+    // Update retries and increment delay
+    retries++;
+    delaySeconds *= 2;
+    // If max delay is reached, cap the delay
+    if (delaySeconds > maxDelaySeconds)
+      delaySeconds = maxDelaySeconds;
+  }
+  // If all retries are exhausted, return the last error code
+  cerr << "Connection failed after " << maxRetries << " retries\n";
+  return res;
+}
+
+// Callback function for curl fetch
+size_t curlWriteCallback(void *contents, size_t size, size_t nmemb, string *userp) {
+  userp->append((char*)contents, size * nmemb);
+  return size * nmemb;
+}
+
+// Callback function for curl fetch discarding data
+size_t curlDiscardCallback(void *buffer, size_t size, size_t nmemb, void *userp) {
+  return size * nmemb; // Indicate success but don't write the data
+}
+
+// Perform streaming test and verify the chunked transfer and the received body
+bool performStreamTest(CURL *curl, const string& url, const string& expectedResponse) {
+  CURLcode res; // Variable to store the result of the CURL operation.
+  string readBuffer; // String to store the response data.
+  long response_code; // Variable to store the HTTP response code.
+  bool testPassed = false; // Flag to indicate if the test passed or failed.
+
+  // Reset the state of the curl session to its default state.
+  curl_easy_reset(curl);
+  // Set the URL for the CURL request.
+  curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+  // Enable TCP keep-alive on the CURL handle to reuse the connection.
+  curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+  // Set the function to handle writing the data received in response.
+  curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, curlWriteCallback); 
+  // Set the variable where the response data will be stored.
+  curl_easy_setopt(curl, CURLOPT_WRITEDATA, &readBuffer); 
+
+  // Perform the CURL request and store the result in 'res'
+  res = curl_easy_perform(curl);
+  if(res == CURLE_OK) {
+    // Retrieve the HTTP response code.
+    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response_code);
+    if(response_code == 200 && readBuffer == expectedResponse) {
+      testPassed = true; // Set the test result to passed if conditions are met.
+    } else {
+      cerr << "Test failed for URL: " << url << endl;
+      cerr << "Expected response of size " << expectedResponse.size()
+           << " but got response of size " << readBuffer.size() << endl;
+    }
+  } else {
+    cerr << "CURL error: " << curl_easy_strerror(res) << endl;
+  }
+
+  return testPassed;
+}
+
+// Generate a string from a pattern by repeating it
+string generateStringFromPattern(const string& pattern, int count) {
+  string result;
+  for (string::size_type i = 0; i < count / pattern.size(); i++)
+    result += pattern;
+  // Get remainder from module and add it to the strings front
+  int remainder = count % pattern.size();
+  if (remainder > 0)
+    result += pattern.substr(0, remainder);
+  return result;
+}
+
+int main(void) {
+  // Test server port
+  int port = 8080;
+  // Test server host
+  string host = "127.0.0.1";
+  // Base URL for the test server.
+  string baseUrl = "http://"+host+":"+to_string(port);
+  // Block written on every write call.
+  string block = generateStringFromPattern("SuperMegakuul!", 10000);
+  // Number of blocks written (the streamed body exceeds the maxResponseQueueSize several times)
+  int blockCount = 500;
+  // Flag to indicate if all tests passed.
+  bool allTestsPassed = true;
+
+  // Create test server
+  Server server(host, port);
+
+  // Define routes
+
+  // This route tests the server's ability to stream a large body with backpressure.
+  // Every block is written as one chunk, the body is never materialized in the response.
+  server.Route("GET", "/stream_write", [&](Request &req, Body &body, Response &res) -> Task<bool> {
+    for (int i = 0; i < blockCount; i++) {
+      co_await res.write(block);
+    }
+    co_return true;
+  });
+
+  // This route tests flushing small writes and sending the body set by setBody() as last chunk.
+  server.Route("GET", "/stream_flush", [&](Request &req, Body &body, Response &res) -> Task<bool> {
+    co_await res.flush();
+    for (int i = 0; i < 10; i++) {
+      co_await res.write(to_string(i));
+      co_await res.flush();
+    }
+    res.setBody("done");
+    co_return true;
+  });
+
+  // Start server in a seperate thread
+  cout << "Starting local test server on " << host << ":" << port << endl;
+  future<void> serverFut = async(launch::async, [&server]() {
+    server.Serve();
+  });
+  
+  // Initialize CURL session.
+  CURL *curl = curl_easy_init();
+  if (!curl) {
+    // Report failure if CURL session wasn't successfully initialized.
+    cerr << "Failed to initialize CURL." << endl;
+    return 1; 
+  }
+
+  // Use base url to try connection
+  curl_easy_setopt(curl, CURLOPT_URL, baseUrl.c_str());
+  curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, curlDiscardCallback);
+
+  // Try to connect to the test server (5 retries, 10s maximum delay)
+  CURLcode res = tryConnect(curl, 5, 10);
+  if (res != CURLE_OK) {
+    cerr << "Failed connecting to test server: " << curl_easy_strerror(res) << endl;
+    server.Kill();
+    return 1;
+  }
+
+  // Test streaming a large body
+  string expectedStream;
+  for (int i = 0; i < blockCount; i++) {
+    expectedStream += block;
+  }
+  allTestsPassed &= performStreamTest(curl, baseUrl + "/stream_write", expectedStream);
+
+  // Test flushing small chunks (on the same connection)
+  allTestsPassed &= performStreamTest(curl, baseUrl + "/stream_flush", "0123456789done");
+
+  // Cleanup curl session
+  curl_easy_cleanup(curl);
+
+  // Kill test server
+  server.Kill();
+
+  // Wait for the server to exit
+  serverFut.get();
+
+  if(allTestsPassed) {
+    cout << "All tests passed." << endl;
+    return 0;
+  } else {
+    cout << "One or more tests failed." << endl;
+    return 1;
+  }
+}
@@ -0,0 +1,312 @@
+#include <iostream>
+#include <string>
+#include <thread>
+#include <future>
+#include <chrono>
+
+#include <sys/socket.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "curl/curl.h"
+#include "src/simplehttp.hpp"
+
+using namespace std;
+
+using namespace SimpleHTTP;
+
+// Attempts to connect to the server with exponential backoff.
+// Returns CURLE_OK on success, or the CURL error code on failure.
+CURLcode tryConnect(CURL* curl, int maxRetries, int maxDelaySeconds) {
+  int retries = 0;
+  int delaySeconds = 1; // Initial delay is 1 sec
+  CURLcode res;
+
+  // Check if curl handle is valid
+  if (!curl) return CURLE_FAILED_INIT;
+
+  // Try until max retries are reached
+  while (retries < maxRetries) {
+    res = curl_easy_perform(curl);
+    // Check if the operation was successful
+    if (res == CURLE_OK) return res;
+    // If not successful, wait for the exponential backoff delay
+    this_thread::sleep_for(std::chrono::seconds(delaySeconds));
+
+    // Update retries and increment delay
+    retries++;
+    delaySeconds *= 2;
+    // If max delay is reached, cap the delay
+    if (delaySeconds > maxDelaySeconds)
+      delaySeconds = maxDelaySeconds;
+  }
+  // If all retries are exhausted, return the last error code
+  cerr << "Connection failed after " << maxRetries << " retries\n";
+  return res;
+}
+
+// Callback function for curl fetch
+size_t curlWriteCallback(void *contents, size_t size, size_t nmemb, string *userp) {
+  userp->append((char*)contents, size * nmemb);
+  return size * nmemb;
+}
+
+// Callback function for curl fetch discarding data
+size_t curlDiscardCallback(void *buffer, size_t size, size_t nmemb, void *userp) {
+  return size * nmemb; // Indicate success but don't write the data
+}
+
+// Performs a GET request with a new curl session and checks the status code and body.
+// If timeoutMs is not 0, the request is aborted after the timeout (no response is expected).
+bool performTest(const string& url, long expectedCode, const string& expectedBody, long timeoutMs = 0) {
+  CURLcode res; // Variable to store the result of the CURL operation.
+  string readBuffer; // String to store the response data.
+  long response_code; // Variable to store the HTTP response code.
+  bool testPassed = false; // Flag to indicate if the test passed or failed.
+
+  // Every test uses its own session, so that tests can run in parallel
+  CURL *curl = curl_easy_init();
+  if (!curl) {
+    cerr << "Failed to initialize CURL." << endl;
+    return false;
+  }
+  // Set the URL for the CURL request.
+  curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+  // Abort the request after the timeout
+  if (timeoutMs != 0) curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS, timeoutMs);
+  // Set the function to handle writing the data received in response.
+  curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, curlWriteCallback);
+  // Set the variable where the response data will be stored.
+  curl_easy_setopt(curl, CURLOPT_WRITEDATA, &readBuffer);
+
+  // Perform the CURL request and store the result in 'res'.
+  res = curl_easy_perform(curl);
+  if (timeoutMs != 0) {
+    testPassed = res == CURLE_OPERATION_TIMEDOUT;
+    if (!testPassed) cerr << "Test failed for URL: " << url << ", expected the request to time out" << endl;
+  } else if(res == CURLE_OK) {
+    // Retrieve the HTTP response code.
+    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response_code);
+    if(response_code == expectedCode && readBuffer == expectedBody) {
+      testPassed = true; // Set the test result to passed if conditions are met.
+    } else {
+      cerr << "Test failed for URL: " << url << endl;
+      cerr << "Expected response: " << expectedCode << " with " << expectedBody
+           << " but got: " << response_code << " with " << readBuffer << endl;
+    }
+  } else {
+    // Output the CURL error.
+    cerr << "CURL error: " << curl_easy_strerror(res) << endl;
+  }
+
+  curl_easy_cleanup(curl);
+  return testPassed;
+}
+
+// Writes the data to the filedescriptor after the delay on a separate thread and closes it afterwards
+void writeDelayed(int fd, const string& data, chrono::milliseconds delay) {
+  thread([fd, data, delay]() {
+    this_thread::sleep_for(delay);
+    write(fd, data.data(), data.size());
+    close(fd);
+  }).detach();
+}
+
+// Runs all tests against a server running on the event backend.
+bool performBackendTests(EventBackend backend, bool edgeTriggered) {
+  // Test server port
+  int port = 8080;
+  // Test server host
+  string host = "127.0.0.1";
+  // Base URL for the test server.
+  string baseUrl = "http://"+host+":"+to_string(port);
+  // Flag to indicate if all tests passed.
+  bool allTestsPassed = true;
+
+  // Create test server
+  Server server(host, port, {
+    .eventBackend = backend,
+    .edgeTriggered = edgeTriggered,
+  });
+
+  // Define routes
+
+  // This route waits on a pipe, which is written by another thread, and returns the received data.
+  server.Route("GET", "/pipe", [](Request &req, Body &body, Response &res) -> Task<bool> {
+    int fds[2];
+    if (pipe2(fds, O_NONBLOCK | O_CLOEXEC) < 0) {
+      res.setStatusCode(500);
+      co_return true;
+    }
+    writeDelayed(fds[1], "from pipe", chrono::milliseconds(300));
+    string data;
+    char buffer[64];
+    while (1) {
+      co_await waitReadable(fds[0]);
+      ssize_t n = read(fds[0], buffer, sizeof(buffer));
+      if (n < 1) break;
+      data.append(buffer, n);
+    }
+    close(fds[0]);
+    res.setStatusCode(200).setBody(data);
+    co_return true;
+  });
+
+  // This route sends a request to a backend over a unix socket pair and returns its response.
+  // The socket buffer is filled first, so that the function waits until the socket is writable again.
+  server.Route("GET", "/backend", [](Request &req, Body &body, Response &res) -> Task<bool> {
+    int fds[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0, fds) < 0) {
+      res.setStatusCode(500);
+      co_return true;
+    }
+    // Backend reads the full request and echoes its size
+    thread([fd = fds[1]]() {
+      size_t total = 0;
+      char buffer[4096];
+      ssize_t n;
+      fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) & ~O_NONBLOCK);
+      this_thread::sleep_for(chrono::milliseconds(100));
+      while ((n = read(fd, buffer, sizeof(buffer))) > 0) {
+        total += n;
+        if (total >= 1 << 20) break;
+      }
+      string response = to_string(total);
+      write(fd, response.data(), response.size());
+      close(fd);
+    }).detach();
+
+    string request(1 << 20, 'R');
+    size_t sent = 0;
+    bool waitedWritable = false;
+    while (sent < request.size()) {
+      ssize_t n = write(fds[0], request.data()+sent, request.size()-sent);
+      if (n > 0) {
+        sent += n;
+        continue;
+      }
+      waitedWritable = true;
+      co_await waitWritable(fds[0]);
+    }
+    string response;
+    char buffer[64];
+    while (1) {
+      co_await waitReadable(fds[0]);
+      ssize_t n = read(fds[0], buffer, sizeof(buffer));
+      if (n < 1) break;
+      response.append(buffer, n);
+    }
+    close(fds[0]);
+    res.setStatusCode(waitedWritable ? 200 : 500).setBody(response);
+    co_return true;
+  });
+
+  // This route waits on a pipe with a timeout, afterwards the pipe is awaited again until it is written.
+  server.Route("GET", "/timeout", [](Request &req, Body &body, Response &res) -> Task<bool> {
+    int fds[2];
+    if (pipe2(fds, O_NONBLOCK | O_CLOEXEC) < 0) {
+      res.setStatusCode(500);
+      co_return true;
+    }
+    auto events = co_await withTimeout(waitReadable(fds[0]), chrono::milliseconds(100));
+    string result = events ? "ready" : "expired";
+    writeDelayed(fds[1], "x", chrono::milliseconds(100));
+    events = co_await withTimeout(waitReadable(fds[0]), chrono::seconds(5));
+    result += events && events.value() & EPOLLIN ? ",ready" : ",expired";
+    close(fds[0]);
+    res.setStatusCode(200).setBody(result);
+    co_return true;
+  });
+
+  // This route waits on an invalid filedescriptor, which throws inside of the function.
+  server.Route("GET", "/invalid", [](Request &req, Body &body, Response &res) -> Task<bool> {
+    try {
+      co_await waitReadable(-1);
+      res.setStatusCode(200);
+    } catch (exception &e) {
+      res.setStatusCode(500).setBody("invalid");
+    }
+    co_return true;
+  });
+
+  // This route answers immediately.
+  server.Route("GET", "/fast", [](Request &req, Body &body, Response &res) -> Task<bool> {
+    res.setStatusCode(200).setBody("fast");
+    co_return true;
+  });
+
+  // Start server in a seperate thread
+  cout << "Starting local test server on " << host << ":" << port << endl;
+  future<void> serverFut = async(launch::async, [&server]() {
+    server.Serve();
+  });
+
+  // Initialize CURL session.
+  CURL *curl = curl_easy_init();
+  if (!curl) {
+    // Report failure if CURL session wasn't successfully initialized.
+    cerr << "Failed to initialize CURL." << endl;
+    server.Kill();
+    return false;
+  }
+
+  // Use base url to try connection
+  curl_easy_setopt(curl, CURLOPT_URL, baseUrl.c_str());
+  curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, curlDiscardCallback);
+
+  // Try to connect to the test server (5 retries, 10s maximum delay)
+  CURLcode res = tryConnect(curl, 5, 10);
+  curl_easy_cleanup(curl);
+  if (res != CURLE_OK) {
+    cerr << "Failed connecting to test server: " << curl_easy_strerror(res) << endl;
+    server.Kill();
+    return false;
+  }
+
+  // Test that the loop answers other requests while a function waits on a pipe
+  future<bool> pipeFut = async(launch::async, [&baseUrl]() {
+    return performTest(baseUrl + "/pipe", 200, "from pipe");
+  });
+  this_thread::sleep_for(chrono::milliseconds(100));
+  auto start = chrono::steady_clock::now();
+  allTestsPassed &= performTest(baseUrl + "/fast", 200, "fast");
+  if (chrono::steady_clock::now() - start > chrono::milliseconds(150)) {
+    cerr << "Test failed, request was delayed while a function waited on a pipe" << endl;
+    allTestsPassed = false;
+  }
+  allTestsPassed &= pipeFut.get();
+
+  // Test waiting for writable and readable sockets, timeouts and invalid filedescriptors
+  allTestsPassed &= performTest(baseUrl + "/backend", 200, to_string(1 << 20));
+  allTestsPassed &= performTest(baseUrl + "/timeout", 200, "expired,ready");
+  allTestsPassed &= performTest(baseUrl + "/invalid", 500, "invalid");
+
+  // Test a connection which is closed by the client while the function waits
+  allTestsPassed &= performTest(baseUrl + "/pipe", 0, "", 100);
+  this_thread::sleep_for(chrono::milliseconds(400));
+  allTestsPassed &= performTest(baseUrl + "/fast", 200, "fast");
+
+  // Kill test server
+  server.Kill();
+
+  // Wait for the server to exit
+  serverFut.get();
+  return allTestsPassed;
+}
+
+int main(void) {
+  // Flag to indicate if all tests passed.
+  bool allTestsPassed = true;
+
+  allTestsPassed &= performBackendTests(EventBackend::EPOLL, false);
+  allTestsPassed &= performBackendTests(EventBackend::EPOLL, true);
+  allTestsPassed &= performBackendTests(EventBackend::IO_URING, false);
+
+  if(allTestsPassed) {
+    cout << "All tests passed." << endl;
+    return 0;
+  } else {
+    cout << "One or more tests failed." << endl;
+    return 1;
+  }
+}
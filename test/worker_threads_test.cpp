@@ -0,0 +1,204 @@
+#include <iostream>
+#include <string>
+#include <thread>
+#include <future>
+#include <mutex>
+#include <set>
+
+#include "curl/curl.h"
+#include "src/simplehttp.hpp"
+
+using namespace std;
+
+using namespace SimpleHTTP;
+
+// Attempts to connect to the server with exponential backoff.
+// Returns CURLE_OK on success, or the CURL error code on failure.
+CURLcode tryConnect(CURL* curl, int maxRetries, int maxDelaySeconds) {
+  int retries = 0;
+  int delaySeconds = 1; // Initial delay is 1 sec
+  CURLcode res;
+
+  // Check if curl handle is valid
+  if (!curl) return CURLE_FAILED_INIT;
+
+  // Try until max retries are reached
+  while (retries < maxRetries) {
+    res = curl_easy_perform(curl);
+    // Check if the operation was successful
+    if (res == CURLE_OK) return res;
+    // If not successful, wait for the exponential backoff delay
+    this_thread::sleep_for(chrono::seconds(delaySeconds));
+
+    // Update retries and increment delay
+    retries++;
+    delaySeconds *= 2;
+    // If max delay is reached, cap the delay
+    if (delaySeconds > maxDelaySeconds)
+      delaySeconds = maxDelaySeconds;
+  }
+  // If all retries are exhausted, return the last error code
+  cerr << "Connection failed after " << maxRetries << " retries\n";
+  return res;
+}
+
+// Callback function for curl fetch writing data to userp
+size_t curlWriteCallback(void *contents, size_t size, size_t nmemb, string *userp) {
+  userp->append((char*)contents, size * nmemb);
+  return size * nmemb;
+}
+
+// Callback function for curl fetch discarding data
+size_t curlDiscardCallback(void *buffer, size_t size, size_t nmemb, void *userp) {
+  return size * nmemb; // Indicate success but don't write the data
+}
+
+// Perform a series of requests, each on a fresh connection, and check every response.
+bool performTestWithNewConnections(const string& url, int requestCount) {
+  CURLcode res; // Variable to store the result of the CURL operation.
+  long response_code; // Variable to store the HTTP response code.
+  bool testPassed = true; // Flag to indicate if the test passed or failed.
+
+  // Initialize a dedicated CURL session for this client thread.
+  CURL *curl = curl_easy_init();
+  if (!curl) {
+    cerr << "Failed to initialize CURL." << endl;
+    return false;
+  }
+
+  for (int i = 0; i < requestCount; i++) {
+    string readBuffer; // String to store the response data.
+    // Reset the state of the curl session to its default state.
+    curl_easy_reset(curl);
+    // Set the URL for the CURL request.
+    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+    // Open a new connection for every request, so that it's assigned to a (possibly) different loop.
+    curl_easy_setopt(curl, CURLOPT_FRESH_CONNECT, 1L);
+    curl_easy_setopt(curl, CURLOPT_FORBID_REUSE, 1L);
+    // Set the function to handle writing the data received in response.
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, curlWriteCallback);
+    // Set the variable where the response data will be stored.
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &readBuffer);
+
+    // Perform the CURL request and store the result in 'res'.
+    res = curl_easy_perform(curl);
+    if (res == CURLE_OK) {
+      // Retrieve the HTTP response code.
+      curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response_code);
+      if (response_code != 200 || readBuffer != "Hello from a worker") {
+        cerr << "Test failed for URL: " << url << endl;
+        cerr << "Received status code: " << response_code << " and response: " << readBuffer << endl;
+        testPassed = false;
+      }
+    } else {
+      cerr << "CURL error: " << curl_easy_strerror(res) << endl;
+      testPassed = false;
+    }
+  }
+
+  curl_easy_cleanup(curl);
+  return testPassed;
+}
+
+
+int main(void) {
+  // Test server port
+  int port = 8080;
+  // Test server host
+  string host = "127.0.0.1";
+  // Base URL for the test server.
+  string baseUrl = "http://"+host+":"+to_string(port);
+  // Number of event loops launched by the server.
+  int workerThreads = 4;
+  // Number of concurrent clients.
+  int clientCount = 8;
+  // Number of requests performed by each client.
+  int requestsPerClient = 16;
+  // Flag to indicate if all tests passed.
+  bool allTestsPassed = true;
+
+  // Ids of the threads that handled a request
+  set<thread::id> handlerThreads;
+  mutex handlerThreadsMut;
+
+  // Create test server
+  Server server(host, port, {
+    .workerThreads = workerThreads
+  });
+
+  // Define routes
+
+  // This route records the id of the thread executing the handler. Handlers are executed on the
+  // event loop that accepted the connection, therefore with multiple worker threads, requests on
+  // different connections are expected to be handled by multiple threads.
+  server.Route("GET", "/worker", [&](Request &req, Body &_, Response &res) -> Task<bool> {
+    {
+      lock_guard<mutex> lock(handlerThreadsMut);
+      handlerThreads.insert(this_thread::get_id());
+    }
+    res.setStatusCode(200).setBody("Hello from a worker");
+    co_return true;
+  });
+
+  // Start server in a seperate thread
+  cout << "Starting local test server on " << host << ":" << port << endl;
+  future<void> serverFut = async(launch::async, [&server]() {
+    server.Serve();
+  });
+
+  // Initialize CURL session.
+  CURL *curl = curl_easy_init();
+  if (!curl) {
+    // Report failure if CURL session wasn't successfully initialized.
+    cerr << "Failed to initialize CURL." << endl;
+    return 1;
+  }
+
+  // Use base url to try connection
+  curl_easy_setopt(curl, CURLOPT_URL, baseUrl.c_str());
+  curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, curlDiscardCallback);
+
+  // Try to connect to the test server (5 retries, 10s maximum delay)
+  CURLcode res = tryConnect(curl, 5, 10);
+  if (res != CURLE_OK) {
+    cerr << "Failed connecting to test server: " << curl_easy_strerror(res) << endl;
+    server.Kill();
+    return 1;
+  }
+
+  // Cleanup curl session
+  curl_easy_cleanup(curl);
+
+  // Launch concurrent clients
+  vector<future<bool>> clients;
+  for (int i = 0; i < clientCount; i++) {
+    clients.push_back(async(launch::async, [&]() {
+      return performTestWithNewConnections(baseUrl + "/worker", requestsPerClient);
+    }));
+  }
+  // Wait for all clients
+  for (auto &client : clients) {
+    allTestsPassed &= client.get();
+  }
+
+  // Verify that the requests were spread over more than one event loop
+  if (handlerThreads.size() < 2) {
+    cerr << "Expected requests to be handled by multiple worker threads, got "
+         << handlerThreads.size() << endl;
+    allTestsPassed = false;
+  }
+
+  // Kill test server
+  server.Kill();
+
+  // Wait for the server to exit
+  serverFut.get();
+
+  if (allTestsPassed) {
+    cout << "All tests passed." << endl;
+    return 0; // Indicates success
+  } else {
+    cout << "One or more tests failed." << endl;
+    return 1; // Indicates failure
+  }
+}